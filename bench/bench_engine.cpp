@@ -0,0 +1,519 @@
+// Google Benchmark suite for the engine hot paths.
+//
+// Series sizes run from 1k to 100M bars; set BACKTEST_BENCH_MAX_BARS to cap
+// them on machines without the ~4 GB the largest full-output runs need.
+// Signal density is the per-mille share of bars on which the position
+// changes: 1 (rarely trading) up to 1000 (trading every bar).
+//
+// Every benchmark reports bars/s and bytes/bar, the bytes each bar reads
+// and writes in the engine's own arrays.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "BacktestEngine.hpp"
+#include "CostModels.hpp"
+#include "OrderBook.hpp"
+#include "RollingStatsCache.hpp"
+#include "SignalGenerator.hpp"
+#include "SparseBacktest.hpp"
+#include "SweepExecutor.hpp"
+#include "ThreadPool.hpp"
+
+namespace {
+
+constexpr double kDt = 1.0 / 252.0;
+
+std::int64_t max_bars()
+{
+    static const std::int64_t limit = [] {
+        const char* env = std::getenv("BACKTEST_BENCH_MAX_BARS");
+        long long v = env ? std::atoll(env) : 0;
+        return v > 0 ? static_cast<std::int64_t>(v) : std::int64_t(100000000);
+    }();
+    return limit;
+}
+
+// Geometric random walk, generated once and extended on demand so all
+// sizes share the same prefix.
+const std::vector<double>& bench_prices(std::size_t n)
+{
+    static std::vector<double> prices;
+    static std::mt19937_64 rng(12345);
+    if (prices.size() < n) {
+        std::normal_distribution<double> step(0.0, 0.01);
+        double p = prices.empty() ? 100.0 : prices.back();
+        prices.reserve(n);
+        while (prices.size() < n) {
+            p *= std::exp(step(rng));
+            prices.push_back(p);
+        }
+    }
+    return prices;
+}
+
+// Positions in {-1, 0, +1} that change on `per_mille` / 1000 of the bars.
+// Only the most recent series is cached, since the largest ones are big.
+const std::vector<int>& bench_signals(std::size_t n, std::int64_t per_mille)
+{
+    static std::vector<int> signals;
+    static std::size_t cached_n = 0;
+    static std::int64_t cached_density = -1;
+    if (cached_n != n || cached_density != per_mille) {
+        std::mt19937_64 rng(static_cast<std::uint64_t>(per_mille) * 7919u + 1u);
+        std::uniform_int_distribution<int> per_mille_draw(0, 999);
+        std::uniform_int_distribution<int> coin(0, 1);
+
+        signals.assign(n, 0);
+        int pos = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (per_mille_draw(rng) < per_mille) {
+                // Move to one of the two other states.
+                int next = pos + 1 + coin(rng);
+                pos = (next + 1) % 3 - 1;
+            }
+            signals[i] = pos;
+        }
+        cached_n = n;
+        cached_density = per_mille;
+    }
+    return signals;
+}
+
+void report(benchmark::State& state, std::size_t bars_per_iteration, double bytes_per_bar)
+{
+    double bars = static_cast<double>(bars_per_iteration);
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) *
+                            static_cast<std::int64_t>(bars_per_iteration));
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * bars * bytes_per_bar));
+    state.counters["bars/s"] = benchmark::Counter(bars, benchmark::Counter::kIsIterationInvariantRate);
+    state.counters["bytes/bar"] = benchmark::Counter(bytes_per_bar);
+}
+
+// {bars, density} grid, sizes 1k .. 100M (capped by max_bars()).
+void size_density_args(benchmark::internal::Benchmark* b)
+{
+    for (std::int64_t density : {1, 10, 100, 1000}) {
+        for (std::int64_t n = 1000; n <= max_bars() && n <= 100000000; n *= 10) {
+            b->Args({n, density});
+        }
+    }
+    b->ArgNames({"bars", "density"});
+}
+
+void size_args(benchmark::internal::Benchmark* b)
+{
+    for (std::int64_t n = 1000; n <= max_bars() && n <= 100000000; n *= 10) {
+        b->Arg(n);
+    }
+    b->ArgName("bars");
+}
+
+// {bars, candidates} grid for batch sweeps.
+void batch_args(benchmark::internal::Benchmark* b)
+{
+    for (std::int64_t n : {2520, 100000}) {
+        for (std::int64_t candidates : {16, 256}) {
+            if (n * candidates <= max_bars() * 16) {
+                b->Args({n, candidates});
+            }
+        }
+    }
+    b->ArgNames({"bars", "candidates"});
+}
+
+// Full outputs: reads price (8) + signal (4), writes equity (8) + pnl (8)
+// + position (4).
+void BM_RunBacktest(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    ArrayView<const double> prices(bench_prices(n).data(), n);
+    ArrayView<const int> signals(bench_signals(n, state.range(1)));
+    BacktestEngine engine(100000.0, 0.0005);
+
+    for (auto _ : state) {
+        BacktestResult r = engine.run_backtest(prices, signals, kDt);
+        benchmark::DoNotOptimize(r.sharpe_ratio);
+    }
+    report(state, n, 8 + 4 + 8 + 8 + 4);
+}
+BENCHMARK(BM_RunBacktest)->Apply(size_density_args)->Unit(benchmark::kMillisecond);
+
+// Metrics only: reads price + signal, nothing per bar is written.
+void BM_RunMetrics(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    ArrayView<const double> prices(bench_prices(n).data(), n);
+    ArrayView<const int> signals(bench_signals(n, state.range(1)));
+    BacktestEngine engine(100000.0, 0.0005);
+
+    for (auto _ : state) {
+        BacktestResult r = engine.run_metrics(prices, signals, kDt);
+        benchmark::DoNotOptimize(r.sharpe_ratio);
+    }
+    report(state, n, 8 + 4);
+}
+BENCHMARK(BM_RunMetrics)->Apply(size_density_args)->Unit(benchmark::kMillisecond);
+
+// Discrete one-byte layout, metrics only: reads price (8) + signal (1).
+void BM_RunMetricsInt8(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    ArrayView<const double> prices(bench_prices(n).data(), n);
+    const std::vector<int>& s = bench_signals(n, state.range(1));
+    std::vector<std::int8_t> signals(s.begin(), s.end());
+    BacktestEngine engine(100000.0, 0.0005);
+
+    for (auto _ : state) {
+        DiscreteBacktestResult r = engine.run_backtest(
+            prices, ArrayView<const std::int8_t>(signals), kDt, OutputMask::Stats);
+        benchmark::DoNotOptimize(r.sharpe_ratio);
+    }
+    report(state, n, 8 + 1);
+}
+BENCHMARK(BM_RunMetricsInt8)->Apply(size_density_args)->Unit(benchmark::kMillisecond);
+
+// Event-driven orders, metrics only: a market order at every signal change
+// of bench_signals plus a 2% stop-loss on each held position, against OHLC
+// bars around the walk. Reads the close (8) on every bar and open / high /
+// low (24) only on bars with working orders.
+void BM_RunOrders(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    const std::vector<double>& close = bench_prices(n);
+    const std::vector<int>& s = bench_signals(n, state.range(1));
+    std::vector<double> open(n), high(n), low(n);
+    std::vector<OrderEvent> orders;
+    for (std::size_t i = 0; i < n; ++i) {
+        double prev = (i == 0) ? close[0] : close[i - 1];
+        open[i] = prev;
+        high[i] = std::max(prev, close[i]) * 1.001;
+        low[i] = std::min(prev, close[i]) * 0.999;
+        int from = (i <= 1) ? 0 : s[i - 1];
+        if (i >= 1 && s[i] != from) {
+            orders.push_back({i, OrderType::Market, from, s[i], 0.0});
+            if (s[i] != 0) {
+                double stop = prev * (s[i] > 0 ? 0.98 : 1.02);
+                orders.push_back({i, OrderType::Stop, s[i], 0, stop});
+            }
+        }
+    }
+    OhlcBars bars{ArrayView<const double>(open), ArrayView<const double>(high),
+                  ArrayView<const double>(low), ArrayView<const double>(close.data(), n)};
+    BacktestEngine engine(100000.0, 0.0005);
+
+    for (auto _ : state) {
+        OrderBacktestResult r = engine.run_orders(bars, ArrayView<const OrderEvent>(orders), kDt,
+                                                  OutputMask::Stats);
+        benchmark::DoNotOptimize(r.backtest.sharpe_ratio);
+    }
+    report(state, n, 8);
+    state.counters["orders"] = benchmark::Counter(static_cast<double>(orders.size()));
+}
+BENCHMARK(BM_RunOrders)->Apply(size_density_args)->Unit(benchmark::kMillisecond);
+
+// Sparse path on the same signals as BM_RunMetrics, given as their change
+// list; the PriceRangeIndex is built once outside the loop, as in a sweep.
+// Bars/s counts the bars covered, and bytes/bar is left at 0: the bars are
+// not read, only the index entries at the interval ends and the drawdown
+// blocks it descends into.
+void BM_RunSparse(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    ArrayView<const double> prices(bench_prices(n).data(), n);
+    const std::vector<int>& s = bench_signals(n, state.range(1));
+    std::vector<PositionChange> changes;
+    int position = 0;
+    for (std::size_t i = 1; i < n; ++i) {
+        if (s[i] != position) {
+            changes.push_back({i, s[i]});
+            position = s[i];
+        }
+    }
+    PriceRangeIndex index(prices);
+    BacktestEngine engine(100000.0, 0.0005);
+
+    for (auto _ : state) {
+        SparseBacktestResult r = engine.run_sparse(index, ArrayView<const PositionChange>(changes), kDt);
+        benchmark::DoNotOptimize(r.sharpe_ratio);
+    }
+    report(state, n, 0);
+    state.counters["changes"] = benchmark::Counter(static_cast<double>(changes.size()));
+}
+BENCHMARK(BM_RunSparse)->Apply(size_density_args)->Unit(benchmark::kMillisecond);
+
+void BM_RunBacktestVectorized(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    ArrayView<const double> prices(bench_prices(n).data(), n);
+    ArrayView<const int> signals(bench_signals(n, state.range(1)));
+    BacktestEngine engine(100000.0, 0.0005);
+
+    for (auto _ : state) {
+        BacktestResult r = engine.run_backtest_vectorized(prices, signals, kDt);
+        benchmark::DoNotOptimize(r.sharpe_ratio);
+    }
+    report(state, n, 8 + 4 + 8 + 8 + 4);
+    state.SetLabel(kernel_isa_name(resolve_kernel_isa(KernelIsa::Auto)));
+}
+BENCHMARK(BM_RunBacktestVectorized)->Apply(size_density_args)->Unit(benchmark::kMillisecond);
+
+// Two-pass blocked scan of one series across a pool of range(2) threads
+// (0 = hardware concurrency), statistics only, against the single-thread
+// vectorised path above.
+void BM_RunBacktestParallelScan(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    ArrayView<const double> prices(bench_prices(n).data(), n);
+    ArrayView<const int> signals(bench_signals(n, state.range(1)));
+    BacktestEngine engine(100000.0, 0.0005);
+    ThreadPool pool(static_cast<std::size_t>(state.range(2)));
+    ExecutionPolicy policy = ExecutionPolicy::parallel_scan(pool);
+
+    for (auto _ : state) {
+        BacktestResult r = engine.run_backtest(prices, signals, kDt, OutputMask::Stats, policy);
+        benchmark::DoNotOptimize(r.sharpe_ratio);
+    }
+    report(state, n, 8 + 4);
+    state.counters["threads"] = benchmark::Counter(static_cast<double>(pool.size()));
+}
+BENCHMARK(BM_RunBacktestParallelScan)
+    ->Apply([](benchmark::internal::Benchmark* b) {
+        for (std::int64_t n = 100000; n <= max_bars() && n <= 100000000; n *= 10) {
+            for (std::int64_t threads : {1, 2, 4, 0}) {
+                b->Args({n, 10, threads});
+            }
+        }
+        b->ArgNames({"bars", "density", "threads"});
+    })
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Full cost model (bps + high/low spread + sqrt impact, minimum fee), to
+// compare against the flat-cost vectorised path above. Reads price (8) +
+// signal (4) + high/low (16) + inverse volume (8), writes equity + pnl +
+// position (20).
+void BM_RunBacktestWithCosts(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    const std::vector<double>& p = bench_prices(n);
+    ArrayView<const double> prices(p.data(), n);
+    ArrayView<const int> signals(bench_signals(n, state.range(1)));
+    BacktestEngine engine(100000.0, 0.0005);
+
+    std::vector<double> highs(n);
+    std::vector<double> lows(n);
+    std::vector<std::int64_t> volumes(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        highs[i] = p[i] * 1.005;
+        lows[i] = p[i] * 0.995;
+        volumes[i] = 1000000 + static_cast<std::int64_t>(i % 1000) * 1000;
+    }
+    using Model = MinimumFee<CostSum<ProportionalCost, SpreadCost, SqrtImpactCost>>;
+    Model costs(CostSum<ProportionalCost, SpreadCost, SqrtImpactCost>(
+                    ProportionalCost::from_bps(1.0),
+                    SpreadCost(ArrayView<const double>(highs), ArrayView<const double>(lows)),
+                    SqrtImpactCost(ArrayView<const std::int64_t>(volumes), 0.1)),
+                1.0);
+
+    for (auto _ : state) {
+        BacktestResult r = engine.run_backtest_with_costs(prices, signals, costs, kDt);
+        benchmark::DoNotOptimize(r.sharpe_ratio);
+    }
+    report(state, n, 8 + 4 + 16 + 8 + 8 + 8 + 4);
+}
+BENCHMARK(BM_RunBacktestWithCosts)->Apply(size_density_args)->Unit(benchmark::kMillisecond);
+
+void BM_ComputeSharpe(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    BacktestEngine engine(100000.0, 0.0005);
+    BacktestResult r = engine.run_backtest(ArrayView<const double>(bench_prices(n).data(), n),
+                                           ArrayView<const int>(bench_signals(n, 10)),
+                                           kDt, OutputMask::Pnl);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(engine.compute_sharpe(r.pnl, kDt));
+    }
+    report(state, n, 8);
+}
+BENCHMARK(BM_ComputeSharpe)->Apply(size_args)->Unit(benchmark::kMillisecond);
+
+void BM_ComputeMaxDrawdown(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    BacktestEngine engine(100000.0, 0.0005);
+    BacktestResult r = engine.run_backtest(ArrayView<const double>(bench_prices(n).data(), n),
+                                           ArrayView<const int>(bench_signals(n, 10)),
+                                           kDt, OutputMask::Equity);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(engine.compute_max_drawdown(r.equity_curve));
+    }
+    report(state, n, 8);
+}
+BENCHMARK(BM_ComputeMaxDrawdown)->Apply(size_args)->Unit(benchmark::kMillisecond);
+
+// Reads price (8), writes signal (4).
+void BM_SignalGenerate(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    ArrayView<const double> prices(bench_prices(n).data(), n);
+    std::vector<int> out(n);
+    SignalGenerator generator(static_cast<std::size_t>(state.range(1)));
+
+    for (auto _ : state) {
+        generator.generate_into(prices, ArrayView<int>(out));
+        benchmark::ClobberMemory();
+    }
+    report(state, n, 8 + 4);
+}
+BENCHMARK(BM_SignalGenerate)
+    ->Apply([](benchmark::internal::Benchmark* b) {
+        for (std::int64_t window : {20, 252}) {
+            for (std::int64_t n = 1000; n <= max_bars() && n <= 100000000; n *= 10) {
+                b->Args({n, window});
+            }
+        }
+        b->ArgNames({"bars", "window"});
+    })
+    ->Unit(benchmark::kMillisecond);
+
+// Threshold sweep: 4 windows x 9 (z_entry, z_exit) pairs, over series of
+// up to 1M bars (the matrix is 36 ints per bar).
+std::vector<SignalParams> sweep_grid()
+{
+    std::vector<SignalParams> grid;
+    for (std::size_t window : {20, 60, 120, 252}) {
+        for (double entry : {1.5, 2.0, 2.5}) {
+            for (double exit : {0.0, 0.25, 0.5}) {
+                grid.push_back(SignalParams{window, entry, exit});
+            }
+        }
+    }
+    return grid;
+}
+
+void sweep_args(benchmark::internal::Benchmark* b)
+{
+    for (std::int64_t n = 1000; n <= max_bars() && n <= 1000000; n *= 10) {
+        b->Arg(n);
+    }
+    b->ArgName("bars");
+}
+
+// Per candidate bar: price (8) read, signal (4) written.
+void BM_SignalMatrixGenerator(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    ArrayView<const double> prices(bench_prices(n).data(), n);
+    std::vector<SignalParams> grid = sweep_grid();
+    std::vector<int> matrix(grid.size() * n);
+
+    for (auto _ : state) {
+        for (std::size_t k = 0; k < grid.size(); ++k) {
+            SignalGenerator generator(grid[k].window, grid[k].z_entry, grid[k].z_exit);
+            generator.generate_into(prices, ArrayView<int>(matrix.data() + k * n, n));
+        }
+        benchmark::ClobberMemory();
+    }
+    report(state, n * grid.size(), 8 + 4);
+}
+BENCHMARK(BM_SignalMatrixGenerator)->Apply(sweep_args)->Unit(benchmark::kMillisecond);
+
+// Same matrix from a RollingStatsCache built inside the loop, so the
+// prefix sums and the 4 z-score series are part of the timing.
+// Per candidate bar: cached z-score (8) read, signal (4) written.
+void BM_SignalMatrixCached(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    ArrayView<const double> prices(bench_prices(n).data(), n);
+    std::vector<SignalParams> grid = sweep_grid();
+
+    for (auto _ : state) {
+        RollingStatsCache cache;
+        cache.add_series("bench", prices);
+        std::vector<int> matrix = cache.signal_matrix("bench", grid);
+        benchmark::DoNotOptimize(matrix.data());
+    }
+    report(state, n * grid.size(), 8 + 4);
+}
+BENCHMARK(BM_SignalMatrixCached)->Apply(sweep_args)->Unit(benchmark::kMillisecond);
+
+// Signal matrix of `candidates` rows with different densities.
+std::vector<int> batch_matrix(std::size_t n, std::size_t candidates)
+{
+    std::vector<int> matrix;
+    matrix.reserve(n * candidates);
+    const std::int64_t densities[] = {1, 10, 100, 1000};
+    for (std::size_t k = 0; k < candidates; ++k) {
+        const std::vector<int>& s = bench_signals(n, densities[k % 4]);
+        matrix.insert(matrix.end(), s.begin(), s.end());
+    }
+    return matrix;
+}
+
+// Per candidate bar: signal (4) + shared price move and unit cost (16).
+void BM_RunBatch(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    std::size_t candidates = static_cast<std::size_t>(state.range(1));
+    ArrayView<const double> prices(bench_prices(n).data(), n);
+    std::vector<int> matrix = batch_matrix(n, candidates);
+    BacktestEngine engine(100000.0, 0.0005);
+
+    for (auto _ : state) {
+        BatchResult r = engine.run_batch(prices, ArrayView<const int>(matrix), kDt);
+        benchmark::DoNotOptimize(r.sharpe_ratio.data());
+    }
+    report(state, n * candidates, 4 + 16);
+}
+BENCHMARK(BM_RunBatch)->Apply(batch_args)->Unit(benchmark::kMillisecond);
+
+// Per candidate bar: int8 signal (1) + shared float move and unit cost (8).
+// Accuracy against run_batch is checked by checks/mixed_precision_check.
+void BM_RunBatchMixed(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    std::size_t candidates = static_cast<std::size_t>(state.range(1));
+    ArrayView<const double> prices(bench_prices(n).data(), n);
+    std::vector<int> matrix = batch_matrix(n, candidates);
+    std::vector<std::int8_t> matrix8(matrix.begin(), matrix.end());
+    BacktestEngine engine(100000.0, 0.0005);
+
+    for (auto _ : state) {
+        BatchResult r = engine.run_batch_mixed<float, std::int8_t>(
+            prices, ArrayView<const std::int8_t>(matrix8), kDt);
+        benchmark::DoNotOptimize(r.sharpe_ratio.data());
+    }
+    report(state, n * candidates, 1 + 8);
+}
+BENCHMARK(BM_RunBatchMixed)->Apply(batch_args)->Unit(benchmark::kMillisecond);
+
+void BM_SweepExecutor(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    std::size_t candidates = static_cast<std::size_t>(state.range(1));
+    ArrayView<const double> prices(bench_prices(n).data(), n);
+    std::vector<int> matrix = batch_matrix(n, candidates);
+    BacktestEngine engine(100000.0, 0.0005);
+    SweepExecutor executor(engine);
+
+    for (auto _ : state) {
+        BatchResult r = executor.run(prices, ArrayView<const int>(matrix), kDt);
+        benchmark::DoNotOptimize(r.sharpe_ratio.data());
+    }
+    report(state, n * candidates, 4 + 16);
+    state.counters["threads"] = benchmark::Counter(static_cast<double>(executor.num_threads()));
+}
+BENCHMARK(BM_SweepExecutor)->Apply(batch_args)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+}  // namespace
+
+BENCHMARK_MAIN();
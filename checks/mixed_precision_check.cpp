@@ -0,0 +1,101 @@
+// Accuracy regression check of BacktestEngine::run_batch_mixed against the
+// double run_batch path, run by ctest.
+//
+// Every candidate's sharpe_ratio must lie within
+// kMixedSharpeTolerance * max(1, |sharpe_ratio|) of run_batch, for float
+// and double moves, int8 and int positions, several price levels and with
+// and without transaction costs. Exits non-zero on the first violation.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "BacktestEngine.hpp"
+#include "RollingStatsCache.hpp"
+#include "SignalGenerator.hpp"
+
+namespace {
+
+// Geometric random walk starting at `start`.
+std::vector<double> walk(std::size_t n, double start, std::uint64_t seed)
+{
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> step(0.0, 0.002);
+    std::vector<double> prices(n);
+    double p = start;
+    for (double& v : prices) {
+        p *= std::exp(step(rng));
+        v = p;
+    }
+    return prices;
+}
+
+// Largest |mixed - reference| / max(1, |reference|) over the candidates.
+double worst_sharpe_error(const BatchResult& mixed, const BatchResult& reference)
+{
+    if (mixed.num_candidates != reference.num_candidates) {
+        return INFINITY;
+    }
+    double worst = 0.0;
+    for (std::size_t k = 0; k < reference.num_candidates; ++k) {
+        double scale = std::max(1.0, std::fabs(reference.sharpe_ratio[k]));
+        double error = std::fabs(mixed.sharpe_ratio[k] - reference.sharpe_ratio[k]) / scale;
+        worst = std::max(worst, std::isnan(error) ? INFINITY : error);
+    }
+    return worst;
+}
+
+}  // namespace
+
+int main()
+{
+    const double dt = 1.0 / 252.0;
+    const std::size_t n = 200000;
+    std::vector<SignalParams> grid;
+    for (std::size_t window : {10, 50, 200}) {
+        for (double z_entry : {1.0, 2.0}) {
+            for (double z_exit : {0.0, 0.5}) {
+                grid.push_back({window, z_entry, z_exit});
+            }
+        }
+    }
+
+    int failures = 0;
+    for (double start : {1.0, 100.0, 5000.0}) {
+        std::vector<double> prices = walk(n, start, static_cast<std::uint64_t>(start) + 7);
+        ArrayView<const double> p(prices);
+        RollingStatsCache cache;
+        cache.add_series("walk", p);
+        std::vector<int> matrix = cache.signal_matrix("walk", grid);
+        std::vector<std::int8_t> matrix8(matrix.begin(), matrix.end());
+        ArrayView<const int> m(matrix);
+        ArrayView<const std::int8_t> m8(matrix8);
+
+        for (double cost : {0.0, 0.0005}) {
+            BacktestEngine engine(100000.0, cost);
+            BatchResult reference = engine.run_batch(p, m, dt);
+
+            struct Case {
+                const char* name;
+                BatchResult result;
+            };
+            const Case cases[] = {
+                {"float/int8", engine.run_batch_mixed<float>(p, m8, dt)},
+                {"float/int", engine.run_batch_mixed<float>(p, m, dt)},
+                {"double/int8", engine.run_batch_mixed<double>(p, m8, dt)},
+                {"double/int", engine.run_batch_mixed<double>(p, m, dt)},
+            };
+            for (const Case& c : cases) {
+                double worst = worst_sharpe_error(c.result, reference);
+                bool ok = worst <= BacktestEngine::kMixedSharpeTolerance;
+                std::printf("%-4s %-11s start %-6g cost %-6g max sharpe error %.3g\n",
+                            ok ? "ok" : "FAIL", c.name, start, cost, worst);
+                failures += ok ? 0 : 1;
+            }
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+// Minimal non-owning view over a contiguous array (C++17 stand-in for
+// std::span). Used so the engine core can run directly on NumPy buffers,
+// memory-mapped columns or std::vector storage without copying.
+template <typename T>
+class ArrayView {
+public:
+    using value_type = std::remove_const_t<T>;
+
+    constexpr ArrayView() noexcept = default;
+
+    constexpr ArrayView(T* data, std::size_t size) noexcept
+        : data_(data), size_(size) {}
+
+    // Views over std::vector storage (const view from const vector).
+    template <typename U = T,
+              typename = std::enable_if_t<std::is_const<U>::value>>
+    ArrayView(const std::vector<value_type>& v) noexcept
+        : data_(v.data()), size_(v.size()) {}
+
+    ArrayView(std::vector<value_type>& v) noexcept
+        : data_(v.data()), size_(v.size()) {}
+
+    constexpr T* data() const noexcept { return data_; }
+    constexpr std::size_t size() const noexcept { return size_; }
+    constexpr bool empty() const noexcept { return size_ == 0; }
+
+    constexpr T& operator[](std::size_t i) const noexcept { return data_[i]; }
+
+    constexpr T* begin() const noexcept { return data_; }
+    constexpr T* end() const noexcept { return data_ + size_; }
+
+    // Sub-view [offset, offset + count).
+    constexpr ArrayView subview(std::size_t offset, std::size_t count) const noexcept
+    {
+        return ArrayView(data_ + offset, count);
+    }
+
+private:
+    T* data_ = nullptr;
+    std::size_t size_ = 0;
+};
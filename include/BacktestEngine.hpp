@@ -0,0 +1,624 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+
+#include "ArrayView.hpp"
+#include "PnlKernels.hpp"
+#include "Profiling.hpp"
+
+class SignalGenerator;
+class ThreadPool;
+struct OhlcBars;
+struct OrderEvent;
+struct OrderBacktestResult;
+struct PositionChange;
+struct SparseBacktestResult;
+class PriceRangeIndex;
+
+template <typename T>
+class ChunkReader;
+
+// Selects which outputs a backtest materialises. Combine with `|`, e.g.
+// OutputMask::Equity | OutputMask::Stats. Anything not requested is never
+// allocated. total_return is always reported.
+enum class OutputMask : unsigned {
+    None         = 0,
+    Equity       = 1u << 0,   // equity_curve
+    Pnl          = 1u << 1,   // pnl
+    Position     = 1u << 2,   // position (one value per bar)
+    PositionRuns = 1u << 3,   // position_runs (run-length encoded)
+    Stats        = 1u << 4,   // max_drawdown and sharpe_ratio
+
+    Curves = Equity | Pnl | Position,
+    All    = Curves | Stats
+};
+
+constexpr OutputMask operator|(OutputMask a, OutputMask b)
+{
+    return static_cast<OutputMask>(static_cast<unsigned>(a) | static_cast<unsigned>(b));
+}
+
+constexpr OutputMask operator&(OutputMask a, OutputMask b)
+{
+    return static_cast<OutputMask>(static_cast<unsigned>(a) & static_cast<unsigned>(b));
+}
+
+constexpr bool has_output(OutputMask mask, OutputMask flag)
+{
+    return (mask & flag) == flag;
+}
+
+// How run_backtest executes a single series (see the ExecutionPolicy
+// overload).
+enum class ExecutionMode {
+    Sequential,    // reference loop (run_backtest)
+    Vectorized,    // SIMD kernels on the calling thread (run_backtest_vectorized)
+    ParallelScan   // SIMD kernels over blocks spread across a ThreadPool
+};
+
+struct ExecutionPolicy {
+    ExecutionMode mode = ExecutionMode::Sequential;
+    ThreadPool* pool = nullptr;          // ParallelScan workers (nullptr = calling thread)
+    std::size_t block_bars = 0;          // ParallelScan bars per task (0 = 65536)
+    KernelIsa isa = KernelIsa::Auto;     // kernels of the SIMD modes
+
+    static ExecutionPolicy sequential() { return ExecutionPolicy(); }
+
+    static ExecutionPolicy vectorized(KernelIsa isa = KernelIsa::Auto)
+    {
+        ExecutionPolicy p;
+        p.mode = ExecutionMode::Vectorized;
+        p.isa = isa;
+        return p;
+    }
+
+    static ExecutionPolicy parallel_scan(ThreadPool& pool, std::size_t block_bars = 0)
+    {
+        ExecutionPolicy p;
+        p.mode = ExecutionMode::ParallelScan;
+        p.pool = &pool;
+        p.block_bars = block_bars;
+        return p;
+    }
+};
+
+// Constant position held over bars [start, start + length).
+// The start of every run after the first is a trade.
+template <typename PositionT>
+struct BasicPositionRun {
+    std::size_t start = 0;
+    std::size_t length = 0;
+    PositionT position = 0;
+};
+
+// Simple structure to hold backtest outputs for a single-asset strategy.
+// PositionT is the per-bar position type (see the aliases below).
+template <typename PositionT>
+struct BasicBacktestResult {
+    // Account equity over time (cumulative, including PnL and costs).
+    std::vector<double> equity_curve;
+
+    // Per-step PnL (change in equity due to price move and position).
+    std::vector<double> pnl;
+
+    // Position over time: -1 = short, 0 = flat, +1 = long (or a fractional
+    // weight for the double layout).
+    std::vector<PositionT> position;
+
+    // Run-length encoded positions (only with OutputMask::PositionRuns).
+    std::vector<BasicPositionRun<PositionT>> position_runs;
+
+    // Final performance statistics.
+    double total_return = 0.0;   // (final_equity / initial_equity - 1)
+    double max_drawdown = 0.0;   // Max peak-to-trough drawdown (as fraction)
+    double sharpe_ratio = 0.0;   // Simple Sharpe ratio (annualised)
+
+    // Phase timings and counters (all 0 unless built with BACKTEST_PROFILING).
+    BacktestStats profile;
+};
+
+// Discrete -1/0/+1 signals, as taken by the std::vector / int API.
+using PositionRun = BasicPositionRun<int>;
+using BacktestResult = BasicBacktestResult<int>;
+
+// Compact discrete layout, one byte per bar.
+using DiscretePositionRun = BasicPositionRun<std::int8_t>;
+using DiscreteBacktestResult = BasicBacktestResult<std::int8_t>;
+
+// Fractional position weights, e.g. signals scaled by a decision multiplier.
+using FractionalPositionRun = BasicPositionRun<double>;
+using FractionalBacktestResult = BasicBacktestResult<double>;
+
+// Single-run result whose curves are views into memory the result does not
+// own (e.g. a ResultArena); valid only as long as that memory is.
+struct BacktestResultView {
+    ArrayView<const double> equity_curve;
+    ArrayView<const double> pnl;
+    ArrayView<const int> position;
+
+    double total_return = 0.0;
+    double max_drawdown = 0.0;
+    double sharpe_ratio = 0.0;
+};
+
+// Struct-of-arrays outputs for a batch of candidates run against one price
+// series. Entry k of every array belongs to row k of the signal matrix.
+struct BatchResult {
+    std::size_t num_candidates = 0;  // N (rows of the signal matrix)
+    std::size_t num_steps = 0;       // T (length of the price series)
+
+    std::vector<double> total_return;  // size N
+    std::vector<double> max_drawdown;  // size N
+    std::vector<double> sharpe_ratio;  // size N
+
+    // Per-candidate curves as row-major N x T blocks, only set by the
+    // memory-resource overloads of run_batch / SweepExecutor::run (empty
+    // otherwise). They live in that resource, not in the result.
+    ArrayView<double> equity_curve;
+    ArrayView<double> pnl;
+    ArrayView<int> position;
+
+    // Summed over all candidates, so loop_ns of a threaded sweep is total
+    // worker time (all 0 unless built with BACKTEST_PROFILING).
+    BacktestStats profile;
+
+    // Candidate k as a single-run view (curves empty if not materialised).
+    BacktestResultView candidate(std::size_t k) const
+    {
+        BacktestResultView v;
+        if (!equity_curve.empty()) {
+            v.equity_curve = ArrayView<const double>(equity_curve.data() + k * num_steps, num_steps);
+        }
+        if (!pnl.empty()) {
+            v.pnl = ArrayView<const double>(pnl.data() + k * num_steps, num_steps);
+        }
+        if (!position.empty()) {
+            v.position = ArrayView<const int>(position.data() + k * num_steps, num_steps);
+        }
+        v.total_return = total_return[k];
+        v.max_drawdown = max_drawdown[k];
+        v.sharpe_ratio = sharpe_ratio[k];
+        return v;
+    }
+};
+
+// Per-series data shared by every candidate of a batch run.
+struct PriceMoves {
+    std::vector<double> price_change;  // prices[i] - prices[i-1] (0 at i = 0)
+    std::vector<double> unit_cost;     // cost of trading one unit at step i
+};
+
+class BacktestEngine;
+
+// A compile-time specialisation of the single-series loop: position layout,
+// flat transaction cost and a fixed output selection, so the loop carries
+// no per-bar checks for outputs it does not produce. See
+// BacktestEngine::variants().
+template <typename PositionT>
+struct EngineVariant {
+    std::string name;    // e.g. "int8_flat_stats"
+    OutputMask outputs;  // what the loop materialises
+    BasicBacktestResult<PositionT> (BacktestEngine::*run)(ArrayView<const double> prices,
+                                                          ArrayView<const PositionT> positions,
+                                                          double dt_in_years) const;
+};
+
+// Core backtesting engine for a single-asset mean-reversion strategy.
+// Prices and signals are assumed to be aligned time series.
+// Signal convention: -1 = short, 0 = flat, +1 = long.
+class BacktestEngine {
+public:
+    // Constructor
+    //
+    //  initial_capital:        starting equity
+    //  transaction_cost_pct:   proportional transaction cost
+    //                          e.g. 0.001 = 10 bps per traded notional
+    //  risk_free_rate:         annual risk-free rate used in Sharpe calc (can be 0.0)
+    BacktestEngine(double initial_capital,
+                   double transaction_cost_pct,
+                   double risk_free_rate = 0.0);
+
+    // Run the backtest on a series of prices and pre-computed trading signals.
+    //
+    //  prices:          close or mid prices for each time step (size N)
+    //  signals:         trading signal at each step (-1, 0, +1) (size N)
+    //  dt_in_years:     time step in years (e.g. 1.0/252 for daily data)
+    //
+    // Returns:
+    //  BacktestResult containing equity curve, PnL, positions and statistics.
+    BacktestResult run_backtest(const std::vector<double>& prices,
+                                const std::vector<int>& signals,
+                                double dt_in_years) const;
+
+    // Same as above, but runs directly on caller-owned buffers (e.g. NumPy
+    // arrays) without copying them. prices and signals must have equal size.
+    //
+    // `outputs` selects what is materialised (see OutputMask). Statistics
+    // come from the stored curves when both Equity and Pnl are requested and
+    // from the fused single-pass accumulator otherwise.
+    BacktestResult run_backtest(ArrayView<const double> prices,
+                                ArrayView<const int> signals,
+                                double dt_in_years,
+                                OutputMask outputs = OutputMask::All) const;
+
+    // Same backtest with an explicit execution policy. ParallelScan splits
+    // the series into fixed blocks of policy.block_bars and runs two passes
+    // over them on policy.pool:
+    //   1. per block: step PnL, its local prefix sum (total and maximum)
+    //      and PnL moments;
+    //   -  the block totals are scanned into starting equities, and the
+    //      block maxima into the peak each block starts from;
+    //   2. per block: equity = start + local prefix, and the drawdown fold
+    //      from that starting peak.
+    // Block results merge with associative operators (sums, (peak,
+    // max_drawdown) as max, Chan's moment update) in block order, so the
+    // result depends only on block_bars, never on the number of threads.
+    // The per-bar pnl is bit-identical to run_backtest; equity and the
+    // statistics agree with it to floating-point rounding, as for
+    // run_backtest_vectorized.
+    BacktestResult run_backtest(ArrayView<const double> prices,
+                                ArrayView<const int> signals,
+                                double dt_in_years,
+                                OutputMask outputs,
+                                const ExecutionPolicy& policy) const;
+
+    // Same loop for any position type: PositionT = int, std::int8_t
+    // (discrete signals in one byte per bar) or double (fractional weights).
+    // A change of position costs |new - old| * price * transaction_cost_pct.
+    // Integer layouts give bit-identical results to the int overload.
+    template <typename PositionT>
+    BasicBacktestResult<PositionT> run_backtest(ArrayView<const double> prices,
+                                                ArrayView<const PositionT> positions,
+                                                double dt_in_years,
+                                                OutputMask outputs = OutputMask::All) const;
+
+    // Backtest with signals scaled bar by bar, e.g. by the
+    // DecisionSeries::position_multiplier of the decision layer:
+    //   position[i] = signals[i] * multipliers[i]
+    // The multiplier of bar i sizes the position held over bar i, so a
+    // decision made on bar i's close should be shifted to bar i + 1.
+    // signals and multipliers must have the size of prices.
+    template <typename PositionT>
+    FractionalBacktestResult run_backtest(ArrayView<const double> prices,
+                                          ArrayView<const PositionT> signals,
+                                          ArrayView<const double> multipliers,
+                                          double dt_in_years,
+                                          OutputMask outputs = OutputMask::All) const;
+
+    // Run the backtest with signals produced on the fly by `generator`
+    // (reset first), so no temporary signal vector is materialised.
+    // Equivalent to run_backtest(prices, generator.generate(prices), dt).
+    BacktestResult run_backtest(ArrayView<const double> prices,
+                                SignalGenerator& generator,
+                                double dt_in_years,
+                                OutputMask outputs = OutputMask::All) const;
+
+    // Named dispatch table of specialised loops for one position layout
+    // (int, std::int8_t or double). Names are "<layout>_flat_<outputs>" with
+    // outputs one of all, curves, stats, stats_runs (Stats | PositionRuns)
+    // and return_only (OutputMask::None); e.g. "int8_flat_stats" is the
+    // discrete, flat-cost, statistics-only loop of a parameter sweep.
+    // run_backtest dispatches to the same specialisations for these masks,
+    // so a variant gives exactly run_backtest(prices, positions, dt,
+    // variant.outputs); it only skips the dispatch.
+    //
+    // find_variant returns nullptr for an unknown name.
+    template <typename PositionT>
+    static ArrayView<const EngineVariant<PositionT>> variants();
+
+    template <typename PositionT>
+    static const EngineVariant<PositionT>* find_variant(const std::string& name);
+
+    // Names of every layout's variants.
+    static std::vector<std::string> variant_names();
+
+    template <typename PositionT>
+    BasicBacktestResult<PositionT> run_variant(const EngineVariant<PositionT>& variant,
+                                               ArrayView<const double> prices,
+                                               ArrayView<const PositionT> positions,
+                                               double dt_in_years) const
+    {
+        return (this->*variant.run)(prices, positions, dt_in_years);
+    }
+
+    // Metrics-only backtest, i.e. run_backtest(..., OutputMask::Stats):
+    // running peak, drawdown and Welford PnL moments are computed inside
+    // the main loop and no per-step vectors are allocated. total_return and
+    // max_drawdown match run_backtest exactly, sharpe_ratio up to
+    // floating-point rounding.
+    BacktestResult run_metrics(ArrayView<const double> prices,
+                               ArrayView<const int> signals,
+                               double dt_in_years) const;
+
+    BacktestResult run_metrics(ArrayView<const double> prices,
+                               SignalGenerator& generator,
+                               double dt_in_years) const;
+
+    // Out-of-core metrics-only backtest over series pulled block by block
+    // from `prices` (and `signals`), e.g. a ViewChunkReader over a
+    // PriceStore column or a CsvChunkReader. Position, equity, last price,
+    // peak and the Welford PnL moments are carried across blocks (a
+    // StreamingBacktest), so memory is bounded by chunk_bars whatever the
+    // series length, and total_return, max_drawdown and sharpe_ratio are
+    // identical to run_metrics on the whole series in memory. No curves are
+    // returned.
+    //
+    //  chunk_bars:  bars requested per block (0 = 65536)
+    //
+    // Returns an empty result for fewer than two bars or when signals and
+    // prices differ in length.
+    BacktestResult run_backtest_chunked(ChunkReader<double>& prices,
+                                        ChunkReader<int>& signals,
+                                        double dt_in_years,
+                                        std::size_t chunk_bars = 0) const;
+
+    // Same, with signals produced on the fly by `generator` (reset first);
+    // identical to run_metrics(prices, generator, dt) in memory.
+    BacktestResult run_backtest_chunked(ChunkReader<double>& prices,
+                                        SignalGenerator& generator,
+                                        double dt_in_years,
+                                        std::size_t chunk_bars = 0) const;
+
+    // Event-driven backtest with intrabar execution of limit and stop
+    // orders against OHLC bars (see OrderBook.hpp for the order semantics).
+    //
+    //  bars:    open / high / low / close of each step (equal sizes)
+    //  orders:  order instructions sorted by bar
+    //
+    // Before bar i, every order with bar <= i is applied to the book. The
+    // working orders of the current position are then checked against the
+    // bar's open, high and low, and at most one fills per bar (at the open
+    // if it gaps through the level, else at the level), so orders placed
+    // for the new position can fill from the next bar on. A change of
+    // position costs |new - old| * fill price * transaction_cost_pct, and
+    // each bar is marked to market on its close:
+    //   pnl[i] = old * (fill - close[i-1]) + new * (close[i] - fill) - cost.
+    // Bars on which the current position has no working orders are not
+    // inspected at all: the loop jumps straight to the next order event,
+    // marking the stretch to market if a position is held (a flat one is
+    // O(1) unless curves are stored). `outputs` selects the curves (Equity,
+    // Pnl, Position); the statistics are always computed, as in
+    // run_metrics.
+    //
+    // Returns an empty result for fewer than two bars, OHLC columns of
+    // different sizes, unsorted orders or an order that is not
+    // OrderBook::valid.
+    OrderBacktestResult run_orders(const OhlcBars& bars,
+                                   ArrayView<const OrderEvent> orders,
+                                   double dt_in_years,
+                                   OutputMask outputs = OutputMask::All) const;
+
+    // Sparse backtest for low-turnover strategies, with the signals given
+    // as position changes (see SparseBacktest.hpp) instead of one value per
+    // bar. Each holding interval is evaluated in closed form from the
+    // prices at its ends:
+    //   PnL      position * (prices[exit - 1] - prices[entry - 1]) - costs
+    //   moments  sum and sum of squares of the interval's per-bar PnL, from
+    //            the index's prefix sums of squared moves, merged into the
+    //            PnL mean / variance as blocks
+    //   drawdown the index's block tree, which only descends into blocks
+    //            that could set a new maximum drawdown
+    // so the work is O(changes * log(bars)) plus the blocks scanned for the
+    // drawdown, not O(bars). total_return, max_drawdown and sharpe_ratio
+    // are those of run_metrics on the equivalent dense signals, up to
+    // floating-point rounding. The result also holds the trade ledger.
+    //
+    //  index:    PriceRangeIndex of the price series, built once and shared
+    //            by every change list run against it
+    //  changes:  position changes with strictly increasing bars and
+    //            positions in {-1, 0, +1}
+    //
+    // Returns an empty result for fewer than two bars or invalid changes.
+    SparseBacktestResult run_sparse(const PriceRangeIndex& index,
+                                    ArrayView<const PositionChange> changes,
+                                    double dt_in_years) const;
+
+    // Same, building the index of `prices` for this run only.
+    SparseBacktestResult run_sparse(ArrayView<const double> prices,
+                                    ArrayView<const PositionChange> changes,
+                                    double dt_in_years) const;
+
+    // Vectorised flat-cost backtest. Per-step PnL is computed elementwise
+    // with SIMD kernels (see PnlKernels.hpp), equity by a blocked prefix
+    // sum, and drawdown / PnL moments per block; `isa` selects the
+    // instruction set (Auto = best available at runtime).
+    //
+    // The per-bar pnl is bit-identical to run_backtest. Equity and the
+    // statistics are summed in a different order, so they agree with the
+    // reference loop to floating-point rounding only; run_backtest remains
+    // the reference path.
+    BacktestResult run_backtest_vectorized(ArrayView<const double> prices,
+                                           ArrayView<const int> signals,
+                                           double dt_in_years,
+                                           OutputMask outputs = OutputMask::All,
+                                           KernelIsa isa = KernelIsa::Auto) const;
+
+    // Vectorised backtest with a compile-time transaction cost policy in
+    // place of the flat transaction_cost_pct (see CostModels.hpp for the
+    // policies and for this definition). The per-bar costs are evaluated in
+    // a branch-free elementwise loop that the compiler can vectorise; the
+    // remaining passes are the run_backtest_vectorized kernels. With
+    // ProportionalCost(transaction_cost_pct) the result is bit-identical to
+    // run_backtest_vectorized.
+    //
+    // Returns an empty result if costs.size() < prices.size().
+    template <typename CostModel>
+    BacktestResult run_backtest_with_costs(ArrayView<const double> prices,
+                                           ArrayView<const int> signals,
+                                           const CostModel& costs,
+                                           double dt_in_years,
+                                           OutputMask outputs = OutputMask::All,
+                                           KernelIsa isa = KernelIsa::Auto) const;
+
+    // Run many candidate signal vectors against the same price series.
+    //
+    //  prices:          close or mid prices for each time step (size T)
+    //  signal_matrix:   row-major N x T block, row k = signals of candidate k
+    //  dt_in_years:     time step in years (e.g. 1.0/252 for daily data)
+    //
+    // Price changes and per-unit costs are computed once and shared by all
+    // candidates, and each candidate runs the fused metrics-only loop, so
+    // there is no per-candidate allocation. Statistics are identical to
+    // calling run_metrics on each row.
+    //
+    // Returns:
+    //  BatchResult with one entry per candidate (empty if shapes mismatch).
+    BatchResult run_batch(const std::vector<double>& prices,
+                          const std::vector<int>& signal_matrix,
+                          double dt_in_years) const;
+
+    // Zero-copy variant of run_batch; signal_matrix.size() must be a
+    // multiple of prices.size().
+    BatchResult run_batch(ArrayView<const double> prices,
+                          ArrayView<const int> signal_matrix,
+                          double dt_in_years) const;
+
+    // Same batch, additionally storing the curves selected by `outputs`
+    // (Equity, Pnl, Position) for every candidate as N x T blocks taken from
+    // `curve_memory`, typically a ResultArena that is reset between batches.
+    // No per-candidate vectors are allocated; use BatchResult::candidate(k)
+    // for a per-run view. Statistics are those of the plain run_batch.
+    BatchResult run_batch(ArrayView<const double> prices,
+                          ArrayView<const int> signal_matrix,
+                          double dt_in_years,
+                          std::pmr::memory_resource& curve_memory,
+                          OutputMask outputs = OutputMask::Curves) const;
+
+    // Reduced-precision run_batch for memory-bound sweeps.
+    //
+    // Price moves, unit costs and step PnL are kept in Real (float halves
+    // their bytes and doubles the SIMD width of the PnL loop) and positions
+    // are read as PositionT (int8_t: 1 byte per candidate bar instead of 4).
+    // Everything accumulated stays in double and is compensated by
+    // blocking: each kMixedBlockBars steps are reduced to a two-pass mean
+    // and sum of squared deviations and merged as in RunningMetrics, and
+    // equity is a block-local prefix added to a per-block base, so rounding
+    // does not grow with the length of the series.
+    //
+    // With Real = float the only error is the rounding of the moves, costs
+    // and step PnL to float (relative 2^-24 each), so against run_batch:
+    //   |sharpe_ratio diff| <= kMixedSharpeTolerance * max(1, |sharpe_ratio|)
+    //   |total_return diff|, |max_drawdown diff|
+    //       <= 2^-22 * sum(|position * move| + |trade cost|) / capital
+    // (measured sharpe differences are around 1e-8 relative). Real = double
+    // reproduces run_batch up to rounding. Instantiated for Real in
+    // {float, double} and PositionT in {std::int8_t, int}.
+    static constexpr std::size_t kMixedBlockBars = 1024;
+    static constexpr double kMixedSharpeTolerance = 1e-6;
+
+    template <typename Real, typename PositionT>
+    BatchResult run_batch_mixed(ArrayView<const double> prices,
+                                ArrayView<const PositionT> signal_matrix,
+                                double dt_in_years) const;
+
+    // Building blocks of run_batch, exposed so schedulers can split the
+    // candidates of one batch across threads.
+    //
+    // precompute_moves:  shared per-series data for `prices`.
+    // allocate_curves:   size `out` for N x T candidates and take the curve
+    //                    blocks selected by `outputs` from `curve_memory`.
+    // run_candidates:    evaluate rows [begin, end) of signal_matrix and write
+    //                    their statistics (and curves, if `out` has them)
+    //                    into `out`, which must already be sized for every
+    //                    candidate. Rows are independent, so disjoint ranges
+    //                    may run concurrently. Profiling counters for the
+    //                    range are added to `stats` if given (one record per
+    //                    concurrent caller).
+    PriceMoves precompute_moves(ArrayView<const double> prices) const;
+
+    void allocate_curves(BatchResult& out,
+                         std::size_t num_candidates,
+                         std::size_t num_steps,
+                         std::pmr::memory_resource& curve_memory,
+                         OutputMask outputs) const;
+
+    void run_candidates(const PriceMoves& moves,
+                        ArrayView<const int> signal_matrix,
+                        std::size_t begin,
+                        std::size_t end,
+                        double dt_in_years,
+                        BatchResult& out,
+                        BacktestStats* stats = nullptr) const;
+
+    // Statistics of existing curves, as used by run_backtest when both the
+    // equity curve and the PnL are kept.
+    //
+    // compute_max_drawdown:  max peak-to-trough drawdown of an equity curve.
+    // compute_sharpe:        annualised Sharpe ratio of per-step PnL
+    //                        (equity differences).
+    double compute_max_drawdown(ArrayView<const double> equity) const;
+
+    double compute_sharpe(ArrayView<const double> pnl,
+                          double dt_in_years) const;
+
+private:
+    double initial_capital_;
+    double transaction_cost_pct_;
+    double risk_free_rate_;
+
+    // Per-block step PnL: out[i - begin] = pnl[i] for i in [begin, end).
+    using StepPnlFn = void (*)(const void* context,
+                               const double* prices,
+                               const int* signals,
+                               std::size_t begin,
+                               std::size_t end,
+                               double* out);
+
+    // ExecutionMode::ParallelScan backend of run_backtest.
+    BacktestResult run_parallel_scan(ArrayView<const double> prices,
+                                     ArrayView<const int> signals,
+                                     double dt_in_years,
+                                     OutputMask outputs,
+                                     const ExecutionPolicy& policy) const;
+
+    // Shared blocked loop of the vectorised backtests: step_pnl(context, ...)
+    // fills each block, then the ISA kernels form equity and statistics.
+    BacktestResult run_blocked(ArrayView<const double> prices,
+                               ArrayView<const int> signals,
+                               double dt_in_years,
+                               OutputMask outputs,
+                               const PnlKernels& kernels,
+                               StepPnlFn step_pnl,
+                               const void* context) const;
+
+    // Shared single-series loop, a template over its policies: the
+    // position type, the cost policy (see CostModels.hpp) and the output
+    // policy (which curves to store and whether statistics are fused into
+    // the loop, computed from the curves or skipped). signal_at(i) yields
+    // the desired position for step i (i >= 1). Expects prices.size() >= 2.
+    template <typename PositionT, typename Outputs, typename CostPolicy, typename SignalFn>
+    BasicBacktestResult<PositionT> simulate(ArrayView<const double> prices,
+                                            SignalFn&& signal_at,
+                                            const CostPolicy& costs,
+                                            Outputs outputs,
+                                            double dt_in_years) const;
+
+    // simulate with the flat cost, specialised for the common output masks
+    // and runtime-flagged for the rest.
+    template <typename PositionT, typename SignalFn>
+    BasicBacktestResult<PositionT> dispatch_outputs(ArrayView<const double> prices,
+                                                    SignalFn&& signal_at,
+                                                    double dt_in_years,
+                                                    OutputMask outputs) const;
+
+    // Entry point of the variant with output mask `Outputs`.
+    template <typename PositionT, OutputMask Outputs>
+    BasicBacktestResult<PositionT> run_fixed(ArrayView<const double> prices,
+                                             ArrayView<const PositionT> positions,
+                                             double dt_in_years) const;
+
+    // Rows [begin, end) of a batch; StoreCurves also writes the row's
+    // equity / pnl / position into the curve blocks of `out`.
+    template <bool StoreCurves>
+    void run_candidate_range(const PriceMoves& moves,
+                             ArrayView<const int> signal_matrix,
+                             std::size_t begin,
+                             std::size_t end,
+                             double dt_in_years,
+                             BatchResult& out,
+                             BacktestStats* stats) const;
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>      // std::memcpy
+#include <string>
+#include <type_traits>
+#include <utility>      // std::move
+
+// Minimal helpers for the engine's binary state formats. Values are stored
+// in native (little-endian on all supported targets) byte order.
+class BinaryWriter {
+public:
+    template <typename T>
+    void write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "POD values only");
+        buffer_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void write_bytes(const void* data, std::size_t size)
+    {
+        buffer_.append(static_cast<const char*>(data), size);
+    }
+
+    const std::string& str() const { return buffer_; }
+    std::string take() { return std::move(buffer_); }
+
+private:
+    std::string buffer_;
+};
+
+// Bounds-checked reader; every read returns false once the input is
+// exhausted or malformed, leaving the target unchanged.
+class BinaryReader {
+public:
+    BinaryReader(const char* data, std::size_t size) : data_(data), size_(size) {}
+    explicit BinaryReader(const std::string& s) : BinaryReader(s.data(), s.size()) {}
+
+    template <typename T>
+    bool read(T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "POD values only");
+        if (size_ - pos_ < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, data_ + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+
+    bool read_bytes(void* out, std::size_t size)
+    {
+        if (size_ - pos_ < size) {
+            return false;
+        }
+        std::memcpy(out, data_ + pos_, size);
+        pos_ += size;
+        return true;
+    }
+
+    std::size_t remaining() const { return size_ - pos_; }
+
+private:
+    const char* data_;
+    std::size_t size_;
+    std::size_t pos_ = 0;
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "ArrayView.hpp"
+#include "ThreadPool.hpp"
+
+// Resampling scheme for the PnL series.
+enum class BootstrapMethod {
+    Stationary,  // Politis-Romano: geometric block lengths with the given mean
+    Block        // circular moving blocks of fixed length
+};
+
+// Quantiles of the resampled statistics, one row per config.
+struct BootstrapResult {
+    std::size_t num_configs = 0;    // N
+    std::size_t num_quantiles = 0;  // Q
+    std::size_t num_resamples = 0;
+
+    std::vector<double> probabilities;  // size Q
+
+    // N x Q, row k = quantiles of config k at `probabilities`.
+    std::vector<double> sharpe_ratio;
+    std::vector<double> max_drawdown;
+    std::vector<double> total_return;
+
+    // Per-config means of the resampled statistics (size N).
+    std::vector<double> sharpe_mean;
+    std::vector<double> max_drawdown_mean;
+};
+
+// Bootstrap distributions of Sharpe ratio, max drawdown and total return.
+//
+// Every resample is a series of the same length as the input, assembled
+// from blocks of the original PnL (wrapping circularly) and evaluated in a
+// single fused pass with the engine's conventions (equity starts at
+// initial_capital, Welford Sharpe, running-peak drawdown); no resampled
+// series is ever stored.
+//
+// Resample r of config k draws from its own CounterRng stream keyed by
+// (seed, k, r), so the results are identical for any thread count.
+class BootstrapEngine {
+public:
+    //  initial_capital:    starting equity of every resample
+    //  num_resamples:      resamples per config
+    //  mean_block_length:  mean (Stationary) or fixed (Block) block length
+    //  method:             resampling scheme
+    //  seed:               RNG seed
+    //  num_threads:        worker threads (0 = hardware concurrency)
+    BootstrapEngine(double initial_capital,
+                    std::size_t num_resamples = 10000,
+                    double mean_block_length = 20.0,
+                    BootstrapMethod method = BootstrapMethod::Stationary,
+                    std::uint64_t seed = 0,
+                    std::size_t num_threads = 0);
+
+    std::size_t num_threads() const { return pool_->size(); }
+
+    //  pnl_matrix:      row-major N x T block, row k = per-step PnL of config
+    //                   k (e.g. BacktestResult::pnl)
+    //  num_steps:       T
+    //  dt_in_years:     time step in years (e.g. 1.0/252 for daily data)
+    //  probabilities:   quantile levels in [0, 1] (linear interpolation
+    //                   between order statistics, as numpy.quantile)
+    //
+    // Returns an empty result if the sizes do not match.
+    BootstrapResult run(ArrayView<const double> pnl_matrix,
+                        std::size_t num_steps,
+                        double dt_in_years,
+                        const std::vector<double>& probabilities = {0.05, 0.5, 0.95}) const;
+
+    ThreadPool& pool() const { return *pool_; }
+
+private:
+    double initial_capital_;
+    std::size_t num_resamples_;
+    double mean_block_length_;
+    BootstrapMethod method_;
+    std::uint64_t seed_;
+    std::unique_ptr<ThreadPool> pool_;
+};
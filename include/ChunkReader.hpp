@@ -0,0 +1,69 @@
+#pragma once
+
+#include <algorithm>    // std::min
+#include <cstddef>
+#include <string>
+
+#include "ArrayView.hpp"
+#include "PriceStore.hpp"
+
+class CsvPriceReader;
+
+// Sequential source of one series in blocks, for backtests over series
+// that do not fit in memory (see BacktestEngine::run_backtest_chunked).
+//
+// next(max_items) returns the next min(max_items, remaining) items, so a
+// block is only short at the end of the series, and an empty view once the
+// series is exhausted. The view stays valid until the next call.
+template <typename T>
+class ChunkReader {
+public:
+    virtual ~ChunkReader() = default;
+
+    virtual ArrayView<const T> next(std::size_t max_items) = 0;
+};
+
+using PriceChunkReader = ChunkReader<double>;
+using SignalChunkReader = ChunkReader<int>;
+
+// Blocks of an existing view, e.g. a PriceStore column. Store columns are
+// memory-mapped, so only the pages of the blocks being read are touched,
+// and those are clean file pages the OS can drop again.
+template <typename T>
+class ViewChunkReader : public ChunkReader<T> {
+public:
+    explicit ViewChunkReader(ArrayView<const T> data) : data_(data) {}
+
+    ArrayView<const T> next(std::size_t max_items) override
+    {
+        std::size_t count = std::min(max_items, data_.size() - offset_);
+        ArrayView<const T> block = data_.subview(offset_, count);
+        offset_ += count;
+        return block;
+    }
+
+private:
+    ArrayView<const T> data_;
+    std::size_t offset_ = 0;
+};
+
+// One price column of an open CsvPriceReader, parsed read_rows() at a
+// time, so only one block of rows is held in memory. Rows come in file
+// order. A read error ends the series early; check ok() afterwards.
+class CsvChunkReader : public ChunkReader<double> {
+public:
+    //  reader:  open reader, positioned after its header
+    //  column:  Open, High, Low, Close or AdjClose
+    explicit CsvChunkReader(CsvPriceReader& reader, PriceStore::Column column = PriceStore::Close);
+
+    ArrayView<const double> next(std::size_t max_items) override;
+
+    bool ok() const { return error_.empty(); }
+    const std::string& error() const { return error_; }
+
+private:
+    CsvPriceReader& reader_;
+    PriceStore::Column column_;
+    PriceColumns rows_;
+    std::string error_;
+};
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "ArrayView.hpp"
+#include "BacktestEngine.hpp"
+#include "RollingSharpe.hpp"
+#include "SignalGenerator.hpp"
+
+enum class ColumnType : std::uint32_t {
+    Int64 = 1,
+    Float64 = 2
+};
+
+struct ColumnSpec {
+    std::string name;
+    ColumnType type = ColumnType::Float64;
+};
+
+// One column of a row group: a view of `rows` values of the column's type,
+// or a single value repeated over the group.
+struct ColumnChunk {
+    ColumnType type = ColumnType::Float64;
+    const void* data = nullptr;  // rows values, or the one repeated value
+    std::size_t rows = 0;
+    bool repeated = false;
+    std::int64_t int_value = 0;   // the value of a repeated chunk
+    double double_value = 0.0;
+
+    ColumnChunk(ArrayView<const std::int64_t> values)
+        : type(ColumnType::Int64), data(values.data()), rows(values.size()) {}
+    ColumnChunk(ArrayView<const double> values)
+        : type(ColumnType::Float64), data(values.data()), rows(values.size()) {}
+
+    static ColumnChunk repeat(std::int64_t value, std::size_t rows);
+    static ColumnChunk repeat(double value, std::size_t rows);
+};
+
+// Streaming writer of columnar result files (e.g. rolling Sharpe panels
+// and sweep results), read back zero-copy by python/columnar.py.
+//
+// File layout (little-endian):
+//   [0, 64)     header: magic "MRTABLE\0", uint32 version, uint32 column
+//               count, uint64 row count, uint64 row group count, uint64
+//               footer offset (zero padded; counts and offset stay 0 until
+//               close(), which marks an unfinished file)
+//   row groups  one chunk per column, each starting on a 64-byte boundary:
+//               Plain chunks hold rows * 8 bytes (int64 or float64),
+//               Constant chunks the single 8-byte value of every row
+//   footer      per column: uint32 type, uint32 name length, name bytes;
+//               then per row group: uint64 rows and, per column, uint32
+//               encoding (0 Plain, 1 Constant), uint32 0, uint64 offset
+//
+// Plain chunks can be memory-mapped and handed to NumPy or Arrow without
+// parsing. A chunk whose values are all bitwise equal is stored Constant,
+// which is what keeps per-group key columns (window, candidate
+// parameters) from costing 8 bytes a row.
+class ColumnarWriter {
+public:
+    ColumnarWriter() = default;
+    ~ColumnarWriter();  // without close(), leaves the file unfinished
+
+    ColumnarWriter(const ColumnarWriter&) = delete;
+    ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+
+    // Create `path` for the given schema, abandoning any file still open.
+    // Returns false (and sets `error` if given) when the file cannot be
+    // created or the schema is empty.
+    bool open(const std::string& path, std::vector<ColumnSpec> columns, std::string* error = nullptr);
+
+    // Append one row group: one chunk per column, in schema order, of the
+    // column's type and all with the same number of rows. Empty groups are
+    // skipped.
+    bool write_row_group(const std::vector<ColumnChunk>& chunks, std::string* error = nullptr);
+
+    // Write the footer and header. Returns false on a write error.
+    bool close(std::string* error = nullptr);
+
+    bool is_open() const { return out_.is_open(); }
+    std::uint64_t rows_written() const { return num_rows_; }
+    std::size_t row_groups_written() const { return groups_.size(); }
+
+private:
+    struct ChunkEntry {
+        std::uint32_t encoding = 0;
+        std::uint64_t offset = 0;
+    };
+    struct GroupEntry {
+        std::uint64_t rows = 0;
+        std::vector<ChunkEntry> chunks;
+    };
+
+    std::ofstream out_;
+    std::string path_;
+    std::vector<ColumnSpec> columns_;
+    std::vector<GroupEntry> groups_;
+    std::uint64_t num_rows_ = 0;
+    std::uint64_t position_ = 0;  // bytes written so far
+
+    void pad_to(std::size_t alignment);
+    void put(const void* data, std::size_t bytes);
+};
+
+// The panel of python/monitor_sharpe.py: columns timestamp (int64 epoch
+// seconds), signal_window, sharpe_window (int64) and rolling_sharpe,
+// one row group per (signal window, Sharpe window) with NaN rows dropped
+// (as panel.dropna() does).
+//
+//  timestamps:      bar timestamps (size T)
+//  signal_windows:  signal window of each panel
+//  panels:          one rolling Sharpe panel (W x T) per signal window
+bool write_sharpe_panel(const std::string& path,
+                        ArrayView<const std::int64_t> timestamps,
+                        const std::vector<std::size_t>& signal_windows,
+                        const std::vector<RollingSharpePanel>& panels,
+                        std::string* error = nullptr);
+
+// Sweep statistics: columns candidate (int64), then window, z_entry and
+// z_exit when `grid` is given (one SignalParams per candidate), then
+// total_return, max_drawdown and sharpe_ratio, in row groups of
+// `rows_per_group` candidates.
+bool write_batch_result(const std::string& path,
+                        const BatchResult& result,
+                        const std::vector<SignalParams>* grid = nullptr,
+                        std::size_t rows_per_group = 65536,
+                        std::string* error = nullptr);
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <algorithm>    // std::max, std::min
+#include <cmath>        // std::sqrt
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>      // std::abs(int)
+#include <limits>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "ArrayView.hpp"
+#include "BacktestEngine.hpp"
+
+// Transaction cost policies for BacktestEngine::run_backtest_with_costs.
+//
+// A policy is any type with
+//   double operator()(std::size_t i, double units, double price) const;
+//   std::size_t size() const;
+// returning the cost of trading `units` = |pos[i] - pos[i-1]| at bar i and
+// price `price`, and the number of bars it has data for (SIZE_MAX if it
+// needs none). The call must be 0 for units == 0 and should stay
+// branch-free (ternaries and std::max are fine), since it is inlined into
+// the elementwise PnL loop and that loop is meant to vectorise.
+//
+// Policies are combined at compile time, e.g.
+//   MinimumFee<CostSum<ProportionalCost, SpreadCost, SqrtImpactCost>>
+// so there is no virtual dispatch per bar.
+
+// Cost proportional to traded notional: units * price * cost_pct. This is
+// the engine's own flat cost model, and from_bps() gives the bps-on-turnover
+// convention of backtest_returns / StrategyMonitor (cost_bps / 1e4 per unit
+// of notional turnover).
+struct ProportionalCost {
+    double cost_pct = 0.0;
+
+    explicit ProportionalCost(double cost_pct_in) : cost_pct(cost_pct_in) {}
+
+    static ProportionalCost from_bps(double cost_bps) { return ProportionalCost(cost_bps / 10000.0); }
+
+    double operator()(std::size_t, double units, double price) const
+    {
+        return units * price * cost_pct;
+    }
+
+    std::size_t size() const { return std::numeric_limits<std::size_t>::max(); }
+};
+
+// Spread cost estimated from the bar range: each unit traded pays
+// spread_fraction * (high[i] - low[i]), e.g. 0.5 for crossing half of a
+// spread taken to be the whole range.
+struct SpreadCost {
+    ArrayView<const double> highs;
+    ArrayView<const double> lows;
+    double spread_fraction = 0.5;
+
+    SpreadCost(ArrayView<const double> highs_in,
+               ArrayView<const double> lows_in,
+               double spread_fraction_in = 0.5)
+        : highs(highs_in), lows(lows_in), spread_fraction(spread_fraction_in) {}
+
+    double operator()(std::size_t i, double units, double) const
+    {
+        // Select rather than multiply, so that a missing (NaN) High or Low
+        // costs nothing on a bar without a trade.
+        return units > 0.0 ? units * spread_fraction * (highs[i] - lows[i]) : 0.0;
+    }
+
+    std::size_t size() const { return std::min(highs.size(), lows.size()); }
+};
+
+// Square-root market impact: the average price moves against the trade by
+// coefficient * price * sqrt(units / volume[i]), so
+//   cost = coefficient * price * units * sqrt(units / volume[i]).
+// `coefficient` absorbs the volatility scale (e.g. eta * daily sigma).
+// Bars with zero or missing (NaN) volume are treated as volume 1.
+class SqrtImpactCost {
+public:
+    SqrtImpactCost(ArrayView<const std::int64_t> volumes, double coefficient)
+        : coefficient_(coefficient), inv_volume_(volumes.size())
+    {
+        for (std::size_t i = 0; i < volumes.size(); ++i) {
+            inv_volume_[i] = 1.0 / static_cast<double>(std::max<std::int64_t>(volumes[i], 1));
+        }
+    }
+
+    SqrtImpactCost(ArrayView<const double> volumes, double coefficient)
+        : coefficient_(coefficient), inv_volume_(volumes.size())
+    {
+        for (std::size_t i = 0; i < volumes.size(); ++i) {
+            inv_volume_[i] = 1.0 / (volumes[i] >= 1.0 ? volumes[i] : 1.0);
+        }
+    }
+
+    double operator()(std::size_t i, double units, double price) const
+    {
+        double cost = coefficient_ * price * units * std::sqrt(units * inv_volume_[i]);
+        return units > 0.0 ? cost : 0.0;
+    }
+
+    std::size_t size() const { return inv_volume_.size(); }
+
+private:
+    double coefficient_;
+    std::vector<double> inv_volume_;  // 1 / volume, precomputed once
+};
+
+// Floor every trade at `min_fee`; bars without a trade stay free.
+template <typename Inner>
+struct MinimumFee {
+    Inner inner;
+    double min_fee = 0.0;
+
+    MinimumFee(Inner inner_in, double min_fee_in)
+        : inner(std::move(inner_in)), min_fee(min_fee_in) {}
+
+    double operator()(std::size_t i, double units, double price) const
+    {
+        double cost = std::max(min_fee, inner(i, units, price));
+        return units > 0.0 ? cost : 0.0;
+    }
+
+    std::size_t size() const { return inner.size(); }
+};
+
+// Sum of several policies.
+template <typename... Parts>
+struct CostSum {
+    std::tuple<Parts...> parts;
+
+    explicit CostSum(Parts... parts_in) : parts(std::move(parts_in)...) {}
+
+    double operator()(std::size_t i, double units, double price) const
+    {
+        return std::apply([&](const Parts&... p) { return (0.0 + ... + p(i, units, price)); }, parts);
+    }
+
+    std::size_t size() const
+    {
+        return std::apply([](const Parts&... p) {
+            return std::min({std::numeric_limits<std::size_t>::max(), p.size()...});
+        }, parts);
+    }
+};
+
+// Step PnL of bars [begin, end) under `costs`, with the same expression and
+// operation order as the flat kernels:
+//   pnl[i] = (0.0 - costs(i, |pos[i] - pos[i-1]|, p[i])) + pos[i] * (p[i] - p[i-1])
+// (the reference loop's order, which also gives +0.0 on flat bars)
+// The first bar trades from flat; every other bar is an independent
+// elementwise step.
+template <typename CostModel>
+void cost_step_pnl(const CostModel& costs,
+                   const double* prices,
+                   const int* signals,
+                   std::size_t begin,
+                   std::size_t end,
+                   double* out)
+{
+    std::size_t i = begin;
+    if (i == 0 && i < end) {
+        out[0] = 0.0;
+        ++i;
+    }
+    if (i == 1 && i < end) {
+        double units = std::abs(signals[1]);
+        out[1 - begin] = (0.0 - costs(1, units, prices[1])) + signals[1] * (prices[1] - prices[0]);
+        ++i;
+    }
+    for (; i < end; ++i) {
+        double units = std::abs(signals[i] - signals[i - 1]);
+        out[i - begin] = (0.0 - costs(i, units, prices[i])) + signals[i] * (prices[i] - prices[i - 1]);
+    }
+}
+
+template <typename CostModel>
+BacktestResult BacktestEngine::run_backtest_with_costs(ArrayView<const double> prices,
+                                                       ArrayView<const int> signals,
+                                                       const CostModel& costs,
+                                                       double dt_in_years,
+                                                       OutputMask outputs,
+                                                       KernelIsa isa) const
+{
+    if (costs.size() < prices.size()) {
+        return BacktestResult();
+    }
+
+    auto step = [](const void* context, const double* p, const int* s,
+                   std::size_t begin, std::size_t end, double* out) {
+        cost_step_pnl(*static_cast<const CostModel*>(context), p, s, begin, end, out);
+    };
+    return run_blocked(prices, signals, dt_in_years, outputs, select_pnl_kernels(isa), step, &costs);
+}
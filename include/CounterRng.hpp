@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+
+// Counter-based random stream: value k of stream `key` is a fixed hash of
+// (key, k), so any stream can be regenerated independently of which thread
+// runs it or in what order. The hash is the SplitMix64 finaliser, which
+// passes BigCrush on sequential counters.
+class CounterRng {
+public:
+    // Derive a stream key from a seed and up to two stream coordinates,
+    // e.g. (config, resample).
+    static std::uint64_t stream_key(std::uint64_t seed, std::uint64_t a, std::uint64_t b = 0)
+    {
+        return mix(mix(mix(seed) ^ a) ^ (b + 0x632be59bd9b4e019ull));
+    }
+
+    explicit CounterRng(std::uint64_t key, std::uint64_t counter = 0)
+        : key_(key), counter_(counter) {}
+
+    std::uint64_t next_u64()
+    {
+        return mix(key_ + (++counter_) * 0x9e3779b97f4a7c15ull);
+    }
+
+    // Uniform double in [0, 1) with 53 random bits.
+    double next_double()
+    {
+        return static_cast<double>(next_u64() >> 11) * 0x1.0p-53;
+    }
+
+    std::uint64_t counter() const { return counter_; }
+
+private:
+    std::uint64_t key_;
+    std::uint64_t counter_;
+
+    static std::uint64_t mix(std::uint64_t z)
+    {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "PriceStore.hpp"
+
+// "YYYY-MM-DD[( |T)HH:MM[:SS[.fff]]][Z|(+|-)HH:MM]" in [begin, end) -> UTC
+// epoch seconds. Returns false unless the whole field is a timestamp.
+bool parse_csv_timestamp(const char* begin, const char* end, std::int64_t& out);
+
+// Decimal number in [begin, end). Plain [+-]digits[.digits][e[+-]digits]
+// fields of up to 19 significant digits take an exact fast path (correctly
+// rounded, so identical to strtod); anything else, including hex floats,
+// "nan" and "inf", falls back to strtod.
+// Returns false unless the whole field parses and is in range.
+bool parse_csv_double(const char* begin, const char* end, double& out);
+
+// Streaming reader for price CSVs (the yfinance layout with its Ticker /
+// Date rows, or a plain Date,Open,High,Low,Close,... header).
+//
+// The file is read in fixed-size blocks and parsed in place, so memory use
+// is bounded by the block size plus one chunk of rows, whatever the file
+// size. Rows without a parsable date or Close are skipped, which drops the
+// yfinance Ticker / Date rows; missing optional columns read as NaN
+// (prices) or 0 (volume). Rows are returned in file order.
+class CsvPriceReader {
+public:
+    //  buffer_bytes:    size of the read block (grown for longer lines)
+    explicit CsvPriceReader(std::size_t buffer_bytes = std::size_t(1) << 20);
+    ~CsvPriceReader();
+
+    CsvPriceReader(const CsvPriceReader&) = delete;
+    CsvPriceReader& operator=(const CsvPriceReader&) = delete;
+
+    // Open `path` and read its header row. Returns false (and sets `error`
+    // if given) when the file cannot be read or has no Close column.
+    bool open(const std::string& path, std::string* error = nullptr);
+    void close();
+
+    bool is_open() const { return file_ != nullptr; }
+
+    // Whether the header names column `c` (Timestamp is always present).
+    bool has_column(PriceStore::Column c) const;
+
+    // Replace `out` with the next (up to) max_rows records. Returns false
+    // (and sets `error` if given) on a read error; an empty `out` marks the
+    // end of the file.
+    bool read_rows(PriceColumns& out, std::size_t max_rows, std::string* error = nullptr);
+
+    std::size_t rows_read() const { return rows_read_; }        // records returned so far
+    std::size_t rows_skipped() const { return rows_skipped_; }  // unparsable lines
+
+private:
+    std::FILE* file_ = nullptr;
+    std::string path_;
+
+    std::vector<char> buffer_;
+    std::size_t begin_ = 0;  // first unparsed byte
+    std::size_t end_ = 0;    // one past the last byte read
+    bool eof_ = false;
+
+    static constexpr std::size_t kMissing = static_cast<std::size_t>(-1);
+    std::size_t date_col_ = 0;
+    std::size_t col_[PriceStore::NumColumns] = {};
+    std::size_t num_needed_ = 0;  // fields a record must have
+    std::vector<const char*> field_starts_;  // per-record scratch, one per
+    std::vector<const char*> field_stops_;   // field up to the last used column
+
+    std::size_t rows_read_ = 0;
+    std::size_t rows_skipped_ = 0;
+
+    // Next complete line as [line, line_end) without the line break;
+    // false at end of file or on a read error.
+    bool next_line(const char*& line, const char*& line_end, std::string* error);
+    bool fill(std::string* error);
+    bool parse_header(const char* line, const char* line_end);
+    bool parse_record(const char* line, const char* line_end, PriceColumns& out);
+};
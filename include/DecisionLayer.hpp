@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ArrayView.hpp"
+#include "RollingSharpe.hpp"
+
+// Risk modes of the decision layer, in increasing severity.
+enum class RiskMode : std::int8_t {
+    Normal = 0,  // full size
+    Reduce = 1,  // half size
+    Stop = 2     // flat
+};
+
+// Position multiplier for a mode (1.0, 0.5, 0.0).
+double risk_mode_multiplier(RiskMode mode);
+
+const char* risk_mode_name(RiskMode mode);
+
+// Decision for one bar.
+struct Decision {
+    RiskMode risk_mode = RiskMode::Normal;
+    double position_multiplier = 1.0;
+    double frac_below_warn = 0.0;  // share of signal windows with score < warn_sharpe
+    double frac_below_stop = 0.0;  // share of signal windows with score < stop_sharpe
+};
+
+// Decisions for every bar of a Sharpe panel grid.
+struct DecisionSeries {
+    std::size_t num_signal_windows = 0;  // S
+    std::size_t num_steps = 0;           // T
+
+    std::vector<std::int8_t> risk_mode;        // size T, RiskMode values
+    std::vector<double> position_multiplier;   // size T
+    std::vector<double> frac_below_warn;       // size T
+    std::vector<double> frac_below_stop;       // size T
+
+    // S x T, row s = median Sharpe across sharpe windows of signal window s
+    // (NaN where every window is NaN).
+    std::vector<double> scores;
+};
+
+// Native version of compute_decision() in python/decision_layer.py.
+//
+// Each signal window's score is its median rolling Sharpe across the Sharpe
+// windows (NaNs skipped). A NaN score counts as neither below warn nor below
+// stop, but still counts towards the number of windows:
+//   frac_below_stop >= frac_stop   -> STOP   (multiplier 0)
+//   frac_below_warn >= frac_warn   -> REDUCE (multiplier 0.5)
+//   otherwise                      -> NORMAL (multiplier 1)
+class DecisionLayer {
+public:
+    explicit DecisionLayer(double warn_sharpe = 0.0,
+                           double stop_sharpe = -0.5,
+                           double frac_warn = 0.5,
+                           double frac_stop = 0.75);
+
+    // Decide from one snapshot, e.g. StrategyMonitor::sharpe_snapshot().
+    //  snapshot:            row-major S x H (signal windows x sharpe windows)
+    //  num_signal_windows:  S
+    Decision decide(ArrayView<const double> snapshot, std::size_t num_signal_windows) const;
+
+    // Decide for every bar.
+    //  grid:                S x H x T (time innermost), e.g. the values of S
+    //                       stacked RollingSharpePanels
+    //  num_signal_windows:  S
+    //  num_sharpe_windows:  H
+    // Returns an empty series if the sizes do not match.
+    DecisionSeries evaluate(ArrayView<const double> grid,
+                            std::size_t num_signal_windows,
+                            std::size_t num_sharpe_windows) const;
+
+    // Same, with one panel per signal window (all with the same windows and
+    // number of steps).
+    DecisionSeries evaluate(const std::vector<RollingSharpePanel>& panels) const;
+
+    double warn_sharpe() const { return warn_sharpe_; }
+    double stop_sharpe() const { return stop_sharpe_; }
+    double frac_warn() const { return frac_warn_; }
+    double frac_stop() const { return frac_stop_; }
+
+private:
+    double warn_sharpe_;
+    double stop_sharpe_;
+    double frac_warn_;
+    double frac_stop_;
+
+    // Shared kernel; row_at(s) points at the H x T block of signal window s.
+    template <typename RowFn>
+    DecisionSeries evaluate_impl(RowFn&& row_at,
+                                 std::size_t num_signal_windows,
+                                 std::size_t num_sharpe_windows,
+                                 std::size_t num_steps) const;
+
+    Decision classify(std::size_t below_warn, std::size_t below_stop,
+                      std::size_t num_signal_windows) const;
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cmath>        // std::fabs
+#include <limits>
+
+// Numeric helpers shared by the rolling-statistics and sparse-backtest
+// sources. Internal to backtest_core; not part of the bindings.
+
+// Relative floor below which a window variance counts as zero: var is
+// treated as 0 unless var > kZeroVarianceTolerance * mean^2, which absorbs
+// the cancellation left in E[x^2] - E[x]^2 for constant windows.
+constexpr double kZeroVarianceTolerance = 64.0 * std::numeric_limits<double>::epsilon();
+
+// Neumaier step: add x to the running sum hi + lo.
+inline void compensated_add(double& hi, double& lo, double x)
+{
+    double t = hi + x;
+    lo += (std::fabs(hi) >= std::fabs(x)) ? (hi - t) + x : (x - t) + hi;
+    hi = t;
+}
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <algorithm>    // std::min, std::max
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ArrayView.hpp"
+#include "BacktestEngine.hpp"
+
+// OHLC columns of one series, e.g. the views of a PriceStore. All four
+// must have the same size.
+struct OhlcBars {
+    ArrayView<const double> open;
+    ArrayView<const double> high;
+    ArrayView<const double> low;
+    ArrayView<const double> close;
+
+    std::size_t size() const { return close.size(); }
+};
+
+enum class OrderType : std::uint8_t {
+    Market = 0,  // fills at the open
+    Limit,       // buy at or below / sell at or above `price`
+    Stop,        // buy at or above / sell at or below `price`
+    Cancel       // removes the working orders for `when_position`
+};
+
+// One order instruction of BacktestEngine::run_orders.
+//
+// An order belongs to the position it was placed for: it only works while
+// the position is `when_position` and moves it to `target_position` (a buy
+// when the target is higher, a sell when lower). Each position has one
+// slot per side and order type, so e.g. a stop-loss and a take-profit limit
+// can work together, and a newer order for the same side and type replaces
+// the working one (an order modification). A Cancel with target_position
+// equal to when_position clears every order of the position, otherwise
+// only those on the side towards target_position. All orders of a position
+// are one-cancels-other: when any of them fills, the rest are dropped.
+struct OrderEvent {
+    std::size_t bar = 0;         // first bar the order works on (bar 0 acts from bar 1)
+    OrderType type = OrderType::Market;
+    int when_position = 0;       // -1, 0 or +1
+    int target_position = 0;     // -1, 0 or +1
+    double price = 0.0;          // limit / stop level; unused for Market and Cancel
+};
+
+// An executed order.
+struct OrderFill {
+    std::size_t bar = 0;
+    OrderType type = OrderType::Market;
+    int from_position = 0;
+    int to_position = 0;
+    double price = 0.0;          // execution price
+    double cost = 0.0;           // |to - from| * price * transaction_cost_pct
+};
+
+// Result of BacktestEngine::run_orders: the usual curves and statistics,
+// marked to market on the closes, and every fill in bar order.
+struct OrderBacktestResult {
+    BacktestResult backtest;
+    std::vector<OrderFill> fills;
+};
+
+// Working orders of run_orders: for each of the positions -1, 0 and +1 one
+// slot per side (buy, sell) and order type (Market, Limit, Stop), with a
+// per-position bitmask of the working slots, so that "nothing can fill in
+// this position" is a single load and trigger() only visits live slots.
+class OrderBook {
+public:
+    static bool valid(const OrderEvent& e)
+    {
+        bool positions = e.when_position >= -1 && e.when_position <= 1 &&
+                         e.target_position >= -1 && e.target_position <= 1;
+        if (!positions) {
+            return false;
+        }
+        if (e.type == OrderType::Cancel) {
+            return true;
+        }
+        if (e.target_position == e.when_position) {
+            return false;
+        }
+        return e.type == OrderType::Market || (std::isfinite(e.price) && e.price > 0.0);
+    }
+
+    void clear()
+    {
+        for (int p = -1; p <= 1; ++p) {
+            clear(p);
+        }
+    }
+
+    void clear(int position)
+    {
+        working_[position + 1] = 0;
+    }
+
+    bool empty(int position) const { return working_[position + 1] == 0; }
+
+    // Place, replace or cancel; e must be valid().
+    void apply(const OrderEvent& e)
+    {
+        int p = e.when_position;
+        if (e.type == OrderType::Cancel) {
+            if (e.target_position == p) {
+                clear(p);
+            } else {
+                int side = e.target_position > p ? kBuy : kSell;
+                for (int type = 0; type < kTypes; ++type) {
+                    remove(p, side * kTypes + type);
+                }
+            }
+            return;
+        }
+        int side = e.target_position > p ? kBuy : kSell;
+        int slot = side * kTypes + static_cast<int>(e.type);
+        Slot& s = book_[p + 1][slot];
+        working_[p + 1] |= 1u << slot;
+        s.type = e.type;
+        s.target = e.target_position;
+        s.price = e.price;
+    }
+
+    // The order of `position` that fills within a bar, if any. With several
+    // orders triggered, the price is taken to travel from the open to
+    // whichever level is nearer, so the fill closest to the open wins;
+    // on a tie the stop fills first (the pessimistic reading).
+    bool trigger(int position, double open, double high, double low, OrderFill& fill) const
+    {
+        const Slot* slots = book_[position + 1];
+        bool found = false;
+        double best_distance = 0.0;
+        unsigned live = working_[position + 1];
+        for (int k = 0; live >> k != 0; ++k) {
+            if (!((live >> k) & 1u)) {
+                continue;
+            }
+            const Slot& s = slots[k];
+            double price = 0.0;
+            if (!fills(s, k < kTypes, open, high, low, price)) {
+                continue;
+            }
+            double distance = std::fabs(price - open);
+            bool better = !found || distance < best_distance ||
+                          (distance == best_distance && s.type == OrderType::Stop &&
+                           fill.type != OrderType::Stop);
+            if (better) {
+                found = true;
+                best_distance = distance;
+                fill.type = s.type;
+                fill.from_position = position;
+                fill.to_position = s.target;
+                fill.price = price;
+            }
+        }
+        return found;
+    }
+
+private:
+    static constexpr int kBuy = 0;
+    static constexpr int kSell = 1;
+    static constexpr int kTypes = 3;           // Market, Limit, Stop
+    static constexpr int kSlots = 2 * kTypes;  // slot = side * kTypes + type
+
+    struct Slot {
+        OrderType type = OrderType::Market;
+        int target = 0;
+        double price = 0.0;
+    };
+
+    Slot book_[3][kSlots];
+    unsigned working_[3] = {0, 0, 0};  // bit k set: slot k holds an order
+
+    void remove(int position, int slot)
+    {
+        working_[position + 1] &= ~(1u << slot);
+    }
+
+    // Execution price of `s` within the bar: at the open when the open is
+    // already through the level (a gap), else at the level.
+    static bool fills(const Slot& s, bool buy, double open, double high, double low, double& price)
+    {
+        switch (s.type) {
+        case OrderType::Market:
+            price = open;
+            return true;
+        case OrderType::Limit:
+            if (buy ? low <= s.price : high >= s.price) {
+                price = buy ? std::min(open, s.price) : std::max(open, s.price);
+                return true;
+            }
+            return false;
+        case OrderType::Stop:
+            if (buy ? high >= s.price : low <= s.price) {
+                price = buy ? std::max(open, s.price) : std::min(open, s.price);
+                return true;
+            }
+            return false;
+        default:
+            return false;
+        }
+    }
+};
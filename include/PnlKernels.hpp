@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+
+// Vectorised building blocks for the flat-cost backtest.
+//
+// With the signals known up front, the per-step PnL is a pure elementwise
+// expression:
+//   pnl[i] = pos[i] * (p[i] - p[i-1]) - |pos[i] - pos[i-1]| * p[i] * cost_pct
+// (pos[0] = 0, the engine always starts flat), and equity is its prefix sum.
+// Each kernel has a portable scalar version plus AVX2 / AVX-512 (x86, picked
+// at runtime from CPUID) and NEON (AArch64) versions.
+enum class KernelIsa {
+    Auto,    // best available on this CPU
+    Scalar,  // portable reference implementation
+    Avx2,
+    Avx512,
+    Neon
+};
+
+// Kernel table for one instruction set. All ranges are [begin, end) of the
+// full series; output pointers address element `begin`.
+struct PnlKernels {
+    KernelIsa isa;
+
+    // out[i - begin] = pnl[i]. Bit-identical across ISAs and to the
+    // per-bar PnL of BacktestEngine::run_backtest.
+    void (*step_pnl)(const double* prices, const int* signals,
+                     std::size_t begin, std::size_t end,
+                     double cost_pct, double* out);
+
+    // out[k] = carry + x[0] + ... + x[k]; returns the final running sum.
+    double (*prefix_sum)(const double* x, std::size_t count, double carry, double* out);
+
+    // Fold `count` equity values into a running (peak, max_drawdown) pair.
+    void (*drawdown)(const double* equity, std::size_t count,
+                     double& peak, double& max_drawdown);
+
+    // Sum of x and sum of squared deviations from the block mean.
+    void (*moments)(const double* x, std::size_t count, double& sum, double& m2);
+};
+
+// Whether `isa` can run on this machine (Auto and Scalar always can).
+bool kernel_isa_supported(KernelIsa isa);
+
+// Resolve Auto to the best supported ISA; unsupported requests fall back
+// to Scalar.
+KernelIsa resolve_kernel_isa(KernelIsa isa);
+
+const char* kernel_isa_name(KernelIsa isa);
+
+// Kernel table for `isa` after resolve_kernel_isa().
+const PnlKernels& select_pnl_kernels(KernelIsa isa = KernelIsa::Auto);
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "ArrayView.hpp"
+
+// Outputs of a multi-asset backtest. Matrices are time-major: element
+// (t, j) of a T x N matrix is at index t * N + j.
+struct PortfolioResult {
+    std::size_t num_steps = 0;   // T
+    std::size_t num_assets = 0;  // N
+
+    // Aggregate portfolio series (size T).
+    std::vector<double> equity_curve;   // initial capital + cumulative net PnL
+    std::vector<double> pnl;            // net PnL per step, summed over assets
+    std::vector<double> turnover_cost;  // transaction cost paid per step
+
+    // Per-asset totals over the whole run (size N).
+    std::vector<double> asset_pnl;       // net PnL (after costs)
+    std::vector<double> asset_cost;      // transaction costs
+    std::vector<double> asset_turnover;  // traded notional, sum |dq| * price
+
+    // Per-asset cumulative net PnL (T x N), only when requested.
+    std::vector<double> asset_pnl_curve;
+
+    // Portfolio statistics, from the aggregate series.
+    double total_return = 0.0;   // (final_equity / initial_equity - 1)
+    double max_drawdown = 0.0;   // Max peak-to-trough drawdown (as fraction)
+    double sharpe_ratio = 0.0;   // Simple Sharpe ratio (annualised)
+};
+
+// Backtesting engine for many assets traded with the same cost model.
+//
+// Uses the single-asset engine's conventions per asset: the book starts
+// flat, the position for step t is positions(t, j) (units, may be
+// fractional), and changing it from q to q' costs |q' - q| * price * cost.
+// Prices and positions are T x N time-major matrices, so each step streams
+// one contiguous row of each input and the per-asset accumulators.
+class PortfolioBacktestEngine {
+public:
+    //  initial_capital:        starting portfolio equity
+    //  transaction_cost_pct:   proportional transaction cost per traded notional
+    //  risk_free_rate:         annual risk-free rate (kept for parity, unused)
+    PortfolioBacktestEngine(double initial_capital,
+                            double transaction_cost_pct,
+                            double risk_free_rate = 0.0);
+
+    // Run the portfolio backtest in a single pass over time.
+    //
+    //  prices:             T x N time-major price matrix
+    //  positions:          T x N time-major position matrix (units held)
+    //  num_assets:         N
+    //  dt_in_years:        time step in years (e.g. 1.0/252 for daily data)
+    //  keep_asset_curves:  also store the T x N per-asset cumulative PnL
+    //
+    // Returns:
+    //  PortfolioResult (empty if the shapes do not match or T < 2).
+    PortfolioResult run(ArrayView<const double> prices,
+                        ArrayView<const double> positions,
+                        std::size_t num_assets,
+                        double dt_in_years,
+                        bool keep_asset_curves = false) const;
+
+private:
+    double initial_capital_;
+    double transaction_cost_pct_;
+    double risk_free_rate_;
+};
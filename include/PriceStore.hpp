@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ArrayView.hpp"
+
+// In-memory OHLCV columns, used to build a price store file.
+struct PriceColumns {
+    std::vector<std::int64_t> timestamp;  // seconds since 1970-01-01 UTC
+    std::vector<double> open;
+    std::vector<double> high;
+    std::vector<double> low;
+    std::vector<double> close;
+    std::vector<double> adj_close;
+    std::vector<std::int64_t> volume;
+
+    std::size_t size() const { return timestamp.size(); }
+};
+
+// Read-only, memory-mapped columnar price file.
+//
+// File layout (little-endian):
+//   [0, 128)    header: magic "MRPRICE\0", uint32 version, uint32 column
+//               count, uint64 row count, then one uint64 byte offset per
+//               column in PriceStore::Column order (zero padded)
+//   [128, ...)  columns, each row_count * 8 bytes, starting on a 64-byte
+//               boundary: timestamp (int64), open, high, low, close,
+//               adj_close (float64), volume (int64)
+//
+// Opening a store only maps the file; the column accessors are views
+// straight into the mapping, so they can be handed to the engine without
+// parsing or copying. Views stay valid until close() or destruction.
+class PriceStore {
+public:
+    enum Column : std::uint32_t {
+        Timestamp = 0,
+        Open,
+        High,
+        Low,
+        Close,
+        AdjClose,
+        Volume,
+        NumColumns
+    };
+
+    PriceStore() = default;
+    ~PriceStore();
+
+    PriceStore(PriceStore&& other) noexcept;
+    PriceStore& operator=(PriceStore&& other) noexcept;
+    PriceStore(const PriceStore&) = delete;
+    PriceStore& operator=(const PriceStore&) = delete;
+
+    // Map an existing store file. Returns false (and sets `error` if given)
+    // when the file cannot be mapped or is not a valid store.
+    bool open(const std::string& path, std::string* error = nullptr);
+    void close();
+
+    bool is_open() const { return base_ != nullptr; }
+    std::size_t size() const { return num_rows_; }
+
+    ArrayView<const std::int64_t> timestamps() const { return int_column(Timestamp); }
+    ArrayView<const double> opens() const { return double_column(Open); }
+    ArrayView<const double> highs() const { return double_column(High); }
+    ArrayView<const double> lows() const { return double_column(Low); }
+    ArrayView<const double> closes() const { return double_column(Close); }
+    ArrayView<const double> adj_closes() const { return double_column(AdjClose); }
+    ArrayView<const std::int64_t> volumes() const { return int_column(Volume); }
+
+    // Write `data` as a store file. All columns must have equal length.
+    static bool write(const std::string& path,
+                      const PriceColumns& data,
+                      std::string* error = nullptr);
+
+    // Parse a price CSV (yfinance layout with its Ticker/Date rows, or a
+    // plain Date,Open,High,Low,Close,... header). Rows without a parsable
+    // date or Close are dropped and the rest sorted by date, as in
+    // load_close() in python/monitor_sharpe.py. Missing optional columns
+    // are filled with NaN (prices) or 0 (volume).
+    static bool read_csv(const std::string& csv_path,
+                         PriceColumns& out,
+                         std::string* error = nullptr);
+
+    // One-time conversion: read_csv followed by write.
+    static bool convert_csv(const std::string& csv_path,
+                            const std::string& store_path,
+                            std::string* error = nullptr);
+
+private:
+    const unsigned char* base_ = nullptr;
+    std::size_t mapped_size_ = 0;
+    std::size_t num_rows_ = 0;
+    std::uint64_t offsets_[NumColumns] = {};
+
+#ifdef _WIN32
+    void* file_handle_ = nullptr;
+    void* mapping_handle_ = nullptr;
+#endif
+
+    ArrayView<const double> double_column(Column c) const;
+    ArrayView<const std::int64_t> int_column(Column c) const;
+};
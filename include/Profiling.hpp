@@ -0,0 +1,92 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Hot-path instrumentation, compiled out by default. Configure with
+// -DBACKTEST_PROFILING=ON (or define BACKTEST_PROFILING=1) to record phase
+// timings, allocation and trade counts in BacktestResult::profile and
+// BatchResult::profile. When disabled every counter stays 0 and the timers
+// and counters below compile to nothing.
+#ifndef BACKTEST_PROFILING
+#define BACKTEST_PROFILING 0
+#endif
+
+constexpr bool kProfilingEnabled = BACKTEST_PROFILING != 0;
+
+// Per-run counters. Batch and sweep results hold the sum over all their
+// candidates (see merge()).
+struct BacktestStats {
+    std::uint64_t convert_ns = 0;       // input conversion in the Python bindings
+    std::uint64_t setup_ns = 0;         // output allocation and per-series precomputation
+    std::uint64_t loop_ns = 0;          // main simulation loop
+    std::uint64_t metrics_ns = 0;       // drawdown / Sharpe passes over stored curves
+    std::uint64_t bytes_allocated = 0;  // output and scratch buffers
+    std::uint64_t bars_processed = 0;
+    std::uint64_t trades = 0;           // bars on which the position changed
+    std::uint64_t runs = 0;             // backtests folded into this record
+
+    void merge(const BacktestStats& other)
+    {
+        convert_ns += other.convert_ns;
+        setup_ns += other.setup_ns;
+        loop_ns += other.loop_ns;
+        metrics_ns += other.metrics_ns;
+        bytes_allocated += other.bytes_allocated;
+        bars_processed += other.bars_processed;
+        trades += other.trades;
+        runs += other.runs;
+    }
+};
+
+// Monotonic clock in nanoseconds (0 when profiling is disabled).
+inline std::uint64_t profile_clock_ns()
+{
+    if constexpr (kProfilingEnabled) {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    } else {
+        return 0;
+    }
+}
+
+// Adds the nanoseconds between construction and stop() (or destruction)
+// to `slot`.
+template <bool Enabled = kProfilingEnabled>
+class PhaseTimer {
+public:
+    explicit PhaseTimer(std::uint64_t& slot) : slot_(slot), start_(profile_clock_ns()) {}
+    ~PhaseTimer() { stop(); }
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+    void stop()
+    {
+        if (running_) {
+            slot_ += profile_clock_ns() - start_;
+            running_ = false;
+        }
+    }
+
+private:
+    std::uint64_t& slot_;
+    std::uint64_t start_;
+    bool running_ = true;
+};
+
+template <>
+class PhaseTimer<false> {
+public:
+    explicit PhaseTimer(std::uint64_t&) {}
+    void stop() {}
+};
+
+// Heap bytes held by a vector's buffer.
+template <typename T>
+std::uint64_t vector_bytes(const std::vector<T>& v)
+{
+    return static_cast<std::uint64_t>(v.capacity() * sizeof(T));
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+#include "ArrayView.hpp"
+
+// Monotonic arena for batch and sweep result buffers.
+//
+// Allocations are carved from one preallocated slab by bumping an offset;
+// deallocation is a no-op and reset() releases everything at once. When a
+// batch outgrows the slab, the excess comes from `upstream` and the next
+// reset() replaces slab and overflow with a single slab large enough for
+// the whole batch, so a repeated sweep of the same shape reaches the heap
+// only on its first pass.
+//
+// The arena is a std::pmr::memory_resource, so the batch APIs accept any
+// caller-provided resource in its place. It is not thread-safe: allocate
+// up front, then let workers fill the buffers.
+class ResultArena : public std::pmr::memory_resource {
+public:
+    //  initial_bytes:   size of the first slab (0 = allocate on first use)
+    //  upstream:        where slabs and overflow blocks come from
+    explicit ResultArena(std::size_t initial_bytes = 0,
+                         std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+    ~ResultArena() override;
+
+    ResultArena(const ResultArena&) = delete;
+    ResultArena& operator=(const ResultArena&) = delete;
+
+    // Uninitialised storage for `count` values of T (64-byte aligned).
+    template <typename T>
+    ArrayView<T> allocate_array(std::size_t count)
+    {
+        void* p = allocate(count * sizeof(T), kAlignment);
+        return ArrayView<T>(static_cast<T*>(p), count);
+    }
+
+    // Invalidate every allocation and rewind to the start of the slab.
+    void reset();
+
+    // Make sure the slab holds at least `bytes` (only valid right after
+    // construction or reset()).
+    void reserve(std::size_t bytes);
+
+    std::size_t used() const { return used_; }          // bytes handed out since reset()
+    std::size_t capacity() const { return slab_size_; }  // slab size
+
+    static constexpr std::size_t kAlignment = 64;
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+private:
+    std::pmr::memory_resource* upstream_;
+
+    unsigned char* slab_ = nullptr;
+    std::size_t slab_size_ = 0;
+    std::size_t offset_ = 0;  // next free byte in the slab
+    std::size_t used_ = 0;    // including overflow blocks
+
+    // Blocks taken from upstream once the slab is full: {ptr, bytes, alignment}.
+    struct Block {
+        void* ptr;
+        std::size_t bytes;
+        std::size_t alignment;
+    };
+    std::vector<Block> overflow_;
+
+    void release_slab();
+    void release_overflow();
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+class BinaryReader;
+class BinaryWriter;
+
+// Population mean / variance of the last `window` values, O(1) per push.
+//
+// Values live in a ring buffer; sums of (x - shift) and of its square are
+// updated as values enter and leave, and rebuilt exactly from the buffer
+// every kRebuildEvery pushes so drift cannot accumulate (same scheme as
+// SignalGenerator). A window of identical values is detected exactly from
+// the trailing run length, as pandas does, since the sums alone can leave
+// rounding residue from values that have already left the window.
+struct RollingMoments {
+    static constexpr std::size_t kRebuildEvery = 1024;
+
+    std::size_t window = 1;
+    std::vector<double> buffer;   // last `window` values
+    std::size_t head = 0;         // slot the next value is written to
+    std::size_t count = 0;        // values seen, saturates at window
+    std::size_t since_rebuild = 0;
+    std::size_t same_run = 0;     // trailing pushes equal to the newest value
+
+    // Shifted running sums: sum(x - shift), sum((x - shift)^2).
+    double shift = 0.0;
+    double sum = 0.0;
+    double sum_sq = 0.0;
+
+    explicit RollingMoments(std::size_t window_len = 1);
+
+    void reset();
+    void push(double x);
+
+    bool full() const { return count == window; }
+
+    // scale * mean / std over a full window. NaN until the window is full
+    // and when the window is constant (std within rounding noise of zero).
+    double sharpe(double scale) const;
+
+    void write_state(BinaryWriter& out) const;
+    bool read_state(BinaryReader& in);
+
+private:
+    // Recompute shift, sum and sum_sq exactly from the buffer.
+    void rebuild();
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "ArrayView.hpp"
+
+// Rolling Sharpe ratios of one returns series for several windows.
+struct RollingSharpePanel {
+    std::size_t num_windows = 0;  // W
+    std::size_t num_steps = 0;    // T
+
+    std::vector<std::size_t> windows;  // size W, in request order
+
+    // W x T, row k = rolling Sharpe for windows[k]. NaN until the window is
+    // full and wherever the rolling std is zero.
+    std::vector<double> values;
+
+    // Last column of `values` (the latest snapshot), size W.
+    std::vector<double> latest;
+};
+
+// Compute every rolling Sharpe series in one sliding pass.
+//
+// Matches rolling_sharpe() in python/monitor_sharpe.py for each window:
+//   sqrt(annualization) * rolling_mean / rolling_std   (ddof = 0)
+// with +-inf mapped to NaN.
+//
+// One set of compensated prefix sums of the centred returns and their
+// squares is shared by all windows, so each window costs O(1) per bar and
+// the total work is O(T * W) regardless of the window lengths. The
+// compensation keeps each window sum accurate to rounding of the window
+// itself rather than of the whole-series prefix.
+//
+//  returns:         per-step returns (size T)
+//  windows:         rolling window lengths (each >= 1)
+//  annualization:   periods per year (252 for daily data)
+RollingSharpePanel compute_rolling_sharpe_panel(ArrayView<const double> returns,
+                                                const std::vector<std::size_t>& windows,
+                                                double annualization = 252.0);
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ArrayView.hpp"
+#include "SignalGenerator.hpp"
+
+// Rolling statistics shared by every configuration of a sweep over the
+// same price series.
+//
+// add_series() builds, once per series, compensated prefix sums of
+// (price - shift) and of its square, plus the run length of equal prices
+// ending at each bar. The sums restart every kBlockBars bars with the
+// block's first price as shift, so the shifted values stay small however
+// far the series drifts. The mean / population std of any window ending at
+// any bar is then a difference of at most two prefixes (one more per
+// kBlockBars of window length). zscores() materialises the rolling z-score
+// series of one (series, window) key on first use and keeps it, so all the
+// z_entry / z_exit settings on that window only replay the entry/exit
+// hysteresis over it.
+//
+// The z-scores agree with SignalGenerator up to rounding (the sums are
+// formed differently), so a bar whose |z| sits within rounding of a
+// threshold may signal differently. Windows of identical prices, and
+// windows whose variance is within rounding noise of zero, give NaN
+// (flat), as in RollingMoments.
+//
+// Thread-safe: any number of threads may query and fill the cache at once.
+// Views returned by zscores() stay valid until the series is replaced or
+// erased, or the cache is cleared.
+class RollingStatsCache {
+public:
+    static constexpr std::size_t kBlockBars = 1024;
+
+    // Register series `id`, replacing any series of that name along with
+    // its cached z-scores. The prices are copied.
+    void add_series(const std::string& id, ArrayView<const double> prices);
+
+    bool has_series(const std::string& id) const;
+    void erase(const std::string& id);
+    void clear();
+
+    // Bars in series `id` (0 if unknown).
+    std::size_t series_size(const std::string& id) const;
+
+    // Mean / population std of prices [i + 1 - window, i] of series `id`.
+    // NaN before the window is full, for an unknown id or i out of range;
+    // stddev is also NaN for a window of zero variance.
+    double mean(const std::string& id, std::size_t window, std::size_t i) const;
+    double stddev(const std::string& id, std::size_t window, std::size_t i) const;
+
+    // The same for every bar of the series at once (empty if unknown).
+    std::vector<double> rolling_mean(const std::string& id, std::size_t window) const;
+    std::vector<double> rolling_std(const std::string& id, std::size_t window) const;
+
+    // Rolling z-score of every bar, computed on first request and cached.
+    // Empty for an unknown id or window == 0.
+    ArrayView<const double> zscores(const std::string& id, std::size_t window);
+
+    // Positions of SignalGenerator(params) over the whole series, from the
+    // cached z-scores. Returns false (leaving `out` untouched) for an unknown
+    // id, window == 0 or out.size() != series_size(id).
+    bool signals_into(const std::string& id, const SignalParams& params, ArrayView<int> out);
+
+    // Row-major N x T signal matrix of `grid` (row k = signals of grid[k]),
+    // ready for BacktestEngine::run_batch / SweepExecutor::run. Empty if the
+    // id is unknown or a window is 0.
+    std::vector<int> signal_matrix(const std::string& id, const std::vector<SignalParams>& grid);
+
+    // Number of cached (series, window) z-score series.
+    std::size_t cached_windows() const;
+
+private:
+    struct Series {
+        std::vector<double> prices;
+        std::vector<double> block_shift;  // first price of each block
+
+        // Neumaier-compensated sums of (price - block shift) and its square
+        // from the start of bar i's block through bar i; the true sum is
+        // hi + lo.
+        std::vector<double> sum_hi, sum_lo;
+        std::vector<double> sum_sq_hi, sum_sq_lo;
+        std::vector<std::size_t> same_run;  // equal prices ending at bar i
+
+        std::map<std::size_t, std::vector<double>> zscores;  // by window, guarded by mutex_
+    };
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<Series>> series_;
+
+    std::shared_ptr<Series> find(const std::string& id) const;
+
+    // Sums of (price - shift) and its square over bars [i + 1 - window, i]
+    // of `s`, with `shift` the shift of bar i's block; the caller checks
+    // the range.
+    static void window_sums(const Series& s, std::size_t window, std::size_t i,
+                            double& shift, double& sum, double& sum_sq);
+    static double window_mean(const Series& s, std::size_t window, std::size_t i);
+    static double window_std(const Series& s, std::size_t window, std::size_t i);
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cmath>        // std::sqrt
+#include <cstddef>
+
+// Single-pass accumulator for the engine statistics.
+//
+// Tracks the running equity peak / max drawdown and a Welford mean and
+// variance of per-step PnL, so a backtest can report max_drawdown and
+// sharpe_ratio without storing the equity or PnL curves.
+struct RunningMetrics {
+    double peak = 0.0;          // running equity peak
+    double max_drawdown = 0.0;  // max (peak - equity) / peak seen so far
+
+    std::size_t count = 0;      // PnL observations
+    double mean = 0.0;          // running PnL mean
+    double m2 = 0.0;            // sum of squared deviations from the mean
+
+    // Start a new run at the given initial equity.
+    void reset(double initial_equity)
+    {
+        peak = initial_equity;
+        max_drawdown = 0.0;
+        count = 0;
+        mean = 0.0;
+        m2 = 0.0;
+    }
+
+    void add_equity(double equity)
+    {
+        if (equity > peak) {
+            peak = equity;
+        }
+        double dd = (peak - equity) / peak;
+        if (dd > max_drawdown) {
+            max_drawdown = dd;
+        }
+    }
+
+    void add_pnl(double x)
+    {
+        ++count;
+        double delta = x - mean;
+        mean += delta / static_cast<double>(count);
+        m2 += delta * (x - mean);
+    }
+
+    // Merge a block of PnL observations given its count, mean and sum of
+    // squared deviations (Chan et al. parallel update).
+    void add_pnl_block(std::size_t block_count, double block_mean, double block_m2)
+    {
+        if (block_count == 0) {
+            return;
+        }
+        double na = static_cast<double>(count);
+        double nb = static_cast<double>(block_count);
+        double total = na + nb;
+        double delta = block_mean - mean;
+        mean += delta * (nb / total);
+        m2 += block_m2 + delta * delta * (na * nb / total);
+        count += block_count;
+    }
+
+    // Population variance of the PnL observations.
+    double variance() const
+    {
+        return count == 0 ? 0.0 : m2 / static_cast<double>(count);
+    }
+
+    // Annualised Sharpe ratio, same conventions as BacktestEngine: zero for
+    // fewer than two observations, non-positive dt or zero volatility.
+    double sharpe(double dt_in_years) const
+    {
+        if (count <= 1 || dt_in_years <= 0.0) {
+            return 0.0;
+        }
+        double std_dev = std::sqrt(variance());
+        if (std_dev == 0.0) {
+            return 0.0;
+        }
+        return mean / std_dev * std::sqrt(1.0 / dt_in_years);
+    }
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cmath>        // std::isnan, std::fabs
+#include <cstddef>
+#include <vector>
+
+#include "ArrayView.hpp"
+
+class BinaryReader;
+class BinaryWriter;
+
+// One point of a parameter grid (SignalGenerator settings).
+struct SignalParams {
+    std::size_t window = 20;
+    double z_entry = 2.0;
+    double z_exit = 0.5;
+};
+
+// Entry/exit hysteresis of the z-score signal: the position after a bar
+// with z-score `z`, given the position before it (rules below).
+inline int zscore_position_step(double z, int position, double z_entry, double z_exit)
+{
+    if (std::isnan(z) || std::fabs(z) < z_exit) {
+        return 0;
+    }
+    if (position == 0) {
+        if (z > z_entry) {
+            return -1;
+        }
+        if (z < -z_entry) {
+            return 1;
+        }
+    }
+    return position;
+}
+
+// Rolling z-score mean-reversion signal with entry/exit hysteresis.
+//
+// Matches zscore_position() in python/monitor_sharpe.py:
+//   z = (price - rolling_mean) / rolling_std      (population std, ddof = 0)
+//   - z undefined (warm-up, zero std)   -> flat
+//   - |z| < z_exit                      -> flat
+//   - flat and z > +z_entry             -> short (-1)
+//   - flat and z < -z_entry             -> long  (+1)
+//   - otherwise                         -> hold current position
+//
+// The rolling moments are O(1) per bar: sums of (price - shift) and of its
+// square are updated as prices enter and leave a ring buffer. The shift and
+// both sums are rebuilt from the buffer every `recompute_every` bars so that
+// floating-point drift cannot accumulate over long series.
+class SignalGenerator {
+public:
+    //  window:           rolling lookback in bars (>= 1)
+    //  z_entry:          |z| threshold to open a position
+    //  z_exit:           |z| threshold below which the position is closed
+    //  recompute_every:  bars between exact rebuilds of the sums (0 = 1024)
+    explicit SignalGenerator(std::size_t window,
+                             double z_entry = 2.0,
+                             double z_exit = 0.5,
+                             std::size_t recompute_every = 0);
+
+    // Clear all state; the next bar starts a new warm-up.
+    void reset();
+
+    // Push the next price and return the position (-1, 0, +1) for this bar.
+    int update(double price);
+
+    // Z-score of the most recent bar (NaN during warm-up or for zero std).
+    double last_zscore() const { return last_z_; }
+
+    // Current position (-1, 0, +1).
+    int position() const { return position_; }
+
+    // Reset, then generate signals for a whole series (size N).
+    std::vector<int> generate(ArrayView<const double> prices);
+    void generate_into(ArrayView<const double> prices, ArrayView<int> out);
+
+    // Reset, then compute the rolling z-score for a whole series (size N).
+    std::vector<double> zscores(ArrayView<const double> prices);
+
+    std::size_t window() const { return window_; }
+    double z_entry() const { return z_entry_; }
+    double z_exit() const { return z_exit_; }
+
+    // Binary encoding of the full state (configuration, ring buffer and
+    // sums), so a restored generator continues bit-identically. read_state
+    // returns false on malformed input and leaves the generator unchanged.
+    void write_state(BinaryWriter& out) const;
+    bool read_state(BinaryReader& in);
+
+private:
+    std::size_t window_;
+    double z_entry_;
+    double z_exit_;
+    std::size_t recompute_every_;
+
+    // Ring buffer holding the last `window_` prices.
+    std::vector<double> buffer_;
+    std::size_t head_ = 0;        // slot the next price is written to
+    std::size_t count_ = 0;       // prices seen, saturates at window_
+    std::size_t since_rebuild_ = 0;
+
+    // Shifted running sums: sum(p - shift_), sum((p - shift_)^2).
+    double shift_ = 0.0;
+    double sum_ = 0.0;
+    double sum_sq_ = 0.0;
+
+    double last_z_;
+    int position_ = 0;
+
+    // Recompute shift_, sum_ and sum_sq_ exactly from the buffer.
+    void rebuild_sums();
+};
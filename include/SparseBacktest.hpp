@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "ArrayView.hpp"
+#include "Profiling.hpp"
+
+// A signal given as a change: from bar `bar` on, the desired position is
+// `position` (-1, 0 or +1), until the next change. Equivalent to the dense
+// signal vector with signals[i] = position of the last change at or
+// before bar i (0 before the first change); as in the engine, bar 0 is
+// always flat, so a change at bar 0 acts from bar 1.
+struct PositionChange {
+    std::size_t bar = 0;
+    int position = 0;
+};
+
+// One round trip of the trade ledger: `position` held over bars
+// [entry_bar, exit_bar). Under the engine convention the position takes
+// the move from the previous close, so the PnL runs between
+// entry_price = prices[entry_bar - 1] and exit_price = prices[exit_bar - 1],
+// while the costs are charged at the close of the bar the position changes
+// on (prices[entry_bar] and prices[exit_bar]). A flip closes one trade and
+// opens the next on the same bar.
+struct TradeRecord {
+    std::size_t entry_bar = 0;
+    std::size_t exit_bar = 0;     // one past the last bar held; size() if still open
+    int position = 0;
+    double entry_price = 0.0;
+    double exit_price = 0.0;
+    double cost = 0.0;            // entry cost plus exit cost (0 while open)
+    double pnl = 0.0;             // position * (exit - entry) - cost
+    bool closed = false;          // false for a trade still open on the last bar
+};
+
+// Result of BacktestEngine::run_sparse: the statistics of the equivalent
+// dense run and the trade ledger. No per-bar curves.
+struct SparseBacktestResult {
+    std::vector<TradeRecord> trades;
+    double total_return = 0.0;
+    double max_drawdown = 0.0;
+    double sharpe_ratio = 0.0;
+
+    // Phase timings and counters (all 0 unless built with BACKTEST_PROFILING).
+    BacktestStats profile;
+};
+
+// Per-series summaries that let run_sparse evaluate a holding interval
+// without visiting its bars:
+//   - compensated prefix sums of the squared price moves, for the PnL
+//     variance of any interval (the sum of the moves telescopes to a
+//     price difference);
+//   - a binary tree of price maxima / minima over blocks of kBlockBars
+//     bars, which bounds the drawdown a block range can reach, so only
+//     blocks that may set a new maximum drawdown are scanned.
+//
+// Built in one pass over the prices and shared by every change list run
+// against the same series. Keeps a view of `prices`, which must outlive
+// the index.
+class PriceRangeIndex {
+public:
+    static constexpr std::size_t kBlockBars = 64;
+
+    PriceRangeIndex() = default;
+    explicit PriceRangeIndex(ArrayView<const double> prices);
+
+    std::size_t size() const { return prices_.size(); }
+    ArrayView<const double> prices() const { return prices_; }
+
+    // Sum of (prices[i] - prices[i - 1])^2 over bars [begin, end), 1 <= begin.
+    double sum_sq_moves(std::size_t begin, std::size_t end) const;
+
+    // Fold the equity curve base + position * (prices[i] - reference) over
+    // bars [begin, end) into a running (peak, max_drawdown), as
+    // RunningMetrics::add_equity does bar by bar. Whole blocks whose
+    // equity range cannot produce a drawdown above max_drawdown only move
+    // the peak, so the cost is O(log(size)) plus the bars of the blocks
+    // that may set a new maximum and of the two partial end blocks.
+    void fold_drawdown(std::size_t begin, std::size_t end,
+                       double base, int position, double reference,
+                       double& peak, double& max_drawdown) const;
+
+private:
+    ArrayView<const double> prices_;
+    std::vector<double> sum_sq_hi_, sum_sq_lo_;   // moves of bars [1, i], hi + lo
+
+    // Implicit binary tree over the blocks, leaves_ a power of two; node 1
+    // is the root, node k has children 2k and 2k + 1, and padding leaves
+    // hold -inf / +inf.
+    std::vector<double> node_max_, node_min_;
+    std::size_t leaves_ = 0;
+
+    struct Fold {
+        double base;
+        int position;
+        double reference;
+        double& peak;
+        double& max_drawdown;
+    };
+
+    void fold_bars(std::size_t begin, std::size_t end, Fold& f) const;
+    void fold_blocks(std::size_t node, std::size_t node_begin, std::size_t node_end,
+                     std::size_t begin, std::size_t end, Fold& f) const;
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ArrayView.hpp"
+#include "RollingMoments.hpp"
+#include "SignalGenerator.hpp"
+#include "StreamingBacktest.hpp"
+
+class BinaryReader;
+class BinaryWriter;
+
+// Incremental state of the daily monitoring job (python/monitor_sharpe.py).
+//
+// For every signal window it keeps:
+//   - a SignalGenerator (z-score accumulators and hysteresis position)
+//   - a StreamingBacktest of the engine PnL and equity
+//   - one RollingMoments per Sharpe window over the monitor's returns
+//       r[t] = pos[t-1] * (p[t] / p[t-1] - 1) - cost_bps / 1e4 * |pos[t] - pos[t-1]|
+//     as in backtest_returns(), giving rolling_sharpe() without history.
+//
+// The whole state round-trips through a snapshot file (by convention under
+// data/derived), so after a restart the monitor resumes from the last bar
+// instead of replaying history, with bit-identical results.
+class StrategyMonitor {
+public:
+    //  signal_windows:   z-score lookbacks, one strategy each
+    //  sharpe_windows:   rolling Sharpe windows tracked per strategy
+    //  z_entry, z_exit:  SignalGenerator thresholds
+    //  cost_bps:         cost per unit turnover in basis points; the engine
+    //                    backtests use cost_bps / 1e4 of traded notional
+    //  initial_capital:  starting equity of each engine backtest
+    //  annualization:    periods per year for the rolling Sharpe
+    StrategyMonitor(const std::vector<std::size_t>& signal_windows,
+                    const std::vector<std::size_t>& sharpe_windows,
+                    double z_entry = 2.0,
+                    double z_exit = 0.5,
+                    double cost_bps = 1.0,
+                    double initial_capital = 100000.0,
+                    double annualization = 252.0);
+
+    // Clear all state; the next bar starts a new warm-up.
+    void reset();
+
+    // Push one bar to every strategy.
+    void on_bar(std::int64_t timestamp, double price);
+
+    // Push the bars newer than last_timestamp(), e.g. a whole PriceStore
+    // column after a restart. Returns the number of bars applied.
+    std::size_t update(ArrayView<const std::int64_t> timestamps,
+                       ArrayView<const double> prices);
+
+    std::size_t bars() const { return bars_; }
+    std::int64_t last_timestamp() const { return last_timestamp_; }
+
+    std::size_t num_strategies() const { return strategies_.size(); }
+    const std::vector<std::size_t>& signal_windows() const { return signal_windows_; }
+    const std::vector<std::size_t>& sharpe_windows() const { return sharpe_windows_; }
+
+    const SignalGenerator& generator(std::size_t k) const { return strategies_[k].generator; }
+    const StreamingBacktest& backtest(std::size_t k) const { return strategies_[k].backtest; }
+
+    // Monitor return of strategy k on the latest bar.
+    double last_return(std::size_t k) const { return strategies_[k].last_return; }
+
+    // Latest rolling Sharpe of the monitor returns, row-major
+    // (num_strategies x sharpe_windows().size()); NaN where undefined.
+    std::vector<double> sharpe_snapshot() const;
+
+    // Write the full state to `path` (via a temporary file and rename, so
+    // a crash mid-write keeps the previous snapshot) / restore it. Return
+    // false and set `error` if given; a failed load changes nothing.
+    bool save_snapshot(const std::string& path, std::string* error = nullptr) const;
+    bool load_snapshot(const std::string& path, std::string* error = nullptr);
+
+    // Raw field encoding used by the snapshot file.
+    void write_state(BinaryWriter& out) const;
+    bool read_state(BinaryReader& in);
+
+private:
+    struct Strategy {
+        SignalGenerator generator;
+        StreamingBacktest backtest;
+        std::vector<RollingMoments> return_windows;  // one per sharpe window
+        double last_return = 0.0;
+    };
+
+    std::vector<std::size_t> signal_windows_;
+    std::vector<std::size_t> sharpe_windows_;
+    double cost_bps_;
+    double annualization_;
+
+    std::size_t bars_ = 0;
+    std::int64_t last_timestamp_ = 0;
+    double last_price_ = 0.0;
+
+    std::vector<Strategy> strategies_;
+};
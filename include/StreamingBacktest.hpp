@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "ArrayView.hpp"
+#include "RollingMoments.hpp"
+#include "RunningMetrics.hpp"
+
+class BinaryReader;
+class BinaryWriter;
+
+// Outcome of one streamed bar.
+struct StreamingBar {
+    double pnl = 0.0;     // PnL of this bar after transaction costs
+    double equity = 0.0;  // equity after this bar
+    int position = 0;     // position held over this bar
+};
+
+// Stateful, bar-by-bar version of BacktestEngine.
+//
+// Keeps only the running state (position, equity, last price, drawdown and
+// Welford PnL moments, plus one RollingMoments per rolling Sharpe window), so
+// each on_bar() call is O(1) in the history length. Feeding a whole series
+// through on_bar() gives the same equity, total_return and max_drawdown as
+// BacktestEngine::run_backtest, and the same sharpe_ratio as run_metrics.
+//
+// The state can be serialised and restored, so a daily job only has to push
+// the bars that arrived since the previous run.
+class StreamingBacktest {
+public:
+    //  initial_capital:       starting equity
+    //  transaction_cost_pct:  cost as a fraction of traded notional
+    //  dt_in_years:           bar length in years, for Sharpe annualisation
+    //  sharpe_windows:        rolling PnL Sharpe windows to track (each >= 1)
+    StreamingBacktest(double initial_capital,
+                      double transaction_cost_pct,
+                      double dt_in_years = 1.0 / 252.0,
+                      const std::vector<std::size_t>& sharpe_windows = {});
+
+    // Clear all state; the next bar starts a new run.
+    void reset();
+
+    // Push the next bar. As in the engine, the desired position takes effect
+    // on the bar it is given for and the first bar is always flat.
+    //  price:   price of this bar
+    //  signal:  desired position (-1, 0, +1)
+    StreamingBar on_bar(double price, int signal);
+
+    // Push a block of bars: on_bar(prices[i], signals[i]) for every i,
+    // without the per-bar results. signals must have the size of prices.
+    void on_bars(ArrayView<const double> prices, ArrayView<const int> signals);
+
+    std::size_t bars() const { return bars_; }
+    int position() const { return position_; }
+    double equity() const { return equity_; }
+    double last_price() const { return last_price_; }
+
+    // Running statistics over every bar pushed so far.
+    double total_return() const;
+    double max_drawdown() const { return metrics_.max_drawdown; }
+    double sharpe_ratio() const { return metrics_.sharpe(dt_in_years_); }
+
+    // Annualised Sharpe of the PnL over the last sharpe_windows()[k] bars.
+    // NaN until the window is full and when its PnL is constant.
+    double rolling_sharpe(std::size_t k) const;
+    std::vector<double> rolling_sharpes() const;
+    std::vector<std::size_t> sharpe_windows() const;
+
+    double initial_capital() const { return initial_capital_; }
+    double transaction_cost_pct() const { return transaction_cost_pct_; }
+    double dt_in_years() const { return dt_in_years_; }
+
+    // Compact binary state, including the configuration. deserialize()
+    // returns false (and sets `error` if given) on malformed input and
+    // leaves the object unchanged.
+    std::string serialize() const;
+    bool deserialize(const std::string& bytes, std::string* error = nullptr);
+
+    // Raw field encoding used by serialize(), for embedding in larger files.
+    void write_state(BinaryWriter& out) const;
+    bool read_state(BinaryReader& in);
+
+private:
+    double initial_capital_;
+    double transaction_cost_pct_;
+    double dt_in_years_;
+
+    std::size_t bars_ = 0;
+    int position_ = 0;
+    double equity_;
+    double last_price_ = 0.0;
+    RunningMetrics metrics_;
+
+    std::vector<RollingMoments> windows_;  // one per rolling Sharpe window
+};
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ArrayView.hpp"
+#include "BacktestEngine.hpp"
+#include "ThreadPool.hpp"
+
+// Called on a worker thread once rows [begin, end) of an asynchronous sweep
+// have finished, with the number of rows finished so far. Chunks finish
+// concurrently, so calls may overlap.
+using SweepProgressFn = std::function<void(std::size_t begin, std::size_t end, std::size_t completed)>;
+
+// Handle of a sweep started with SweepExecutor::submit, shared by the caller
+// and the pool tasks running it.
+//
+// Rows run in the same fixed chunks as SweepExecutor::run, so the final
+// statistics are bit-identical to it. Each finished chunk is published:
+// take_finished() reports its rows, which may then be read from result()
+// while the rest of the sweep is still running. cancel() skips every chunk
+// that has not started yet, and the job ends as Cancelled with the rows
+// finished so far; an exception from a chunk or from the progress callback
+// cancels the rest and ends it as Failed.
+class SweepJob {
+public:
+    enum class State { Running, Done, Cancelled, Failed };
+
+    std::size_t num_candidates() const { return result_.num_candidates; }
+    std::size_t completed() const;  // rows finished so far
+
+    State state() const;
+    bool finished() const { return state() != State::Running; }
+    std::string error() const;  // what() of the exception that failed the job
+
+    // Skip the chunks that have not started. Returns false if the job had
+    // already finished.
+    bool cancel();
+
+    // Block until the job has finished, or for at most `seconds`; wait_for
+    // returns finished().
+    void wait() const;
+    bool wait_for(double seconds) const;
+
+    // Row ranges [begin, end) finished since the previous call, in
+    // completion order.
+    std::vector<std::pair<std::size_t, std::size_t>> take_finished();
+
+    // Every row once finished (rows skipped by a cancel stay 0); before
+    // that, only rows already returned by take_finished().
+    const BatchResult& result() const { return result_; }
+
+private:
+    friend class SweepExecutor;
+
+    SweepJob() = default;
+
+    // Evaluate rows [begin, end) unless cancelled, then publish them.
+    void run_chunk(const BacktestEngine& engine, std::size_t begin, std::size_t end);
+
+    std::vector<int> signal_matrix_;  // owned copy, N x T
+    PriceMoves moves_;
+    double dt_in_years_ = 0.0;
+    SweepProgressFn on_progress_;
+    BatchResult result_;
+    std::atomic<bool> cancel_{false};
+
+    mutable std::mutex mutex_;
+    mutable std::condition_variable done_cv_;
+    State state_ = State::Running;
+    std::size_t remaining_chunks_ = 0;
+    std::size_t completed_ = 0;
+    std::vector<std::pair<std::size_t, std::size_t>> finished_;
+    std::string error_;
+};
+
+// Runs the candidates of a batch sweep in parallel on a work-stealing pool.
+//
+// Candidates are split into fixed chunks and every candidate writes only its
+// own slot of the BatchResult, using the same sequential arithmetic as
+// BacktestEngine::run_batch. Results are therefore bit-identical for any
+// number of threads.
+class SweepExecutor {
+public:
+    //  engine:          engine whose cost/capital settings every candidate uses
+    //  num_threads:     worker threads (0 = hardware concurrency)
+    explicit SweepExecutor(const BacktestEngine& engine, std::size_t num_threads = 0);
+
+    std::size_t num_threads() const { return pool_->size(); }
+
+    // Parallel equivalent of BacktestEngine::run_batch.
+    //
+    //  prices:          close or mid prices for each time step (size T)
+    //  signal_matrix:   row-major N x T block, row k = signals of candidate k
+    //  dt_in_years:     time step in years (e.g. 1.0/252 for daily data)
+    BatchResult run(ArrayView<const double> prices,
+                    ArrayView<const int> signal_matrix,
+                    double dt_in_years) const;
+
+    // Parallel equivalent of the memory-resource overload of
+    // BacktestEngine::run_batch. Every curve block is taken from
+    // `curve_memory` before the parallel pass, so the workers never allocate;
+    // pass a ResultArena and reset it between batches.
+    BatchResult run(ArrayView<const double> prices,
+                    ArrayView<const int> signal_matrix,
+                    double dt_in_years,
+                    std::pmr::memory_resource& curve_memory,
+                    OutputMask outputs = OutputMask::Curves) const;
+
+    // Asynchronous run(): queue the sweep on the pool and return at once.
+    // The signal matrix is copied (or moved in), so the caller's buffers
+    // may go away; invalid input gives a job that is already Done with an
+    // empty result. Destroying the executor first runs, or skips if
+    // cancelled, every chunk still queued.
+    //
+    //  on_progress:     called after each finished chunk (may be empty)
+    std::shared_ptr<SweepJob> submit(ArrayView<const double> prices,
+                                     ArrayView<const int> signal_matrix,
+                                     double dt_in_years,
+                                     SweepProgressFn on_progress = nullptr) const;
+    std::shared_ptr<SweepJob> submit(ArrayView<const double> prices,
+                                     std::vector<int>&& signal_matrix,
+                                     double dt_in_years,
+                                     SweepProgressFn on_progress = nullptr) const;
+
+    ThreadPool& pool() const { return *pool_; }
+
+private:
+    BacktestEngine engine_;
+    std::unique_ptr<ThreadPool> pool_;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size work-stealing thread pool.
+//
+// Every worker owns a task deque: it pops its own work from the back and,
+// when empty, steals from the front of the other workers' deques. Threads
+// that wait on a parallel_for keep executing queued tasks, so nested calls
+// from inside a task cannot deadlock the pool.
+class ThreadPool {
+public:
+    // num_threads = 0 uses std::thread::hardware_concurrency().
+    explicit ThreadPool(std::size_t num_threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t size() const { return workers_.size(); }
+
+    // Queue a task. From a worker thread it goes onto that worker's own
+    // deque, otherwise onto the deques in round-robin order.
+    void submit(std::function<void()> task);
+
+    // Run fn(begin, end) over [0, count) split into chunks of at most
+    // `grain` indices and block until every chunk has finished. Chunk
+    // boundaries depend only on count and grain, never on scheduling.
+    // The first exception thrown by a chunk is rethrown here.
+    void parallel_for(std::size_t count,
+                      std::size_t grain,
+                      const std::function<void(std::size_t, std::size_t)>& fn);
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool try_pop(std::size_t self, std::function<void()>& task);
+    bool try_steal(std::size_t thief, std::function<void()>& task);
+    bool try_acquire(std::function<void()>& task);
+    void worker_loop(std::size_t index);
+
+    std::vector<std::unique_ptr<Worker>> queues_;
+    std::vector<std::thread> workers_;
+
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+    std::atomic<std::size_t> pending_{0};
+    std::atomic<std::size_t> next_queue_{0};
+    bool stopping_ = false;
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "ArrayView.hpp"
+#include "BacktestEngine.hpp"
+#include "SignalGenerator.hpp"
+#include "ThreadPool.hpp"
+
+// One train/test split, as bar ranges [begin, end) of the price series.
+struct FoldSplit {
+    std::size_t train_begin = 0;
+    std::size_t train_end = 0;
+    std::size_t test_begin = 0;
+    std::size_t test_end = 0;
+};
+
+// Outcome of one fold: the best in-sample config and its test statistics.
+struct WalkForwardFold {
+    FoldSplit split;
+    std::size_t best_config = 0;     // index into the parameter grid
+    double in_sample_sharpe = 0.0;   // Sharpe of best_config on the train range
+
+    // Exact BacktestEngine statistics of best_config on the test range.
+    double test_total_return = 0.0;
+    double test_max_drawdown = 0.0;
+    double test_sharpe = 0.0;
+};
+
+struct WalkForwardResult {
+    std::size_t num_folds = 0;    // F
+    std::size_t num_configs = 0;  // C
+
+    std::vector<WalkForwardFold> folds;  // size F
+
+    // F x C Sharpe of every config on every train / test range, for
+    // overfitting analysis (in-sample rank vs out-of-sample performance).
+    std::vector<double> in_sample_sharpe;
+    std::vector<double> out_of_sample_sharpe;
+};
+
+// Rolling (or anchored, i.e. expanding) splits over `num_steps` bars:
+// fold k trains on [k * step, k * step + train_bars) (or [0, ...) when
+// anchored) and tests on the following `test_bars` bars. step_bars = 0
+// steps by test_bars, so the test ranges tile the history.
+std::vector<FoldSplit> make_walk_forward_splits(std::size_t num_steps,
+                                                std::size_t train_bars,
+                                                std::size_t test_bars,
+                                                std::size_t step_bars = 0,
+                                                bool anchored = false);
+
+// Cartesian product of the given SignalGenerator settings (window slowest).
+std::vector<SignalParams> make_param_grid(const std::vector<std::size_t>& windows,
+                                          const std::vector<double>& z_entries,
+                                          const std::vector<double>& z_exits);
+
+// Walk-forward optimisation of the z-score strategy over BacktestEngine.
+//
+// Each grid config's signals are generated once over the whole history
+// (the generator is causal, so a bar's signal never sees later prices),
+// from rolling z-scores a RollingStatsCache computes once per distinct
+// window, and folded into prefix sums of its per-bar PnL and squared PnL. The Sharpe of
+// any train or test range is then O(1), with the first bar of the range
+// adjusted for the engine starting flat, so overlapping folds share all
+// rolling and cumulative work and the total cost is O(C * (T + F)).
+//
+// The best in-sample config of each fold (highest Sharpe, lowest index on
+// ties) is then re-run exactly with BacktestEngine on the test range.
+// Grid points and folds are spread over a work-stealing pool; results do
+// not depend on the number of threads.
+class WalkForwardOptimizer {
+public:
+    //  engine:          engine whose cost/capital settings every run uses
+    //  num_threads:     worker threads (0 = hardware concurrency)
+    explicit WalkForwardOptimizer(const BacktestEngine& engine, std::size_t num_threads = 0);
+
+    std::size_t num_threads() const { return pool_->size(); }
+
+    //  prices:          close or mid prices for each time step (size T)
+    //  splits:          train/test schedule (see make_walk_forward_splits)
+    //  grid:            candidate SignalGenerator settings
+    //  dt_in_years:     time step in years (e.g. 1.0/252 for daily data)
+    //
+    // Returns an empty result if any split is out of range, has fewer than
+    // two train or test bars, or tests before the end of its training range.
+    WalkForwardResult run(ArrayView<const double> prices,
+                          const std::vector<FoldSplit>& splits,
+                          const std::vector<SignalParams>& grid,
+                          double dt_in_years) const;
+
+    ThreadPool& pool() const { return *pool_; }
+
+private:
+    BacktestEngine engine_;
+    std::unique_ptr<ThreadPool> pool_;
+};
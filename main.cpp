@@ -1,61 +1,475 @@
-#include <iostream>
+// Native batch runner: z-score mean-reversion backtest over many price files.
+//
+//   backtest_cli [options] FILE... [--list PATHS_FILE]
+//
+// Each file is a price CSV (yfinance layout or a plain Date,...,Close
+// header; see CsvPriceReader) or, for any other extension, a PriceStore
+// file. CSVs are parsed in chunks by a producer thread while the job
+// thread runs signal generation and the backtest on the previous chunk;
+// --jobs files are processed concurrently. One summary row per file is
+// written in input order.
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <vector>
-#include "BacktestEngine.hpp"
-
-int main()
-{
-    // =========================
-    // 1️⃣ 准备测试价格数据（示例）
-    // =========================
-    std::vector<double> prices = {
-        100, 101, 102, 101, 100,
-        99, 98, 99, 100, 102,
-        101, 100, 99, 98, 97,
-        98, 99, 100, 101, 103};
-
-    // =========================
-    // 2️⃣ 准备交易信号（-1, 0, +1）
-    //    简单示例：低位做多，高位做空
-    // =========================
-    std::vector<int> signals = {
-        0, 0, -1, 0, 0,
-        1, 1, 0, 0, -1,
-        0, 0, 1, 1, 0,
-        0, 0, 0, 0, -1};
-
-    // =========================
-    // 3️⃣ 创建回测引擎
-    // =========================
-    double initial_capital = 100000.0; // 初始资金 10 万
-    double transaction_cost = 0.001;   // 单边 0.1% 手续费
-    double risk_free_rate = 0.0;       // 无风险利率
-
-    BacktestEngine engine(
-        initial_capital,
-        transaction_cost,
-        risk_free_rate);
-
-    // =========================
-    // 4️⃣ 运行回测（假设是日频）
-    // =========================
-    double dt = 1.0 / 252.0; // 每一步 = 1 个交易日
-
-    BacktestResult result = engine.run_backtest(
-        prices,
-        signals,
-        dt);
-
-    // =========================
-    // 5️⃣ 输出结果
-    // =========================
-    std::cout << "======== Backtest Result ========" << std::endl;
-    std::cout << "Total Return: " << result.total_return * 100.0 << " %" << std::endl;
-    std::cout << "Max Drawdown: " << result.max_drawdown * 100.0 << " %" << std::endl;
-    std::cout << "Sharpe Ratio: " << result.sharpe_ratio << std::endl;
-
-    std::cout << "\nFinal Equity: "
-              << result.equity_curve.back()
-              << std::endl;
 
+#include "CsvPriceReader.hpp"
+#include "PriceStore.hpp"
+#include "SignalGenerator.hpp"
+#include "StreamingBacktest.hpp"
+
+namespace {
+
+// =========================
+// Options
+// =========================
+struct Options {
+    std::size_t window = 20;
+    double z_entry = 2.0;
+    double z_exit = 0.5;
+    double initial_capital = 100000.0;
+    double transaction_cost_pct = 0.001;
+    double periods_per_year = 252.0;
+    bool adj_close = false;
+    std::size_t jobs = 0;
+    std::size_t chunk_rows = 65536;
+    std::string output;  // empty = stdout
+    std::vector<std::string> files;
+};
+
+void print_usage(std::FILE* out)
+{
+    std::fprintf(out,
+        "usage: backtest_cli [options] FILE... [--list PATHS_FILE]\n"
+        "\n"
+        "Backtests the z-score mean-reversion signal on every price file and\n"
+        "writes one CSV summary row per file. *.csv files are parsed as price\n"
+        "CSVs (yfinance layout or a plain Date,...,Close header); any other\n"
+        "file is opened as a PriceStore file.\n"
+        "\n"
+        "options:\n"
+        "  --window N             z-score lookback in bars (20)\n"
+        "  --z-entry X            entry threshold (2.0)\n"
+        "  --z-exit X             exit threshold (0.5)\n"
+        "  --capital X            initial capital (100000)\n"
+        "  --cost X               proportional transaction cost (0.001)\n"
+        "  --periods-per-year N   bars per year for the Sharpe ratio (252)\n"
+        "  --price close|adj_close  price column (close)\n"
+        "  --jobs N               files processed concurrently (0 = all cores)\n"
+        "  --chunk-rows N         CSV rows parsed per pipeline chunk (65536)\n"
+        "  --list FILE            read further input paths from FILE, one per line\n"
+        "  -o, --output FILE      summary CSV path (stdout)\n"
+        "  -h, --help             show this help\n");
+}
+
+bool parse_size(const char* s, std::size_t& out)
+{
+    char* stop = nullptr;
+    unsigned long long v = std::strtoull(s, &stop, 10);
+    if (stop == s || *stop != '\0') {
+        return false;
+    }
+    out = static_cast<std::size_t>(v);
+    return true;
+}
+
+bool parse_number(const char* s, double& out)
+{
+    char* stop = nullptr;
+    out = std::strtod(s, &stop);
+    return stop != s && *stop == '\0';
+}
+
+bool read_path_list(const std::string& path, std::vector<std::string>& files)
+{
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!line.empty()) {
+            files.push_back(line);
+        }
+    }
+    return true;
+}
+
+// Returns 0 to run, otherwise the exit code.
+int parse_args(int argc, char** argv, Options& opt)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "backtest_cli: %s needs a value\n", arg.c_str());
+                return nullptr;
+            }
+            return argv[++i];
+        };
+
+        const char* v = nullptr;
+        bool ok = true;
+        if (arg == "-h" || arg == "--help") {
+            print_usage(stdout);
+            return -1;
+        } else if (arg == "--window") {
+            ok = (v = value()) && parse_size(v, opt.window) && opt.window >= 1;
+        } else if (arg == "--z-entry") {
+            ok = (v = value()) && parse_number(v, opt.z_entry);
+        } else if (arg == "--z-exit") {
+            ok = (v = value()) && parse_number(v, opt.z_exit);
+        } else if (arg == "--capital") {
+            ok = (v = value()) && parse_number(v, opt.initial_capital) && opt.initial_capital > 0.0;
+        } else if (arg == "--cost") {
+            ok = (v = value()) && parse_number(v, opt.transaction_cost_pct);
+        } else if (arg == "--periods-per-year") {
+            ok = (v = value()) && parse_number(v, opt.periods_per_year) && opt.periods_per_year > 0.0;
+        } else if (arg == "--price") {
+            ok = (v = value()) && (std::string(v) == "close" || std::string(v) == "adj_close");
+            opt.adj_close = ok && std::string(v) == "adj_close";
+        } else if (arg == "--jobs") {
+            ok = (v = value()) && parse_size(v, opt.jobs);
+        } else if (arg == "--chunk-rows") {
+            ok = (v = value()) && parse_size(v, opt.chunk_rows) && opt.chunk_rows >= 1;
+        } else if (arg == "--list") {
+            ok = (v = value()) && read_path_list(v, opt.files);
+            if (v && !ok) {
+                std::fprintf(stderr, "backtest_cli: cannot read %s\n", v);
+                return 2;
+            }
+        } else if (arg == "-o" || arg == "--output") {
+            ok = (v = value()) != nullptr;
+            if (ok) {
+                opt.output = v;
+            }
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::fprintf(stderr, "backtest_cli: unknown option %s\n", arg.c_str());
+            return 2;
+        } else {
+            opt.files.push_back(arg);
+        }
+
+        if (!ok) {
+            if (v) {
+                std::fprintf(stderr, "backtest_cli: invalid value '%s' for %s\n", v, arg.c_str());
+            }
+            return 2;
+        }
+    }
+
+    if (opt.files.empty()) {
+        print_usage(stderr);
+        return 2;
+    }
+    if (opt.jobs == 0) {
+        opt.jobs = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return 0;
+}
+
+// =========================
+// Pipeline plumbing
+// =========================
+
+// Blocking FIFO with a fixed capacity.
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(std::size_t capacity) : capacity_(capacity) {}
+
+    void push(T item)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [&] { return items_.size() < capacity_; });
+        items_.push_back(std::move(item));
+        not_empty_.notify_one();
+    }
+
+    T pop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [&] { return !items_.empty(); });
+        T item = std::move(items_.front());
+        items_.pop_front();
+        not_full_.notify_one();
+        return item;
+    }
+
+private:
+    std::size_t capacity_;
+    std::deque<T> items_;
+    std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+};
+
+// Rows handed from the parser to the backtest; empty rows end the file.
+struct Chunk {
+    PriceColumns rows;
+    std::string error;
+};
+
+// Chunks in flight per file: one being parsed, one queued, one being run.
+constexpr std::size_t kChunksPerFile = 3;
+
+// =========================
+// Per-file backtest
+// =========================
+struct Summary {
+    bool ok = false;
+    std::string error;
+    std::size_t bars = 0;
+    std::size_t skipped_rows = 0;  // unparsable, out-of-order or NaN-price rows
+    std::size_t trades = 0;
+    double total_return = 0.0;
+    double max_drawdown = 0.0;
+    double sharpe_ratio = 0.0;
+    double final_equity = 0.0;
+};
+
+// Signal generation and backtest fed one bar at a time; bars must arrive
+// in increasing timestamp order, later duplicates and earlier rows are
+// skipped.
+class BarRunner {
+public:
+    explicit BarRunner(const Options& opt)
+        : generator_(opt.window, opt.z_entry, opt.z_exit),
+          backtest_(opt.initial_capital, opt.transaction_cost_pct, 1.0 / opt.periods_per_year) {}
+
+    void on_bar(std::int64_t ts, double price)
+    {
+        // The CSV reader already drops NaN closes; a NaN can still come
+        // from an adj_close column or a store written by other tools.
+        if ((bars_ > 0 && ts <= last_ts_) || std::isnan(price)) {
+            ++skipped_;
+            return;
+        }
+        last_ts_ = ts;
+        ++bars_;
+
+        int position_before = backtest_.position();
+        backtest_.on_bar(price, generator_.update(price));
+        if (backtest_.position() != position_before) {
+            ++trades_;
+        }
+    }
+
+    void run(ArrayView<const std::int64_t> ts, ArrayView<const double> prices)
+    {
+        for (std::size_t i = 0; i < prices.size(); ++i) {
+            on_bar(ts[i], prices[i]);
+        }
+    }
+
+    void finish(Summary& s) const
+    {
+        s.ok = true;
+        s.bars = bars_;
+        s.skipped_rows += skipped_;
+        s.trades = trades_;
+        s.total_return = backtest_.total_return();
+        s.max_drawdown = backtest_.max_drawdown();
+        s.sharpe_ratio = backtest_.sharpe_ratio();
+        s.final_equity = backtest_.equity();
+    }
+
+private:
+    SignalGenerator generator_;
+    StreamingBacktest backtest_;
+    std::int64_t last_ts_ = 0;
+    std::size_t bars_ = 0;
+    std::size_t skipped_ = 0;
+    std::size_t trades_ = 0;
+};
+
+bool is_csv_path(const std::string& path)
+{
+    if (path.size() < 4) {
+        return false;
+    }
+    std::string ext = path.substr(path.size() - 4);
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext == ".csv";
+}
+
+Summary run_store(const std::string& path, const Options& opt)
+{
+    Summary s;
+    PriceStore store;
+    if (!store.open(path, &s.error)) {
+        return s;
+    }
+    BarRunner runner(opt);
+    runner.run(store.timestamps(), opt.adj_close ? store.adj_closes() : store.closes());
+    runner.finish(s);
+    return s;
+}
+
+Summary run_csv(const std::string& path, const Options& opt)
+{
+    Summary s;
+    CsvPriceReader reader;
+    if (!reader.open(path, &s.error)) {
+        return s;
+    }
+    if (opt.adj_close && !reader.has_column(PriceStore::AdjClose)) {
+        s.error = path + ": 'Adj Close' column not found";
+        return s;
+    }
+
+    BoundedQueue<std::unique_ptr<Chunk>> free_chunks(kChunksPerFile);
+    BoundedQueue<std::unique_ptr<Chunk>> filled(kChunksPerFile);
+    for (std::size_t k = 0; k < kChunksPerFile; ++k) {
+        free_chunks.push(std::make_unique<Chunk>());
+    }
+
+    // Producer: parse the next chunk while this thread runs the last one.
+    std::thread parser([&] {
+        for (;;) {
+            std::unique_ptr<Chunk> chunk = free_chunks.pop();
+            chunk->error.clear();
+            bool ok = reader.read_rows(chunk->rows, opt.chunk_rows, &chunk->error);
+            bool done = !ok || chunk->rows.size() == 0;
+            if (!ok) {
+                chunk->rows = PriceColumns();
+            }
+            filled.push(std::move(chunk));
+            if (done) {
+                return;
+            }
+        }
+    });
+
+    BarRunner runner(opt);
+    for (;;) {
+        std::unique_ptr<Chunk> chunk = filled.pop();
+        if (chunk->rows.size() == 0) {
+            s.error = chunk->error;
+            break;
+        }
+        runner.run(ArrayView<const std::int64_t>(chunk->rows.timestamp),
+                   ArrayView<const double>(opt.adj_close ? chunk->rows.adj_close : chunk->rows.close));
+        free_chunks.push(std::move(chunk));
+    }
+    parser.join();
+
+    if (s.error.empty()) {
+        s.skipped_rows = reader.rows_skipped();
+        runner.finish(s);
+    }
+    return s;
+}
+
+// =========================
+// Output
+// =========================
+
+// Field text without separators or line breaks.
+std::string csv_safe(std::string text)
+{
+    for (char& c : text) {
+        if (c == ',' || c == '\n' || c == '\r' || c == '"') {
+            c = ' ';
+        }
+    }
+    return text;
+}
+
+void write_row(std::FILE* out, const std::string& path, const Summary& s)
+{
+    if (s.ok) {
+        std::fprintf(out, "%s,ok,%zu,%zu,%zu,%.10g,%.10g,%.10g,%.10g\n",
+                     csv_safe(path).c_str(), s.bars, s.skipped_rows, s.trades,
+                     s.total_return, s.max_drawdown, s.sharpe_ratio, s.final_equity);
+    } else {
+        std::fprintf(out, "%s,%s,,,,,,,\n", csv_safe(path).c_str(),
+                     csv_safe("error: " + s.error).c_str());
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    int code = parse_args(argc, argv, opt);
+    if (code != 0) {
+        return code < 0 ? 0 : code;
+    }
+
+    std::FILE* out = stdout;
+    if (!opt.output.empty()) {
+        out = std::fopen(opt.output.c_str(), "w");
+        if (!out) {
+            std::fprintf(stderr, "backtest_cli: cannot write %s\n", opt.output.c_str());
+            return 2;
+        }
+    }
+    std::fprintf(out, "file,status,bars,skipped_rows,trades,total_return,max_drawdown,"
+                      "sharpe_ratio,final_equity\n");
+
+    // Jobs take files in order; finished rows are written as soon as every
+    // earlier file is done, so the output keeps the input order.
+    const std::size_t num_files = opt.files.size();
+    std::vector<Summary> results(num_files);
+    std::vector<char> done(num_files, 0);
+    std::size_t next_to_write = 0;
+    std::mutex write_mutex;
+    std::atomic<std::size_t> next_file{0};
+    std::atomic<std::size_t> failures{0};
+
+    auto job = [&] {
+        for (std::size_t f = next_file++; f < num_files; f = next_file++) {
+            const std::string& path = opt.files[f];
+            Summary s = is_csv_path(path) ? run_csv(path, opt) : run_store(path, opt);
+            if (!s.ok) {
+                ++failures;
+            }
+
+            std::lock_guard<std::mutex> lock(write_mutex);
+            results[f] = std::move(s);
+            done[f] = 1;
+            while (next_to_write < num_files && done[next_to_write]) {
+                write_row(out, opt.files[next_to_write], results[next_to_write]);
+                results[next_to_write] = Summary();
+                ++next_to_write;
+            }
+        }
+    };
+
+    std::size_t num_jobs = std::min(opt.jobs, num_files);
+    std::vector<std::thread> workers;
+    for (std::size_t j = 1; j < num_jobs; ++j) {
+        workers.emplace_back(job);
+    }
+    job();
+    for (std::thread& t : workers) {
+        t.join();
+    }
+
+    if (out != stdout) {
+        std::fclose(out);
+    }
+    if (failures > 0) {
+        std::fprintf(stderr, "backtest_cli: %zu of %zu files failed\n",
+                     static_cast<std::size_t>(failures), num_files);
+        return 1;
+    }
     return 0;
 }
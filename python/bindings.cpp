@@ -1,21 +1,613 @@
 #include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
 #include <pybind11/stl.h>
 
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "../include/BacktestEngine.hpp"
+#include "../include/Bootstrap.hpp"
+#include "../include/ChunkReader.hpp"
+#include "../include/ColumnarFile.hpp"
+#include "../include/CostModels.hpp"
+#include "../include/CsvPriceReader.hpp"
+#include "../include/DecisionLayer.hpp"
+#include "../include/OrderBook.hpp"
+#include "../include/PortfolioBacktestEngine.hpp"
+#include "../include/PriceStore.hpp"
+#include "../include/ResultArena.hpp"
+#include "../include/RollingStatsCache.hpp"
+#include "../include/RollingSharpe.hpp"
+#include "../include/SignalGenerator.hpp"
+#include "../include/SparseBacktest.hpp"
+#include "../include/StrategyMonitor.hpp"
+#include "../include/StreamingBacktest.hpp"
+#include "../include/SweepExecutor.hpp"
+#include "../include/ThreadPool.hpp"
+#include "../include/WalkForward.hpp"
 
 namespace py = pybind11;
 
+namespace {
+
+// C-contiguous input arrays. Inputs that already have the right dtype and
+// layout are viewed in place; anything else is converted once by NumPy.
+using DoubleArray = py::array_t<double, py::array::c_style | py::array::forcecast>;
+using IntArray = py::array_t<int, py::array::c_style | py::array::forcecast>;
+
+// Exact int8 arrays only (no conversion), so the compact discrete layout is
+// picked for int8 inputs and everything else falls through to IntArray.
+using Int8Array = py::array_t<std::int8_t, py::array::c_style>;
+
+// Same conversion as DoubleArray / IntArray arguments, done inside the
+// binding so that its cost lands in `convert_ns` when profiling is enabled.
+template <typename T>
+py::array_t<T, py::array::c_style | py::array::forcecast> ensure_array(py::handle obj,
+                                                                      const char* name,
+                                                                      std::uint64_t& convert_ns)
+{
+    PhaseTimer<> timer(convert_ns);
+    auto a = py::array_t<T, py::array::c_style | py::array::forcecast>::ensure(obj);
+    if (!a) {
+        throw py::type_error(std::string(name) + " must be convertible to a numeric array");
+    }
+    return a;
+}
+
+template <typename T>
+ArrayView<const T> as_view(const py::array_t<T, py::array::c_style | py::array::forcecast>& a)
+{
+    return ArrayView<const T>(a.data(), static_cast<std::size_t>(a.size()));
+}
+
+// Read-only NumPy view over a vector owned by a bound C++ object. The array
+// keeps `owner` alive, so no data is copied into Python.
+template <typename T>
+py::array_t<T> owned_view(ArrayView<const T> v, py::handle owner)
+{
+    py::array_t<T> a(static_cast<py::ssize_t>(v.size()), v.data(), owner);
+    py::detail::array_proxy(a.ptr())->flags &= ~py::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+    return a;
+}
+
+template <typename T>
+py::array_t<T> owned_view(const std::vector<T>& v, py::handle owner)
+{
+    return owned_view(ArrayView<const T>(v), owner);
+}
+
+// Same, shaped as a row-major rows x cols matrix.
+template <typename T>
+py::array_t<T> owned_matrix_view(ArrayView<const T> v, std::size_t rows, std::size_t cols,
+                                 py::handle owner)
+{
+    py::array_t<T> a({static_cast<py::ssize_t>(rows), static_cast<py::ssize_t>(cols)}, v.data(), owner);
+    py::detail::array_proxy(a.ptr())->flags &= ~py::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+    return a;
+}
+
+template <typename T>
+py::array_t<T> owned_matrix_view(const std::vector<T>& v, std::size_t rows, std::size_t cols,
+                                 py::handle owner)
+{
+    return owned_matrix_view(ArrayView<const T>(v), rows, cols, owner);
+}
+
+// Hand a freshly built vector to NumPy without copying: the vector is moved
+// into a capsule that the array owns.
+template <typename T>
+py::array_t<T> to_numpy(std::vector<T>&& v)
+{
+    auto* owned = new std::vector<T>(std::move(v));
+    py::capsule free_when_done(owned, [](void* p) {
+        delete static_cast<std::vector<T>*>(p);
+    });
+    return py::array_t<T>(static_cast<py::ssize_t>(owned->size()), owned->data(), free_when_done);
+}
+
+// Deleter for objects whose destructor waits for pool tasks, which may in
+// turn be waiting for the GIL (progress callbacks): release it meanwhile.
+template <typename T>
+struct GilReleasingDelete {
+    void operator()(T* p) const
+    {
+        py::gil_scoped_release release;
+        delete p;
+    }
+};
+
+// run_backtest_with_costs, with the per-trade minimum fee wrapped around
+// `model` only when one is set.
+template <typename Model>
+BacktestResult run_with_costs(const BacktestEngine& engine, ArrayView<const double> prices,
+                              ArrayView<const int> signals, const Model& model, double min_fee,
+                              double dt_in_years, OutputMask outputs, KernelIsa isa)
+{
+    if (min_fee > 0.0) {
+        return engine.run_backtest_with_costs(prices, signals, MinimumFee<Model>(model, min_fee),
+                                              dt_in_years, outputs, isa);
+    }
+    return engine.run_backtest_with_costs(prices, signals, model, dt_in_years, outputs, isa);
+}
+
+// PriceRangeIndex together with the array it views, so the prices live as
+// long as the index does.
+struct PyPriceRangeIndex {
+    DoubleArray prices;
+    PriceRangeIndex index;
+
+    explicit PyPriceRangeIndex(DoubleArray p) : prices(std::move(p)), index(as_view(prices)) {}
+};
+
+// Position changes from parallel bar / position arrays.
+std::vector<PositionChange> position_changes(
+    const py::array_t<std::int64_t, py::array::c_style | py::array::forcecast>& bars,
+    const IntArray& positions)
+{
+    if (bars.size() != positions.size()) {
+        throw py::value_error("change bars and positions must have equal length");
+    }
+    std::vector<PositionChange> changes(static_cast<std::size_t>(bars.size()));
+    for (std::size_t k = 0; k < changes.size(); ++k) {
+        if (bars.data()[k] < 0) {
+            throw py::value_error("change bars must be non-negative");
+        }
+        changes[k] = {static_cast<std::size_t>(bars.data()[k]), positions.data()[k]};
+    }
+    return changes;
+}
+
+// PositionRun and BacktestResult classes for one position layout.
+template <typename PositionT>
+void bind_backtest_result(py::module_& m, const char* run_name, const char* result_name)
+{
+    using Run = BasicPositionRun<PositionT>;
+    using Result = BasicBacktestResult<PositionT>;
+
+    py::class_<Run>(m, run_name)
+        .def_readonly("start", &Run::start)
+        .def_readonly("length", &Run::length)
+        .def_readonly("position", &Run::position)
+        .def("__repr__", [run_name](const Run& r) {
+            return std::string(run_name) + "(start=" + std::to_string(r.start) +
+                   ", length=" + std::to_string(r.length) +
+                   ", position=" + py::repr(py::cast(r.position)).cast<std::string>() + ")";
+        });
+
+    py::class_<Result>(m, result_name)
+        .def_property_readonly("equity_curve", [](py::object self) {
+            return owned_view(self.cast<const Result&>().equity_curve, self);
+        })
+        .def_property_readonly("pnl", [](py::object self) {
+            return owned_view(self.cast<const Result&>().pnl, self);
+        })
+        .def_property_readonly("position", [](py::object self) {
+            return owned_view(self.cast<const Result&>().position, self);
+        })
+        .def_readonly("position_runs", &Result::position_runs)
+        .def_readonly("total_return", &Result::total_return)
+        .def_readonly("max_drawdown", &Result::max_drawdown)
+        .def_readonly("sharpe_ratio", &Result::sharpe_ratio)
+        .def_readonly("profile", &Result::profile);
+}
+
+} // namespace
+
 PYBIND11_MODULE(backtest, m) {
     m.doc() = "C++ backtesting engine exposed to Python via pybind11";
 
-    // BacktestResult binding
-    py::class_<BacktestResult>(m, "BacktestResult")
-        .def_readonly("equity_curve", &BacktestResult::equity_curve)
-        .def_readonly("pnl", &BacktestResult::pnl)
-        .def_readonly("position", &BacktestResult::position)
-        .def_readonly("total_return", &BacktestResult::total_return)
-        .def_readonly("max_drawdown", &BacktestResult::max_drawdown)
-        .def_readonly("sharpe_ratio", &BacktestResult::sharpe_ratio);
+    // OutputMask binding; flags combine with `|` into a plain int that the
+    // run_* methods accept as `outputs`.
+    py::enum_<OutputMask>(m, "OutputMask", py::arithmetic())
+        .value("Equity", OutputMask::Equity)
+        .value("Pnl", OutputMask::Pnl)
+        .value("Position", OutputMask::Position)
+        .value("PositionRuns", OutputMask::PositionRuns)
+        .value("Stats", OutputMask::Stats)
+        .value("Curves", OutputMask::Curves)
+        .value("All", OutputMask::All);
+
+    // KernelIsa binding
+    py::enum_<KernelIsa>(m, "KernelIsa")
+        .value("Auto", KernelIsa::Auto)
+        .value("Scalar", KernelIsa::Scalar)
+        .value("Avx2", KernelIsa::Avx2)
+        .value("Avx512", KernelIsa::Avx512)
+        .value("Neon", KernelIsa::Neon);
+
+    m.def("kernel_isa_supported", &kernel_isa_supported, py::arg("isa"));
+    m.def("resolve_kernel_isa", &resolve_kernel_isa, py::arg("isa") = KernelIsa::Auto,
+          "Instruction set the vectorised kernels will use for `isa`");
+
+    // BacktestStats binding; to_dict() is the flat form exported to metrics
+    m.attr("profiling_enabled") = kProfilingEnabled;
+    py::class_<BacktestStats>(m, "BacktestStats")
+        .def(py::init<>())
+        .def_readonly("convert_ns", &BacktestStats::convert_ns)
+        .def_readonly("setup_ns", &BacktestStats::setup_ns)
+        .def_readonly("loop_ns", &BacktestStats::loop_ns)
+        .def_readonly("metrics_ns", &BacktestStats::metrics_ns)
+        .def_readonly("bytes_allocated", &BacktestStats::bytes_allocated)
+        .def_readonly("bars_processed", &BacktestStats::bars_processed)
+        .def_readonly("trades", &BacktestStats::trades)
+        .def_readonly("runs", &BacktestStats::runs)
+        .def("merge", &BacktestStats::merge, py::arg("other"),
+             "Add another record's counters into this one")
+        .def("to_dict", [](const BacktestStats& s) {
+            py::dict d;
+            d["convert_ns"] = s.convert_ns;
+            d["setup_ns"] = s.setup_ns;
+            d["loop_ns"] = s.loop_ns;
+            d["metrics_ns"] = s.metrics_ns;
+            d["bytes_allocated"] = s.bytes_allocated;
+            d["bars_processed"] = s.bars_processed;
+            d["trades"] = s.trades;
+            d["runs"] = s.runs;
+            return d;
+        });
+
+    // PositionRun / BacktestResult bindings, one pair per position layout
+    bind_backtest_result<int>(m, "PositionRun", "BacktestResult");
+    bind_backtest_result<std::int8_t>(m, "DiscretePositionRun", "DiscreteBacktestResult");
+    bind_backtest_result<double>(m, "FractionalPositionRun", "FractionalBacktestResult");
+
+    // BatchResult binding
+    py::class_<BatchResult>(m, "BatchResult")
+        .def_readonly("num_candidates", &BatchResult::num_candidates)
+        .def_readonly("num_steps", &BatchResult::num_steps)
+        .def_property_readonly("total_return", [](py::object self) {
+            return owned_view(self.cast<const BatchResult&>().total_return, self);
+        })
+        .def_property_readonly("max_drawdown", [](py::object self) {
+            return owned_view(self.cast<const BatchResult&>().max_drawdown, self);
+        })
+        .def_property_readonly("sharpe_ratio", [](py::object self) {
+            return owned_view(self.cast<const BatchResult&>().sharpe_ratio, self);
+        })
+        .def_readonly("profile", &BatchResult::profile);
+
+    // PriceStore binding; column arrays view the memory mapping directly and
+    // keep the store alive, so close() is deliberately not exposed.
+    py::class_<PriceStore>(m, "PriceStore")
+        .def(py::init([](const std::string& path) {
+                 PriceStore store;
+                 std::string error;
+                 if (!store.open(path, &error)) {
+                     throw std::runtime_error(error);
+                 }
+                 return store;
+             }),
+             py::arg("path"))
+        .def("__len__", &PriceStore::size)
+        .def_property_readonly("timestamps", [](py::object self) {
+            return owned_view(self.cast<const PriceStore&>().timestamps(), self);
+        })
+        .def_property_readonly("opens", [](py::object self) {
+            return owned_view(self.cast<const PriceStore&>().opens(), self);
+        })
+        .def_property_readonly("highs", [](py::object self) {
+            return owned_view(self.cast<const PriceStore&>().highs(), self);
+        })
+        .def_property_readonly("lows", [](py::object self) {
+            return owned_view(self.cast<const PriceStore&>().lows(), self);
+        })
+        .def_property_readonly("closes", [](py::object self) {
+            return owned_view(self.cast<const PriceStore&>().closes(), self);
+        })
+        .def_property_readonly("adj_closes", [](py::object self) {
+            return owned_view(self.cast<const PriceStore&>().adj_closes(), self);
+        })
+        .def_property_readonly("volumes", [](py::object self) {
+            return owned_view(self.cast<const PriceStore&>().volumes(), self);
+        })
+        .def_static("convert_csv",
+                    [](const std::string& csv_path, const std::string& store_path) {
+                        std::string error;
+                        if (!PriceStore::convert_csv(csv_path, store_path, &error)) {
+                            throw std::runtime_error(error);
+                        }
+                    },
+                    py::arg("csv_path"),
+                    py::arg("store_path"),
+                    "Convert a price CSV (yfinance layout or plain OHLCV) into a store file");
+
+    // SignalGenerator binding
+    py::class_<SignalGenerator>(m, "SignalGenerator")
+        .def(py::init<std::size_t, double, double, std::size_t>(),
+             py::arg("window"),
+             py::arg("z_entry") = 2.0,
+             py::arg("z_exit") = 0.5,
+             py::arg("recompute_every") = 0)
+        .def_property_readonly("window", &SignalGenerator::window)
+        .def_property_readonly("z_entry", &SignalGenerator::z_entry)
+        .def_property_readonly("z_exit", &SignalGenerator::z_exit)
+        .def_property_readonly("position", &SignalGenerator::position)
+        .def_property_readonly("last_zscore", &SignalGenerator::last_zscore)
+        .def("reset", &SignalGenerator::reset)
+        .def("update", &SignalGenerator::update, py::arg("price"),
+             "Push one price and return the position (-1, 0, +1) for that bar")
+        .def("generate",
+             [](SignalGenerator& self, const DoubleArray& prices) {
+                 return to_numpy(self.generate(as_view(prices)));
+             },
+             py::arg("prices"),
+             "Reset and return int signals for the whole series")
+        .def("zscores",
+             [](SignalGenerator& self, const DoubleArray& prices) {
+                 return to_numpy(self.zscores(as_view(prices)));
+             },
+             py::arg("prices"),
+             "Reset and return the rolling z-score for the whole series");
+
+    // StreamingBacktest binding
+    py::class_<StreamingBar>(m, "StreamingBar")
+        .def_readonly("pnl", &StreamingBar::pnl)
+        .def_readonly("equity", &StreamingBar::equity)
+        .def_readonly("position", &StreamingBar::position);
+
+    py::class_<StreamingBacktest>(m, "StreamingBacktest")
+        .def(py::init<double, double, double, const std::vector<std::size_t>&>(),
+             py::arg("initial_capital"),
+             py::arg("transaction_cost_pct"),
+             py::arg("dt_in_years") = 1.0 / 252.0,
+             py::arg("sharpe_windows") = std::vector<std::size_t>())
+        .def("reset", &StreamingBacktest::reset)
+        .def("on_bar", &StreamingBacktest::on_bar, py::arg("price"), py::arg("signal"),
+             "Push one bar with its desired position and return a StreamingBar")
+        .def("on_bars",
+             [](StreamingBacktest& self, const DoubleArray& prices, const IntArray& signals) {
+                 if (prices.size() != signals.size()) {
+                     throw py::value_error("prices and signals must have equal length");
+                 }
+                 // Keeps the GIL: the block mutates self, which the other
+                 // methods read with the GIL held.
+                 self.on_bars(as_view(prices), as_view(signals));
+             },
+             py::arg("prices"),
+             py::arg("signals"),
+             "Push a block of bars")
+        .def_property_readonly("bars", &StreamingBacktest::bars)
+        .def_property_readonly("position", &StreamingBacktest::position)
+        .def_property_readonly("equity", &StreamingBacktest::equity)
+        .def_property_readonly("last_price", &StreamingBacktest::last_price)
+        .def_property_readonly("total_return", &StreamingBacktest::total_return)
+        .def_property_readonly("max_drawdown", &StreamingBacktest::max_drawdown)
+        .def_property_readonly("sharpe_ratio", &StreamingBacktest::sharpe_ratio)
+        .def_property_readonly("sharpe_windows", &StreamingBacktest::sharpe_windows)
+        .def_property_readonly("rolling_sharpes", &StreamingBacktest::rolling_sharpes)
+        .def("rolling_sharpe", &StreamingBacktest::rolling_sharpe, py::arg("k"),
+             "Rolling PnL Sharpe for sharpe_windows[k] (NaN until the window is full)")
+        .def("serialize",
+             [](const StreamingBacktest& self) { return py::bytes(self.serialize()); },
+             "Binary state, restorable with deserialize()")
+        .def("deserialize",
+             [](StreamingBacktest& self, const py::bytes& state) {
+                 std::string error;
+                 if (!self.deserialize(std::string(state), &error)) {
+                     throw py::value_error(error);
+                 }
+             },
+             py::arg("state"))
+        .def(py::pickle(
+            [](const StreamingBacktest& self) { return py::bytes(self.serialize()); },
+            [](const py::bytes& state) {
+                StreamingBacktest s(0.0, 0.0);
+                std::string error;
+                if (!s.deserialize(std::string(state), &error)) {
+                    throw py::value_error(error);
+                }
+                return s;
+            }));
+
+    // StrategyMonitor binding
+    py::class_<StrategyMonitor>(m, "StrategyMonitor")
+        .def(py::init<const std::vector<std::size_t>&, const std::vector<std::size_t>&,
+                      double, double, double, double, double>(),
+             py::arg("signal_windows"),
+             py::arg("sharpe_windows"),
+             py::arg("z_entry") = 2.0,
+             py::arg("z_exit") = 0.5,
+             py::arg("cost_bps") = 1.0,
+             py::arg("initial_capital") = 100000.0,
+             py::arg("annualization") = 252.0)
+        .def("reset", &StrategyMonitor::reset)
+        .def("on_bar", &StrategyMonitor::on_bar, py::arg("timestamp"), py::arg("price"),
+             "Push one bar to every strategy")
+        .def("update",
+             [](StrategyMonitor& self,
+                const py::array_t<std::int64_t, py::array::c_style | py::array::forcecast>& timestamps,
+                const DoubleArray& prices) {
+                 if (timestamps.size() != prices.size()) {
+                     throw py::value_error("timestamps and prices must have the same length");
+                 }
+                 return self.update(as_view(timestamps), as_view(prices));
+             },
+             py::arg("timestamps"),
+             py::arg("prices"),
+             "Push the bars newer than last_timestamp; returns the number applied")
+        .def_property_readonly("bars", &StrategyMonitor::bars)
+        .def_property_readonly("last_timestamp", &StrategyMonitor::last_timestamp)
+        .def_property_readonly("signal_windows", &StrategyMonitor::signal_windows)
+        .def_property_readonly("sharpe_windows", &StrategyMonitor::sharpe_windows)
+        .def("backtest", &StrategyMonitor::backtest, py::arg("k"),
+             py::return_value_policy::reference_internal)
+        .def("generator", &StrategyMonitor::generator, py::arg("k"),
+             py::return_value_policy::reference_internal)
+        .def("sharpe_snapshot",
+             [](const StrategyMonitor& self) {
+                 py::array out = to_numpy(self.sharpe_snapshot());
+                 return out.reshape({static_cast<py::ssize_t>(self.num_strategies()),
+                                     static_cast<py::ssize_t>(self.sharpe_windows().size())});
+             },
+             "Latest rolling Sharpe, shape (len(signal_windows), len(sharpe_windows))")
+        .def("save_snapshot",
+             [](const StrategyMonitor& self, const std::string& path) {
+                 std::string error;
+                 if (!self.save_snapshot(path, &error)) {
+                     throw std::runtime_error(error);
+                 }
+             },
+             py::arg("path"))
+        .def("load_snapshot",
+             [](StrategyMonitor& self, const std::string& path) {
+                 std::string error;
+                 if (!self.load_snapshot(path, &error)) {
+                     throw std::runtime_error(error);
+                 }
+             },
+             py::arg("path"),
+             "Restore the state written by save_snapshot (bit-identical to a replay)");
+
+    // BootstrapEngine binding
+    py::enum_<BootstrapMethod>(m, "BootstrapMethod")
+        .value("Stationary", BootstrapMethod::Stationary)
+        .value("Block", BootstrapMethod::Block);
+
+    py::class_<BootstrapResult>(m, "BootstrapResult")
+        .def_readonly("num_configs", &BootstrapResult::num_configs)
+        .def_readonly("num_quantiles", &BootstrapResult::num_quantiles)
+        .def_readonly("num_resamples", &BootstrapResult::num_resamples)
+        .def_readonly("probabilities", &BootstrapResult::probabilities)
+        .def_property_readonly("sharpe_ratio", [](py::object self) {
+            const auto& r = self.cast<const BootstrapResult&>();
+            return owned_matrix_view(r.sharpe_ratio, r.num_configs, r.num_quantiles, self);
+        })
+        .def_property_readonly("max_drawdown", [](py::object self) {
+            const auto& r = self.cast<const BootstrapResult&>();
+            return owned_matrix_view(r.max_drawdown, r.num_configs, r.num_quantiles, self);
+        })
+        .def_property_readonly("total_return", [](py::object self) {
+            const auto& r = self.cast<const BootstrapResult&>();
+            return owned_matrix_view(r.total_return, r.num_configs, r.num_quantiles, self);
+        })
+        .def_property_readonly("sharpe_mean", [](py::object self) {
+            return owned_view(self.cast<const BootstrapResult&>().sharpe_mean, self);
+        })
+        .def_property_readonly("max_drawdown_mean", [](py::object self) {
+            return owned_view(self.cast<const BootstrapResult&>().max_drawdown_mean, self);
+        });
+
+    py::class_<BootstrapEngine>(m, "BootstrapEngine")
+        .def(py::init<double, std::size_t, double, BootstrapMethod, std::uint64_t, std::size_t>(),
+             py::arg("initial_capital"),
+             py::arg("num_resamples") = 10000,
+             py::arg("mean_block_length") = 20.0,
+             py::arg("method") = BootstrapMethod::Stationary,
+             py::arg("seed") = 0,
+             py::arg("num_threads") = 0)
+
+        .def_property_readonly("num_threads", &BootstrapEngine::num_threads)
+
+        .def("run",
+             [](const BootstrapEngine& self, const DoubleArray& pnl, double dt_in_years,
+                const std::vector<double>& probabilities) {
+                 if (pnl.ndim() != 1 && pnl.ndim() != 2) {
+                     throw py::value_error("pnl must be a (T,) or (N, T) array");
+                 }
+                 std::size_t num_steps = static_cast<std::size_t>(pnl.shape(pnl.ndim() - 1));
+                 ArrayView<const double> v = as_view(pnl);
+                 py::gil_scoped_release release;
+                 return self.run(v, num_steps, dt_in_years, probabilities);
+             },
+             py::arg("pnl"),
+             py::arg("dt_in_years"),
+             py::arg("probabilities") = std::vector<double>{0.05, 0.5, 0.95},
+             "Bootstrap quantiles of Sharpe, max drawdown and total return per PnL row "
+             "(GIL released)");
+
+    // ThreadPool binding, for the parallel single-series backtest
+    py::class_<ThreadPool>(m, "ThreadPool")
+        .def(py::init<std::size_t>(), py::arg("num_threads") = 0)
+        .def_property_readonly("size", &ThreadPool::size);
+
+    // Order types of the event-driven run_orders
+    py::enum_<OrderType>(m, "OrderType")
+        .value("Market", OrderType::Market)
+        .value("Limit", OrderType::Limit)
+        .value("Stop", OrderType::Stop)
+        .value("Cancel", OrderType::Cancel);
+
+    py::class_<OrderEvent>(m, "OrderEvent")
+        .def(py::init([](std::size_t bar, OrderType type, int when_position,
+                         int target_position, double price) {
+                 return OrderEvent{bar, type, when_position, target_position, price};
+             }),
+             py::arg("bar"), py::arg("type"), py::arg("when_position"),
+             py::arg("target_position"), py::arg("price") = 0.0)
+        .def_readwrite("bar", &OrderEvent::bar)
+        .def_readwrite("type", &OrderEvent::type)
+        .def_readwrite("when_position", &OrderEvent::when_position)
+        .def_readwrite("target_position", &OrderEvent::target_position)
+        .def_readwrite("price", &OrderEvent::price);
+
+    py::class_<OrderFill>(m, "OrderFill")
+        .def_readonly("bar", &OrderFill::bar)
+        .def_readonly("type", &OrderFill::type)
+        .def_readonly("from_position", &OrderFill::from_position)
+        .def_readonly("to_position", &OrderFill::to_position)
+        .def_readonly("price", &OrderFill::price)
+        .def_readonly("cost", &OrderFill::cost);
+
+    py::class_<OrderBacktestResult>(m, "OrderBacktestResult")
+        .def_readonly("backtest", &OrderBacktestResult::backtest)
+        .def_readonly("fills", &OrderBacktestResult::fills);
+
+    // Sparse trade-event path
+    py::class_<TradeRecord>(m, "TradeRecord")
+        .def_readonly("entry_bar", &TradeRecord::entry_bar)
+        .def_readonly("exit_bar", &TradeRecord::exit_bar)
+        .def_readonly("position", &TradeRecord::position)
+        .def_readonly("entry_price", &TradeRecord::entry_price)
+        .def_readonly("exit_price", &TradeRecord::exit_price)
+        .def_readonly("cost", &TradeRecord::cost)
+        .def_readonly("pnl", &TradeRecord::pnl)
+        .def_readonly("closed", &TradeRecord::closed);
+
+    py::class_<SparseBacktestResult>(m, "SparseBacktestResult")
+        .def_readonly("trades", &SparseBacktestResult::trades)
+        .def_readonly("total_return", &SparseBacktestResult::total_return)
+        .def_readonly("max_drawdown", &SparseBacktestResult::max_drawdown)
+        .def_readonly("sharpe_ratio", &SparseBacktestResult::sharpe_ratio)
+        .def_readonly("profile", &SparseBacktestResult::profile)
+        .def("ledger",
+             [](const SparseBacktestResult& self) {
+                 std::size_t count = self.trades.size();
+                 std::vector<std::int64_t> entry_bar(count), exit_bar(count);
+                 std::vector<int> position(count);
+                 std::vector<double> entry_price(count), exit_price(count), cost(count), pnl(count);
+                 std::vector<std::uint8_t> closed(count);
+                 for (std::size_t k = 0; k < count; ++k) {
+                     const TradeRecord& t = self.trades[k];
+                     entry_bar[k] = static_cast<std::int64_t>(t.entry_bar);
+                     exit_bar[k] = static_cast<std::int64_t>(t.exit_bar);
+                     position[k] = t.position;
+                     entry_price[k] = t.entry_price;
+                     exit_price[k] = t.exit_price;
+                     cost[k] = t.cost;
+                     pnl[k] = t.pnl;
+                     closed[k] = t.closed ? 1 : 0;
+                 }
+                 py::dict out;
+                 out["entry_bar"] = to_numpy(std::move(entry_bar));
+                 out["exit_bar"] = to_numpy(std::move(exit_bar));
+                 out["position"] = to_numpy(std::move(position));
+                 out["entry_price"] = to_numpy(std::move(entry_price));
+                 out["exit_price"] = to_numpy(std::move(exit_price));
+                 out["cost"] = to_numpy(std::move(cost));
+                 out["pnl"] = to_numpy(std::move(pnl));
+                 out["closed"] = to_numpy(std::move(closed)).attr("astype")("bool");
+                 return out;
+             },
+             "Trade ledger as a dict of NumPy columns, ready for pandas.DataFrame");
+
+    py::class_<PyPriceRangeIndex>(m, "PriceRangeIndex")
+        .def(py::init<DoubleArray>(), py::arg("prices"))
+        .def("__len__", [](const PyPriceRangeIndex& self) { return self.index.size(); });
 
     // BacktestEngine binding
     py::class_<BacktestEngine>(m, "BacktestEngine")
@@ -25,9 +617,946 @@ PYBIND11_MODULE(backtest, m) {
              py::arg("risk_free_rate") = 0.0)
 
         .def("run_backtest",
-             &BacktestEngine::run_backtest,
+             [](const BacktestEngine& self, const DoubleArray& prices,
+                SignalGenerator& generator, double dt_in_years, unsigned outputs) {
+                 return self.run_backtest(as_view(prices), generator, dt_in_years,
+                                          static_cast<OutputMask>(outputs));
+             },
+             py::arg("prices"),
+             py::arg("generator"),
+             py::arg("dt_in_years"),
+             py::arg("outputs") = static_cast<unsigned>(OutputMask::All),
+             "Run the backtest with signals generated inline by a SignalGenerator")
+
+        .def("run_backtest",
+             [](const BacktestEngine& self, const DoubleArray& prices,
+                const Int8Array& signals, double dt_in_years, unsigned outputs) {
+                 ArrayView<const std::int8_t> s(signals.data(), static_cast<std::size_t>(signals.size()));
+                 return self.run_backtest(as_view(prices), s, dt_in_years,
+                                          static_cast<OutputMask>(outputs));
+             },
+             py::arg("prices"),
+             py::arg("signals"),
+             py::arg("dt_in_years"),
+             py::arg("outputs") = static_cast<unsigned>(OutputMask::All),
+             "int8 signals: run the backtest in the one-byte layout and return a "
+             "DiscreteBacktestResult")
+
+        // Registered after the int8 overload, which only takes exact int8
+        // arrays; everything else is converted here.
+        .def("run_backtest",
+             [](const BacktestEngine& self, py::handle prices_in,
+                py::handle signals_in, double dt_in_years, unsigned outputs) {
+                 std::uint64_t convert_ns = 0;
+                 DoubleArray prices = ensure_array<double>(prices_in, "prices", convert_ns);
+                 IntArray signals = ensure_array<int>(signals_in, "signals", convert_ns);
+                 BacktestResult result = self.run_backtest(as_view(prices), as_view(signals),
+                                                           dt_in_years,
+                                                           static_cast<OutputMask>(outputs));
+                 result.profile.convert_ns = convert_ns;
+                 return result;
+             },
+             py::arg("prices"),
+             py::arg("signals"),
+             py::arg("dt_in_years"),
+             py::arg("outputs") = static_cast<unsigned>(OutputMask::All),
+             "Run the backtest and return a BacktestResult; `outputs` is an "
+             "OutputMask combination selecting which arrays are allocated")
+
+        .def_static("variant_names", &BacktestEngine::variant_names,
+                    "Names of the compile-time specialised loops, '<layout>_flat_<outputs>'")
+
+        .def("run_variant",
+             [](const BacktestEngine& self, const std::string& name, py::handle prices_in,
+                py::handle positions_in, double dt_in_years) -> py::object {
+                 std::uint64_t convert_ns = 0;
+                 DoubleArray prices = ensure_array<double>(prices_in, "prices", convert_ns);
+                 if (const auto* v = BacktestEngine::find_variant<int>(name)) {
+                     IntArray positions = ensure_array<int>(positions_in, "positions", convert_ns);
+                     BacktestResult result = self.run_variant(*v, as_view(prices), as_view(positions), dt_in_years);
+                     result.profile.convert_ns = convert_ns;
+                     return py::cast(std::move(result));
+                 }
+                 if (const auto* v = BacktestEngine::find_variant<std::int8_t>(name)) {
+                     auto positions = ensure_array<std::int8_t>(positions_in, "positions", convert_ns);
+                     DiscreteBacktestResult result = self.run_variant(*v, as_view(prices), as_view(positions), dt_in_years);
+                     result.profile.convert_ns = convert_ns;
+                     return py::cast(std::move(result));
+                 }
+                 if (const auto* v = BacktestEngine::find_variant<double>(name)) {
+                     DoubleArray positions = ensure_array<double>(positions_in, "positions", convert_ns);
+                     FractionalBacktestResult result = self.run_variant(*v, as_view(prices), as_view(positions), dt_in_years);
+                     result.profile.convert_ns = convert_ns;
+                     return py::cast(std::move(result));
+                 }
+                 throw py::value_error("unknown engine variant '" + name + "'");
+             },
+             py::arg("name"),
+             py::arg("prices"),
+             py::arg("positions"),
+             py::arg("dt_in_years"),
+             "Run the specialised loop `name` (see variant_names()); positions are "
+             "converted to the variant's layout")
+
+        .def("run_backtest_fractional",
+             [](const BacktestEngine& self, const DoubleArray& prices,
+                const DoubleArray& positions, double dt_in_years, unsigned outputs) {
+                 return self.run_backtest(as_view(prices), as_view(positions), dt_in_years,
+                                          static_cast<OutputMask>(outputs));
+             },
+             py::arg("prices"),
+             py::arg("positions"),
+             py::arg("dt_in_years"),
+             py::arg("outputs") = static_cast<unsigned>(OutputMask::All),
+             "Backtest fractional position weights and return a FractionalBacktestResult")
+
+        .def("run_backtest_scaled",
+             [](const BacktestEngine& self, const DoubleArray& prices, const IntArray& signals,
+                const DoubleArray& multipliers, double dt_in_years, unsigned outputs) {
+                 return self.run_backtest(as_view(prices), as_view(signals), as_view(multipliers),
+                                          dt_in_years, static_cast<OutputMask>(outputs));
+             },
+             py::arg("prices"),
+             py::arg("signals"),
+             py::arg("multipliers"),
+             py::arg("dt_in_years"),
+             py::arg("outputs") = static_cast<unsigned>(OutputMask::All),
+             "Backtest signals[i] * multipliers[i] (e.g. DecisionSeries.position_multiplier) "
+             "and return a FractionalBacktestResult")
+
+        .def("run_backtest_vectorized",
+             [](const BacktestEngine& self, const DoubleArray& prices,
+                const IntArray& signals, double dt_in_years, unsigned outputs,
+                KernelIsa isa) {
+                 return self.run_backtest_vectorized(as_view(prices), as_view(signals), dt_in_years,
+                                                     static_cast<OutputMask>(outputs), isa);
+             },
+             py::arg("prices"),
+             py::arg("signals"),
+             py::arg("dt_in_years"),
+             py::arg("outputs") = static_cast<unsigned>(OutputMask::All),
+             py::arg("isa") = KernelIsa::Auto,
+             "SIMD flat-cost backtest with runtime ISA dispatch; matches "
+             "run_backtest up to floating-point rounding")
+
+        .def("run_backtest_parallel",
+             [](const BacktestEngine& self, const DoubleArray& prices, const IntArray& signals,
+                double dt_in_years, ThreadPool& pool, unsigned outputs, std::size_t block_bars,
+                KernelIsa isa) {
+                 ExecutionPolicy policy = ExecutionPolicy::parallel_scan(pool, block_bars);
+                 policy.isa = isa;
+                 py::gil_scoped_release release;
+                 return self.run_backtest(as_view(prices), as_view(signals), dt_in_years,
+                                          static_cast<OutputMask>(outputs), policy);
+             },
              py::arg("prices"),
              py::arg("signals"),
              py::arg("dt_in_years"),
-             "Run the backtest and return a BacktestResult");
+             py::arg("pool"),
+             py::arg("outputs") = static_cast<unsigned>(OutputMask::All),
+             py::arg("block_bars") = 0,
+             py::arg("isa") = KernelIsa::Auto,
+             "Blocked two-pass scan of one long series across `pool` (GIL released); "
+             "deterministic for a given block_bars and equal to run_backtest up to "
+             "floating-point rounding")
+
+        .def("run_backtest_costs",
+             [](const BacktestEngine& self, const DoubleArray& prices, const IntArray& signals,
+                double dt_in_years, double cost_bps, std::optional<DoubleArray> highs,
+                std::optional<DoubleArray> lows, double spread_fraction,
+                std::optional<DoubleArray> volumes, double impact_coefficient, double min_fee,
+                unsigned outputs, KernelIsa isa) {
+                 if (highs.has_value() != lows.has_value()) {
+                     throw py::value_error("highs and lows must be given together");
+                 }
+                 std::size_t n = static_cast<std::size_t>(prices.size());
+                 if ((highs && (static_cast<std::size_t>(highs->size()) != n ||
+                                static_cast<std::size_t>(lows->size()) != n)) ||
+                     (volumes && static_cast<std::size_t>(volumes->size()) != n)) {
+                     throw py::value_error("highs, lows and volumes must have the size of prices");
+                 }
+
+                 ArrayView<const double> p = as_view(prices);
+                 ArrayView<const int> s = as_view(signals);
+                 OutputMask mask = static_cast<OutputMask>(outputs);
+                 ProportionalCost bps = ProportionalCost::from_bps(cost_bps);
+
+                 py::gil_scoped_release release;
+                 if (highs && volumes) {
+                     CostSum<ProportionalCost, SpreadCost, SqrtImpactCost> model(
+                         bps, SpreadCost(as_view(*highs), as_view(*lows), spread_fraction),
+                         SqrtImpactCost(as_view(*volumes), impact_coefficient));
+                     return run_with_costs(self, p, s, model, min_fee, dt_in_years, mask, isa);
+                 }
+                 if (highs) {
+                     CostSum<ProportionalCost, SpreadCost> model(
+                         bps, SpreadCost(as_view(*highs), as_view(*lows), spread_fraction));
+                     return run_with_costs(self, p, s, model, min_fee, dt_in_years, mask, isa);
+                 }
+                 if (volumes) {
+                     CostSum<ProportionalCost, SqrtImpactCost> model(
+                         bps, SqrtImpactCost(as_view(*volumes), impact_coefficient));
+                     return run_with_costs(self, p, s, model, min_fee, dt_in_years, mask, isa);
+                 }
+                 return run_with_costs(self, p, s, bps, min_fee, dt_in_years, mask, isa);
+             },
+             py::arg("prices"),
+             py::arg("signals"),
+             py::arg("dt_in_years"),
+             py::arg("cost_bps") = 0.0,
+             py::arg("highs") = py::none(),
+             py::arg("lows") = py::none(),
+             py::arg("spread_fraction") = 0.5,
+             py::arg("volumes") = py::none(),
+             py::arg("impact_coefficient") = 0.0,
+             py::arg("min_fee") = 0.0,
+             py::arg("outputs") = static_cast<unsigned>(OutputMask::All),
+             py::arg("isa") = KernelIsa::Auto,
+             "Vectorised backtest with a composite cost model: cost_bps on notional "
+             "turnover, plus spread_fraction * (high - low) per unit when highs/lows are "
+             "given, plus impact_coefficient * price * units * sqrt(units / volume) when "
+             "volumes are given, floored at min_fee per trade (GIL released). The "
+             "engine's transaction_cost_pct is not applied")
+
+        .def("run_metrics",
+             [](const BacktestEngine& self, const DoubleArray& prices,
+                SignalGenerator& generator, double dt_in_years) {
+                 return self.run_metrics(as_view(prices), generator, dt_in_years);
+             },
+             py::arg("prices"),
+             py::arg("generator"),
+             py::arg("dt_in_years"))
+
+        .def("run_metrics",
+             [](const BacktestEngine& self, const DoubleArray& prices,
+                const IntArray& signals, double dt_in_years) {
+                 return self.run_metrics(as_view(prices), as_view(signals), dt_in_years);
+             },
+             py::arg("prices"),
+             py::arg("signals"),
+             py::arg("dt_in_years"),
+             "Fused single-pass backtest returning only the statistics "
+             "(equity_curve, pnl and position are left empty)")
+
+        .def("run_backtest_chunked",
+             [](const BacktestEngine& self, const PriceStore& store, SignalGenerator& generator,
+                double dt_in_years, bool adj_close, std::size_t chunk_bars) {
+                 py::gil_scoped_release release;
+                 ViewChunkReader<double> prices(adj_close ? store.adj_closes() : store.closes());
+                 return self.run_backtest_chunked(prices, generator, dt_in_years, chunk_bars);
+             },
+             py::arg("store"),
+             py::arg("generator"),
+             py::arg("dt_in_years"),
+             py::arg("adj_close") = false,
+             py::arg("chunk_bars") = 0)
+
+        .def("run_backtest_chunked",
+             [](const BacktestEngine& self, const std::string& csv_path, SignalGenerator& generator,
+                double dt_in_years, bool adj_close, std::size_t chunk_bars) {
+                 BacktestResult result;
+                 std::string error;
+                 {
+                     py::gil_scoped_release release;
+                     CsvPriceReader reader;
+                     if (reader.open(csv_path, &error)) {
+                         CsvChunkReader prices(reader, adj_close ? PriceStore::AdjClose : PriceStore::Close);
+                         result = self.run_backtest_chunked(prices, generator, dt_in_years, chunk_bars);
+                         error = prices.error();
+                     }
+                 }
+                 if (!error.empty()) {
+                     throw std::runtime_error(error);
+                 }
+                 return result;
+             },
+             py::arg("csv_path"),
+             py::arg("generator"),
+             py::arg("dt_in_years"),
+             py::arg("adj_close") = false,
+             py::arg("chunk_bars") = 0,
+             "Metrics-only backtest over a PriceStore or a price CSV read chunk_bars "
+             "at a time (0 = 65536), so memory stays bounded for series larger than "
+             "RAM; statistics are identical to run_metrics (GIL released)")
+
+        .def("run_orders",
+             [](const BacktestEngine& self, const DoubleArray& open, const DoubleArray& high,
+                const DoubleArray& low, const DoubleArray& close,
+                const std::vector<OrderEvent>& orders, double dt_in_years, unsigned outputs) {
+                 if (open.size() != close.size() || high.size() != close.size() ||
+                     low.size() != close.size()) {
+                     throw py::value_error("open, high, low and close must have equal length");
+                 }
+                 OhlcBars bars{as_view(open), as_view(high), as_view(low), as_view(close)};
+                 py::gil_scoped_release release;
+                 return self.run_orders(bars, ArrayView<const OrderEvent>(orders), dt_in_years,
+                                        static_cast<OutputMask>(outputs));
+             },
+             py::arg("open"),
+             py::arg("high"),
+             py::arg("low"),
+             py::arg("close"),
+             py::arg("orders"),
+             py::arg("dt_in_years"),
+             py::arg("outputs") = static_cast<unsigned>(OutputMask::All),
+             "Event-driven backtest of limit / stop / market OrderEvents (sorted by bar) "
+             "against OHLC bars; returns an OrderBacktestResult with the fills (GIL released)")
+
+        .def("run_sparse",
+             [](const BacktestEngine& self, const PyPriceRangeIndex& index,
+                const py::array_t<std::int64_t, py::array::c_style | py::array::forcecast>& change_bars,
+                const IntArray& change_positions, double dt_in_years) {
+                 std::vector<PositionChange> changes = position_changes(change_bars, change_positions);
+                 py::gil_scoped_release release;
+                 return self.run_sparse(index.index, ArrayView<const PositionChange>(changes), dt_in_years);
+             },
+             py::arg("index"),
+             py::arg("change_bars"),
+             py::arg("change_positions"),
+             py::arg("dt_in_years"),
+             "Sparse backtest of position changes (bars strictly increasing) against a "
+             "PriceRangeIndex; cost scales with the number of changes (GIL released)")
+
+        .def("run_sparse",
+             [](const BacktestEngine& self, const DoubleArray& prices,
+                const py::array_t<std::int64_t, py::array::c_style | py::array::forcecast>& change_bars,
+                const IntArray& change_positions, double dt_in_years) {
+                 std::vector<PositionChange> changes = position_changes(change_bars, change_positions);
+                 py::gil_scoped_release release;
+                 return self.run_sparse(as_view(prices), ArrayView<const PositionChange>(changes), dt_in_years);
+             },
+             py::arg("prices"),
+             py::arg("change_bars"),
+             py::arg("change_positions"),
+             py::arg("dt_in_years"),
+             "Same, indexing `prices` for this call only; returns a SparseBacktestResult "
+             "with the trade ledger")
+
+        .def("run_batch",
+             [](BacktestEngine& self, py::handle prices_in,
+                py::handle signal_matrix_in, double dt_in_years) {
+                 std::uint64_t convert_ns = 0;
+                 DoubleArray prices = ensure_array<double>(prices_in, "prices", convert_ns);
+                 IntArray signal_matrix = ensure_array<int>(signal_matrix_in, "signal_matrix", convert_ns);
+                 if (signal_matrix.ndim() == 2 && signal_matrix.shape(1) != prices.size()) {
+                     throw py::value_error("signal_matrix must have shape (N, len(prices))");
+                 }
+                 BatchResult result = self.run_batch(as_view(prices), as_view(signal_matrix),
+                                                     dt_in_years);
+                 result.profile.convert_ns = convert_ns;
+                 return result;
+             },
+             py::arg("prices"),
+             py::arg("signal_matrix"),
+             py::arg("dt_in_years"),
+             "Run N candidate signal rows (N x T array, or flattened row-major) "
+             "against one price series and return a BatchResult")
+
+        .def("run_batch_mixed",
+             [](BacktestEngine& self, py::handle prices_in,
+                py::handle signal_matrix_in, double dt_in_years, const std::string& precision) {
+                 if (precision != "float32" && precision != "float64") {
+                     throw py::value_error("precision must be 'float32' or 'float64'");
+                 }
+                 bool single = precision == "float32";
+                 std::uint64_t convert_ns = 0;
+                 DoubleArray prices = ensure_array<double>(prices_in, "prices", convert_ns);
+
+                 // int8 matrices are read as they are; anything else as int.
+                 BatchResult result;
+                 py::ssize_t columns = 0;
+                 if (Int8Array::check_(signal_matrix_in)) {
+                     Int8Array signal_matrix = py::reinterpret_borrow<Int8Array>(signal_matrix_in);
+                     columns = signal_matrix.ndim() == 2 ? signal_matrix.shape(1) : prices.size();
+                     if (columns != prices.size()) {
+                         throw py::value_error("signal_matrix must have shape (N, len(prices))");
+                     }
+                     ArrayView<const std::int8_t> m(signal_matrix.data(),
+                                                    static_cast<std::size_t>(signal_matrix.size()));
+                     py::gil_scoped_release release;
+                     result = single ? self.run_batch_mixed<float>(as_view(prices), m, dt_in_years)
+                                     : self.run_batch_mixed<double>(as_view(prices), m, dt_in_years);
+                 } else {
+                     IntArray signal_matrix = ensure_array<int>(signal_matrix_in, "signal_matrix", convert_ns);
+                     columns = signal_matrix.ndim() == 2 ? signal_matrix.shape(1) : prices.size();
+                     if (columns != prices.size()) {
+                         throw py::value_error("signal_matrix must have shape (N, len(prices))");
+                     }
+                     ArrayView<const int> m = as_view(signal_matrix);
+                     py::gil_scoped_release release;
+                     result = single ? self.run_batch_mixed<float>(as_view(prices), m, dt_in_years)
+                                     : self.run_batch_mixed<double>(as_view(prices), m, dt_in_years);
+                 }
+                 result.profile.convert_ns = convert_ns;
+                 return result;
+             },
+             py::arg("prices"),
+             py::arg("signal_matrix"),
+             py::arg("dt_in_years"),
+             py::arg("precision") = "float32",
+             "run_batch with price moves and PnL in float32 (or float64) and double "
+             "accumulation; int8 signal matrices are read without conversion. Sharpe "
+             "ratios agree with run_batch to kMixedSharpeTolerance relative (GIL released)")
+        .def_property_readonly_static("mixed_sharpe_tolerance", [](py::object) {
+            return BacktestEngine::kMixedSharpeTolerance;
+        });
+
+    // PortfolioResult binding
+    py::class_<PortfolioResult>(m, "PortfolioResult")
+        .def_readonly("num_steps", &PortfolioResult::num_steps)
+        .def_readonly("num_assets", &PortfolioResult::num_assets)
+        .def_property_readonly("equity_curve", [](py::object self) {
+            return owned_view(self.cast<const PortfolioResult&>().equity_curve, self);
+        })
+        .def_property_readonly("pnl", [](py::object self) {
+            return owned_view(self.cast<const PortfolioResult&>().pnl, self);
+        })
+        .def_property_readonly("turnover_cost", [](py::object self) {
+            return owned_view(self.cast<const PortfolioResult&>().turnover_cost, self);
+        })
+        .def_property_readonly("asset_pnl", [](py::object self) {
+            return owned_view(self.cast<const PortfolioResult&>().asset_pnl, self);
+        })
+        .def_property_readonly("asset_cost", [](py::object self) {
+            return owned_view(self.cast<const PortfolioResult&>().asset_cost, self);
+        })
+        .def_property_readonly("asset_turnover", [](py::object self) {
+            return owned_view(self.cast<const PortfolioResult&>().asset_turnover, self);
+        })
+        .def_property_readonly("asset_pnl_curve", [](py::object self) {
+            const auto& r = self.cast<const PortfolioResult&>();
+            std::size_t rows = r.asset_pnl_curve.empty() ? 0 : r.num_steps;
+            return owned_matrix_view(r.asset_pnl_curve, rows, r.num_assets, self);
+        })
+        .def_readonly("total_return", &PortfolioResult::total_return)
+        .def_readonly("max_drawdown", &PortfolioResult::max_drawdown)
+        .def_readonly("sharpe_ratio", &PortfolioResult::sharpe_ratio);
+
+    // PortfolioBacktestEngine binding
+    py::class_<PortfolioBacktestEngine>(m, "PortfolioBacktestEngine")
+        .def(py::init<double, double, double>(),
+             py::arg("initial_capital"),
+             py::arg("transaction_cost_pct"),
+             py::arg("risk_free_rate") = 0.0)
+
+        .def("run",
+             [](const PortfolioBacktestEngine& self, const DoubleArray& prices,
+                const DoubleArray& positions, double dt_in_years, bool keep_asset_curves) {
+                 if (prices.ndim() != 2 || positions.ndim() != 2 ||
+                     prices.shape(0) != positions.shape(0) || prices.shape(1) != positions.shape(1)) {
+                     throw py::value_error("prices and positions must be (T, N) arrays of equal shape");
+                 }
+                 ArrayView<const double> p = as_view(prices);
+                 ArrayView<const double> q = as_view(positions);
+                 std::size_t num_assets = static_cast<std::size_t>(prices.shape(1));
+                 py::gil_scoped_release release;
+                 return self.run(p, q, num_assets, dt_in_years, keep_asset_curves);
+             },
+             py::arg("prices"),
+             py::arg("positions"),
+             py::arg("dt_in_years"),
+             py::arg("keep_asset_curves") = false,
+             "Run a T x N (time-major) portfolio backtest and return a PortfolioResult");
+
+    // RollingSharpePanel binding
+    py::class_<RollingSharpePanel>(m, "RollingSharpePanel")
+        .def_readonly("num_windows", &RollingSharpePanel::num_windows)
+        .def_readonly("num_steps", &RollingSharpePanel::num_steps)
+        .def_readonly("windows", &RollingSharpePanel::windows)
+        .def_property_readonly("values", [](py::object self) {
+            const auto& p = self.cast<const RollingSharpePanel&>();
+            return owned_matrix_view(p.values, p.num_windows, p.num_steps, self);
+        })
+        .def_property_readonly("latest", [](py::object self) {
+            return owned_view(self.cast<const RollingSharpePanel&>().latest, self);
+        });
+
+    m.def("rolling_sharpe_panel",
+          [](const DoubleArray& returns, const std::vector<std::size_t>& windows,
+             double annualization) {
+              ArrayView<const double> r = as_view(returns);
+              py::gil_scoped_release release;
+              return compute_rolling_sharpe_panel(r, windows, annualization);
+          },
+          py::arg("returns"),
+          py::arg("windows"),
+          py::arg("annualization") = 252.0,
+          "Rolling Sharpe for every window in one pass: values is (W, T), "
+          "latest is the last column");
+
+    // Columnar result files, read back by python/columnar.py
+    m.def("write_sharpe_panel",
+          [](const std::string& path, const py::array_t<std::int64_t, py::array::c_style | py::array::forcecast>& timestamps,
+             const std::vector<std::size_t>& signal_windows, const std::vector<RollingSharpePanel>& panels) {
+              ArrayView<const std::int64_t> ts = as_view(timestamps);
+              std::string error;
+              bool ok;
+              {
+                  py::gil_scoped_release release;
+                  ok = write_sharpe_panel(path, ts, signal_windows, panels, &error);
+              }
+              if (!ok) {
+                  throw std::runtime_error(error);
+              }
+          },
+          py::arg("path"),
+          py::arg("timestamps"),
+          py::arg("signal_windows"),
+          py::arg("panels"),
+          "Write (timestamp, signal_window, sharpe_window, rolling_sharpe) rows, one "
+          "row group per window pair, NaN rows dropped (GIL released)");
+
+    m.def("write_batch_result",
+          [](const std::string& path, const BatchResult& result,
+             std::optional<std::vector<SignalParams>> grid, std::size_t rows_per_group) {
+              std::string error;
+              bool ok;
+              {
+                  py::gil_scoped_release release;
+                  ok = write_batch_result(path, result, grid ? &*grid : nullptr, rows_per_group, &error);
+              }
+              if (!ok) {
+                  throw std::runtime_error(error);
+              }
+          },
+          py::arg("path"),
+          py::arg("result"),
+          py::arg("grid") = py::none(),
+          py::arg("rows_per_group") = 65536,
+          "Write per-candidate sweep statistics (and the grid's parameters, if given) "
+          "in row groups (GIL released)");
+
+    // DecisionLayer binding
+    py::enum_<RiskMode>(m, "RiskMode")
+        .value("NORMAL", RiskMode::Normal)
+        .value("REDUCE", RiskMode::Reduce)
+        .value("STOP", RiskMode::Stop);
+
+    py::class_<Decision>(m, "Decision")
+        .def_readonly("risk_mode", &Decision::risk_mode)
+        .def_readonly("position_multiplier", &Decision::position_multiplier)
+        .def_readonly("frac_below_warn", &Decision::frac_below_warn)
+        .def_readonly("frac_below_stop", &Decision::frac_below_stop);
+
+    py::class_<DecisionSeries>(m, "DecisionSeries")
+        .def_readonly("num_signal_windows", &DecisionSeries::num_signal_windows)
+        .def_readonly("num_steps", &DecisionSeries::num_steps)
+        .def_property_readonly("risk_mode", [](py::object self) {
+            return owned_view(self.cast<const DecisionSeries&>().risk_mode, self);
+        })
+        .def_property_readonly("position_multiplier", [](py::object self) {
+            return owned_view(self.cast<const DecisionSeries&>().position_multiplier, self);
+        })
+        .def_property_readonly("frac_below_warn", [](py::object self) {
+            return owned_view(self.cast<const DecisionSeries&>().frac_below_warn, self);
+        })
+        .def_property_readonly("frac_below_stop", [](py::object self) {
+            return owned_view(self.cast<const DecisionSeries&>().frac_below_stop, self);
+        })
+        .def_property_readonly("scores", [](py::object self) {
+            const auto& d = self.cast<const DecisionSeries&>();
+            return owned_matrix_view(d.scores, d.num_signal_windows, d.num_steps, self);
+        });
+
+    py::class_<DecisionLayer>(m, "DecisionLayer")
+        .def(py::init<double, double, double, double>(),
+             py::arg("warn_sharpe") = 0.0,
+             py::arg("stop_sharpe") = -0.5,
+             py::arg("frac_warn") = 0.5,
+             py::arg("frac_stop") = 0.75)
+        .def("decide",
+             [](const DecisionLayer& self, const DoubleArray& snapshot) {
+                 if (snapshot.ndim() != 2) {
+                     throw py::value_error("snapshot must be a (signal_windows, sharpe_windows) array");
+                 }
+                 return self.decide(as_view(snapshot), static_cast<std::size_t>(snapshot.shape(0)));
+             },
+             py::arg("snapshot"),
+             "Decision from one latest-Sharpe snapshot")
+        .def("evaluate",
+             [](const DecisionLayer& self, const std::vector<RollingSharpePanel>& panels) {
+                 py::gil_scoped_release release;
+                 return self.evaluate(panels);
+             },
+             py::arg("panels"),
+             "Per-bar decisions from one RollingSharpePanel per signal window")
+        .def("evaluate",
+             [](const DecisionLayer& self, const DoubleArray& grid) {
+                 if (grid.ndim() != 3) {
+                     throw py::value_error("grid must be a (signal_windows, sharpe_windows, T) array");
+                 }
+                 ArrayView<const double> g = as_view(grid);
+                 std::size_t s = static_cast<std::size_t>(grid.shape(0));
+                 std::size_t h = static_cast<std::size_t>(grid.shape(1));
+                 py::gil_scoped_release release;
+                 return self.evaluate(g, s, h);
+             },
+             py::arg("grid"),
+             "Per-bar decisions from a (signal_windows, sharpe_windows, T) Sharpe grid");
+
+    // SweepJob binding: a concurrent.futures-style handle (done, cancel,
+    // result) that asyncio code can also await.
+    py::class_<SweepJob, std::shared_ptr<SweepJob>> sweep_future(m, "SweepFuture");
+
+    py::enum_<SweepJob::State>(sweep_future, "State")
+        .value("Running", SweepJob::State::Running)
+        .value("Done", SweepJob::State::Done)
+        .value("Cancelled", SweepJob::State::Cancelled)
+        .value("Failed", SweepJob::State::Failed);
+
+    sweep_future
+        .def_property_readonly("state", &SweepJob::state)
+        .def_property_readonly("num_candidates", &SweepJob::num_candidates)
+        .def_property_readonly("completed", &SweepJob::completed)
+        .def("done", &SweepJob::finished)
+        .def("running", [](const SweepJob& self) { return !self.finished(); })
+        .def("cancelled", [](const SweepJob& self) { return self.state() == SweepJob::State::Cancelled; })
+        .def("cancel", &SweepJob::cancel,
+             "Skip the chunks not yet started; False if the sweep had already finished")
+        .def("wait",
+             [](const SweepJob& self, std::optional<double> timeout) {
+                 py::gil_scoped_release release;
+                 if (!timeout) {
+                     self.wait();
+                     return true;
+                 }
+                 return self.wait_for(*timeout);
+             },
+             py::arg("timeout") = py::none(),
+             "Block until finished (GIL released); False on timeout")
+        .def("result",
+             [](const SweepJob& self, std::optional<double> timeout) {
+                 bool finished = true;
+                 {
+                     py::gil_scoped_release release;
+                     if (timeout) {
+                         finished = self.wait_for(*timeout);
+                     } else {
+                         self.wait();
+                     }
+                 }
+                 if (!finished) {
+                     PyErr_SetString(PyExc_TimeoutError, "sweep still running");
+                     throw py::error_already_set();
+                 }
+                 if (self.state() == SweepJob::State::Cancelled) {
+                     py::object cancelled = py::module_::import("concurrent.futures").attr("CancelledError");
+                     PyErr_SetString(cancelled.ptr(), "sweep was cancelled");
+                     throw py::error_already_set();
+                 }
+                 if (self.state() == SweepJob::State::Failed) {
+                     throw std::runtime_error(self.error());
+                 }
+                 return BatchResult(self.result());
+             },
+             py::arg("timeout") = py::none(),
+             "Wait (GIL released) and return the BatchResult; raises TimeoutError, "
+             "concurrent.futures.CancelledError, or RuntimeError if the sweep failed")
+        .def("partial",
+             [](SweepJob& self) {
+                 std::vector<std::int64_t> index;
+                 std::vector<double> total_return, max_drawdown, sharpe_ratio;
+                 const BatchResult& r = self.result();
+                 for (const auto& range : self.take_finished()) {
+                     for (std::size_t k = range.first; k < range.second; ++k) {
+                         index.push_back(static_cast<std::int64_t>(k));
+                         total_return.push_back(r.total_return[k]);
+                         max_drawdown.push_back(r.max_drawdown[k]);
+                         sharpe_ratio.push_back(r.sharpe_ratio[k]);
+                     }
+                 }
+                 py::dict out;
+                 out["index"] = to_numpy(std::move(index));
+                 out["total_return"] = to_numpy(std::move(total_return));
+                 out["max_drawdown"] = to_numpy(std::move(max_drawdown));
+                 out["sharpe_ratio"] = to_numpy(std::move(sharpe_ratio));
+                 return out;
+             },
+             "Candidates finished since the previous call, as a dict of 'index', "
+             "'total_return', 'max_drawdown' and 'sharpe_ratio' arrays")
+        .def("__await__",
+             [](py::object self) {
+                 // Wait on the loop's default executor; result() drops the GIL.
+                 py::object loop = py::module_::import("asyncio").attr("get_running_loop")();
+                 return loop.attr("run_in_executor")(py::none(), self.attr("result")).attr("__await__")();
+             });
+
+    // SweepExecutor binding. Destroying it waits for queued chunks, so that
+    // happens without the GIL.
+    py::class_<SweepExecutor, std::unique_ptr<SweepExecutor, GilReleasingDelete<SweepExecutor>>>(
+        m, "SweepExecutor")
+        .def(py::init<const BacktestEngine&, std::size_t>(),
+             py::arg("engine"),
+             py::arg("num_threads") = 0)
+
+        .def_property_readonly("num_threads", &SweepExecutor::num_threads)
+
+        .def("run",
+             [](const SweepExecutor& self, py::handle prices_in,
+                py::handle signal_matrix_in, double dt_in_years) {
+                 std::uint64_t convert_ns = 0;
+                 DoubleArray prices = ensure_array<double>(prices_in, "prices", convert_ns);
+                 IntArray signal_matrix = ensure_array<int>(signal_matrix_in, "signal_matrix", convert_ns);
+                 if (signal_matrix.ndim() == 2 && signal_matrix.shape(1) != prices.size()) {
+                     throw py::value_error("signal_matrix must have shape (N, len(prices))");
+                 }
+                 ArrayView<const double> p = as_view(prices);
+                 ArrayView<const int> s = as_view(signal_matrix);
+                 BatchResult result;
+                 {
+                     py::gil_scoped_release release;
+                     result = self.run(p, s, dt_in_years);
+                 }
+                 result.profile.convert_ns = convert_ns;
+                 return result;
+             },
+             py::arg("prices"),
+             py::arg("signal_matrix"),
+             py::arg("dt_in_years"),
+             "Run N candidate signal rows across the thread pool (GIL released); "
+             "results are identical to BacktestEngine.run_batch")
+
+        .def("submit_sweep",
+             [](const SweepExecutor& self, const DoubleArray& prices, const IntArray& signal_matrix,
+                double dt_in_years, py::object on_progress) {
+                 if (signal_matrix.ndim() == 2 && signal_matrix.shape(1) != prices.size()) {
+                     throw py::value_error("signal_matrix must have shape (N, len(prices))");
+                 }
+                 ArrayView<const double> p = as_view(prices);
+                 ArrayView<const int> s = as_view(signal_matrix);
+                 std::size_t total = p.empty() ? 0 : s.size() / p.size();
+
+                 SweepProgressFn progress;
+                 if (!on_progress.is_none()) {
+                     // Workers hold the callback; whichever drops it last
+                     // takes the GIL to do so.
+                     std::shared_ptr<py::object> callback(new py::object(std::move(on_progress)),
+                                                          [](py::object* f) {
+                                                              py::gil_scoped_acquire gil;
+                                                              delete f;
+                                                          });
+                     progress = [callback, total](std::size_t, std::size_t, std::size_t completed) {
+                         py::gil_scoped_acquire gil;
+                         try {
+                             (*callback)(completed, total);
+                         } catch (py::error_already_set& e) {
+                             throw std::runtime_error(e.what());
+                         }
+                     };
+                 }
+
+                 py::gil_scoped_release release;
+                 return self.submit(p, s, dt_in_years, std::move(progress));
+             },
+             py::arg("prices"),
+             py::arg("signal_matrix"),
+             py::arg("dt_in_years"),
+             py::arg("on_progress") = py::none(),
+             "Start run() in the background and return a SweepFuture at once. The "
+             "signal matrix is copied; on_progress(completed, total) is called from "
+             "worker threads as chunks finish, and an exception from it fails the sweep")
+
+        .def("run_curves",
+             [](const SweepExecutor& self, const DoubleArray& prices,
+                const IntArray& signal_matrix, double dt_in_years, unsigned outputs) {
+                 if (signal_matrix.ndim() == 2 && signal_matrix.shape(1) != prices.size()) {
+                     throw py::value_error("signal_matrix must have shape (N, len(prices))");
+                 }
+                 ArrayView<const double> p = as_view(prices);
+                 ArrayView<const int> s = as_view(signal_matrix);
+                 OutputMask mask = static_cast<OutputMask>(outputs);
+
+                 // One slab sized for every curve block of this call, owned
+                 // by the returned arrays.
+                 std::size_t count = s.size();
+                 std::size_t bytes = 3 * ResultArena::kAlignment;
+                 bytes += has_output(mask, OutputMask::Equity) ? count * sizeof(double) : 0;
+                 bytes += has_output(mask, OutputMask::Pnl) ? count * sizeof(double) : 0;
+                 bytes += has_output(mask, OutputMask::Position) ? count * sizeof(int) : 0;
+                 auto arena = std::make_shared<ResultArena>(bytes);
+
+                 BatchResult result;
+                 {
+                     py::gil_scoped_release release;
+                     result = self.run(p, s, dt_in_years, *arena, mask);
+                 }
+
+                 py::capsule owner(new std::shared_ptr<ResultArena>(arena), [](void* ptr) {
+                     delete static_cast<std::shared_ptr<ResultArena>*>(ptr);
+                 });
+                 std::size_t rows = result.num_candidates;
+                 std::size_t cols = result.num_steps;
+                 py::dict curves;
+                 if (!result.equity_curve.empty()) {
+                     curves["equity_curve"] = owned_matrix_view(
+                         ArrayView<const double>(result.equity_curve.data(), count), rows, cols, owner);
+                 }
+                 if (!result.pnl.empty()) {
+                     curves["pnl"] = owned_matrix_view(
+                         ArrayView<const double>(result.pnl.data(), count), rows, cols, owner);
+                 }
+                 if (!result.position.empty()) {
+                     curves["position"] = owned_matrix_view(
+                         ArrayView<const int>(result.position.data(), count), rows, cols, owner);
+                 }
+                 return py::make_tuple(std::move(result), curves);
+             },
+             py::arg("prices"),
+             py::arg("signal_matrix"),
+             py::arg("dt_in_years"),
+             py::arg("outputs") = static_cast<unsigned>(OutputMask::Curves),
+             "Like run, but also returns the per-candidate curves: (BatchResult, dict) "
+             "with (N, T) 'equity_curve', 'pnl' and 'position' arrays selected by "
+             "`outputs`, all carved from one arena buffer (GIL released)");
+
+    // Walk-forward bindings
+    py::class_<FoldSplit>(m, "FoldSplit")
+        .def(py::init<>())
+        .def(py::init([](std::size_t train_begin, std::size_t train_end,
+                         std::size_t test_begin, std::size_t test_end) {
+                 return FoldSplit{train_begin, train_end, test_begin, test_end};
+             }),
+             py::arg("train_begin"), py::arg("train_end"),
+             py::arg("test_begin"), py::arg("test_end"))
+        .def_readwrite("train_begin", &FoldSplit::train_begin)
+        .def_readwrite("train_end", &FoldSplit::train_end)
+        .def_readwrite("test_begin", &FoldSplit::test_begin)
+        .def_readwrite("test_end", &FoldSplit::test_end);
+
+    py::class_<SignalParams>(m, "SignalParams")
+        .def(py::init([](std::size_t window, double z_entry, double z_exit) {
+                 return SignalParams{window, z_entry, z_exit};
+             }),
+             py::arg("window"), py::arg("z_entry") = 2.0, py::arg("z_exit") = 0.5)
+        .def_readwrite("window", &SignalParams::window)
+        .def_readwrite("z_entry", &SignalParams::z_entry)
+        .def_readwrite("z_exit", &SignalParams::z_exit);
+
+    py::class_<WalkForwardFold>(m, "WalkForwardFold")
+        .def_readonly("split", &WalkForwardFold::split)
+        .def_readonly("best_config", &WalkForwardFold::best_config)
+        .def_readonly("in_sample_sharpe", &WalkForwardFold::in_sample_sharpe)
+        .def_readonly("test_total_return", &WalkForwardFold::test_total_return)
+        .def_readonly("test_max_drawdown", &WalkForwardFold::test_max_drawdown)
+        .def_readonly("test_sharpe", &WalkForwardFold::test_sharpe);
+
+    py::class_<WalkForwardResult>(m, "WalkForwardResult")
+        .def_readonly("num_folds", &WalkForwardResult::num_folds)
+        .def_readonly("num_configs", &WalkForwardResult::num_configs)
+        .def_readonly("folds", &WalkForwardResult::folds)
+        .def_property_readonly("in_sample_sharpe", [](py::object self) {
+            const auto& r = self.cast<const WalkForwardResult&>();
+            return owned_matrix_view(r.in_sample_sharpe, r.num_folds, r.num_configs, self);
+        })
+        .def_property_readonly("out_of_sample_sharpe", [](py::object self) {
+            const auto& r = self.cast<const WalkForwardResult&>();
+            return owned_matrix_view(r.out_of_sample_sharpe, r.num_folds, r.num_configs, self);
+        });
+
+    m.def("make_walk_forward_splits", &make_walk_forward_splits,
+          py::arg("num_steps"),
+          py::arg("train_bars"),
+          py::arg("test_bars"),
+          py::arg("step_bars") = 0,
+          py::arg("anchored") = false,
+          "Rolling (or anchored) train/test splits over num_steps bars");
+
+    m.def("make_param_grid", &make_param_grid,
+          py::arg("windows"),
+          py::arg("z_entries"),
+          py::arg("z_exits"),
+          "Cartesian product of SignalGenerator settings");
+
+    py::class_<WalkForwardOptimizer>(m, "WalkForwardOptimizer")
+        .def(py::init<const BacktestEngine&, std::size_t>(),
+             py::arg("engine"),
+             py::arg("num_threads") = 0)
+
+        .def_property_readonly("num_threads", &WalkForwardOptimizer::num_threads)
+
+        .def("run",
+             [](const WalkForwardOptimizer& self, const DoubleArray& prices,
+                const std::vector<FoldSplit>& splits, const std::vector<SignalParams>& grid,
+                double dt_in_years) {
+                 ArrayView<const double> p = as_view(prices);
+                 py::gil_scoped_release release;
+                 return self.run(p, splits, grid, dt_in_years);
+             },
+             py::arg("prices"),
+             py::arg("splits"),
+             py::arg("grid"),
+             py::arg("dt_in_years"),
+             "Pick the best in-sample config per fold by Sharpe and evaluate it out of "
+             "sample (GIL released)");
+
+    py::class_<RollingStatsCache>(m, "RollingStatsCache")
+        .def(py::init<>())
+        .def("add_series",
+             [](RollingStatsCache& self, const std::string& id, const DoubleArray& prices) {
+                 ArrayView<const double> p = as_view(prices);
+                 py::gil_scoped_release release;
+                 self.add_series(id, p);
+             },
+             py::arg("id"), py::arg("prices"),
+             "Register (or replace) a series and build its prefix sums")
+        .def("has_series", &RollingStatsCache::has_series, py::arg("id"))
+        .def("erase", &RollingStatsCache::erase, py::arg("id"))
+        .def("clear", &RollingStatsCache::clear)
+        .def("series_size", &RollingStatsCache::series_size, py::arg("id"))
+        .def_property_readonly("cached_windows", &RollingStatsCache::cached_windows)
+        .def("rolling_mean",
+             [](const RollingStatsCache& self, const std::string& id, std::size_t window) {
+                 return to_numpy(self.rolling_mean(id, window));
+             },
+             py::arg("id"), py::arg("window"),
+             "Rolling mean of every bar (NaN during warm-up)")
+        .def("rolling_std",
+             [](const RollingStatsCache& self, const std::string& id, std::size_t window) {
+                 return to_numpy(self.rolling_std(id, window));
+             },
+             py::arg("id"), py::arg("window"),
+             "Rolling population std of every bar (NaN during warm-up or for zero variance)")
+        .def("zscores",
+             [](RollingStatsCache& self, const std::string& id, std::size_t window) {
+                 std::vector<double> z;
+                 {
+                     py::gil_scoped_release release;
+                     ArrayView<const double> v = self.zscores(id, window);
+                     z.assign(v.begin(), v.end());
+                 }
+                 return to_numpy(std::move(z));
+             },
+             py::arg("id"), py::arg("window"),
+             "Rolling z-score of every bar, computed once per (id, window) (GIL released)")
+        .def("signals",
+             [](RollingStatsCache& self, const std::string& id, const SignalParams& params) {
+                 std::vector<int> out(self.series_size(id));
+                 bool ok;
+                 {
+                     py::gil_scoped_release release;
+                     ok = self.signals_into(id, params, ArrayView<int>(out));
+                 }
+                 if (!ok) {
+                     throw py::value_error("unknown series id or window == 0");
+                 }
+                 return to_numpy(std::move(out));
+             },
+             py::arg("id"), py::arg("params"),
+             "Signals of one SignalParams from the cached z-scores")
+        .def("signal_matrix",
+             [](RollingStatsCache& self, const std::string& id, const std::vector<SignalParams>& grid) {
+                 std::size_t n = self.series_size(id);
+                 std::vector<int> out;
+                 {
+                     py::gil_scoped_release release;
+                     out = self.signal_matrix(id, grid);
+                 }
+                 if (out.size() != grid.size() * n) {
+                     throw py::value_error("unknown series id or window == 0");
+                 }
+                 py::array m = to_numpy(std::move(out));
+                 return m.reshape({static_cast<py::ssize_t>(grid.size()), static_cast<py::ssize_t>(n)});
+             },
+             py::arg("id"), py::arg("grid"),
+             "(len(grid), T) int signal matrix for run_batch / SweepExecutor.run (GIL released)");
 }
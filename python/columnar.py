@@ -0,0 +1,115 @@
+import struct
+
+import numpy as np
+
+
+# Layout documented in include/ColumnarFile.hpp (ColumnarWriter).
+MAGIC = b"MRTABLE\0"
+VERSION = 1
+HEADER = struct.Struct("<8sIIQQQ")
+PLAIN, CONSTANT = 0, 1
+DTYPES = {1: np.dtype("<i8"), 2: np.dtype("<f8")}
+
+
+class ColumnarFile:
+    """
+    Memory-mapped reader for the columnar result files written from C++
+    (rolling Sharpe panels, sweep results).
+
+    Plain chunks are returned as read-only views of the mapping, so nothing
+    is parsed or copied; Constant chunks (a key repeated over a row group)
+    are zero-stride broadcasts of their single value. Only column() over
+    several row groups and to_pandas() copy.
+    """
+
+    def __init__(self, path):
+        self.path = path
+        self._map = np.memmap(path, dtype=np.uint8, mode="r")
+        buf = self._map
+        if len(buf) < 64:
+            raise ValueError(f"{path}: too small for a columnar file")
+
+        magic, version, num_columns, num_rows, num_groups, footer = HEADER.unpack_from(buf, 0)
+        if magic != MAGIC or version != VERSION:
+            raise ValueError(f"{path}: not a columnar file (bad magic or version)")
+        if footer == 0:
+            raise ValueError(f"{path}: unfinished file (writer was not closed)")
+
+        pos = footer
+        self.columns = []
+        self.dtypes = []
+        for _ in range(num_columns):
+            type_code, name_length = struct.unpack_from("<II", buf, pos)
+            pos += 8
+            self.columns.append(bytes(buf[pos:pos + name_length]).decode("utf-8"))
+            self.dtypes.append(DTYPES[type_code])
+            pos += name_length
+
+        self._groups = []
+        for _ in range(num_groups):
+            (rows,) = struct.unpack_from("<Q", buf, pos)
+            pos += 8
+            chunks = []
+            for _ in range(num_columns):
+                encoding, _, offset = struct.unpack_from("<IIQ", buf, pos)
+                pos += 16
+                chunks.append((encoding, offset))
+            self._groups.append((rows, chunks))
+
+        self.num_rows = num_rows
+        self.num_row_groups = num_groups
+
+    def __len__(self):
+        return self.num_rows
+
+    def _chunk(self, group, c):
+        rows, chunks = self._groups[group]
+        encoding, offset = chunks[c]
+        dtype = self.dtypes[c]
+        if encoding == CONSTANT:
+            value = np.frombuffer(self._map, dtype=dtype, count=1, offset=offset)
+            return np.broadcast_to(value, (rows,))
+        return np.frombuffer(self._map, dtype=dtype, count=rows, offset=offset)
+
+    def row_group(self, k):
+        """Columns of row group k as a dict of zero-copy arrays."""
+        return {name: self._chunk(k, c) for c, name in enumerate(self.columns)}
+
+    def row_groups(self):
+        for k in range(self.num_row_groups):
+            yield self.row_group(k)
+
+    def column(self, name):
+        """Whole column; a view for single-group files, else one copy."""
+        c = self.columns.index(name)
+        parts = [self._chunk(k, c) for k in range(self.num_row_groups)]
+        if len(parts) == 1:
+            return parts[0]
+        if not parts:
+            return np.empty(0, dtype=self.dtypes[c])
+        return np.concatenate(parts)
+
+    def to_arrow(self):
+        """
+        pyarrow.Table with one record batch per row group. Plain chunks
+        become Arrow buffers over the mapping without a copy; Constant
+        chunks are expanded.
+        """
+        import pyarrow as pa
+
+        batches = []
+        for group in self.row_groups():
+            arrays = [pa.array(np.ascontiguousarray(group[name])) for name in self.columns]
+            batches.append(pa.RecordBatch.from_arrays(arrays, names=self.columns))
+        if not batches:
+            schema = pa.schema([(name, pa.from_numpy_dtype(d)) for name, d in zip(self.columns, self.dtypes)])
+            return pa.Table.from_batches([], schema=schema)
+        return pa.Table.from_batches(batches)
+
+    def to_pandas(self):
+        import pandas as pd
+
+        df = pd.DataFrame({name: self.column(name) for name in self.columns})
+        if "timestamp" in df.columns:
+            df["Date"] = pd.to_datetime(df["timestamp"], unit="s")
+        return df
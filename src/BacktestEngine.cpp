@@ -1,8 +1,141 @@
 #include "BacktestEngine.hpp"
+#include "ChunkReader.hpp"
+#include "CostModels.hpp"
+#include "OrderBook.hpp"
+#include "RunningMetrics.hpp"
+#include "SignalGenerator.hpp"
+#include "SparseBacktest.hpp"
+#include "StreamingBacktest.hpp"
+#include "ThreadPool.hpp"
 
 #include <algorithm>    // std::max
 #include <cmath>        // std::sqrt
+#include <cstdlib>      // std::abs(int)
+#include <cstdint>
+#include <limits>
 #include <numeric>      // std::accumulate
+#include <string>
+
+namespace {
+
+// Output policies of BacktestEngine::simulate. StaticOutputs fixes the
+// selection at compile time, so each specialisation only contains the
+// stores and statistics it needs; DynamicOutputs covers every other mask
+// with one runtime-flagged loop.
+template <OutputMask Mask>
+struct StaticOutputs {
+    static constexpr bool equity = has_output(Mask, OutputMask::Equity);
+    static constexpr bool pnl = has_output(Mask, OutputMask::Pnl);
+    static constexpr bool position = has_output(Mask, OutputMask::Position);
+    static constexpr bool runs = has_output(Mask, OutputMask::PositionRuns);
+    static constexpr bool stats = has_output(Mask, OutputMask::Stats);
+};
+
+struct DynamicOutputs {
+    bool equity;
+    bool pnl;
+    bool position;
+    bool runs;
+    bool stats;
+
+    explicit DynamicOutputs(OutputMask mask)
+        : equity(has_output(mask, OutputMask::Equity)),
+          pnl(has_output(mask, OutputMask::Pnl)),
+          position(has_output(mask, OutputMask::Position)),
+          runs(has_output(mask, OutputMask::PositionRuns)),
+          stats(has_output(mask, OutputMask::Stats)) {}
+};
+
+// Statistics plus the run-length encoded positions (trade list).
+constexpr OutputMask kStatsRuns = OutputMask::Stats | OutputMask::PositionRuns;
+
+// Variant name prefix of each position layout.
+template <typename PositionT>
+struct LayoutName;
+
+template <>
+struct LayoutName<int> {
+    static constexpr const char* value = "int";
+};
+
+template <>
+struct LayoutName<std::int8_t> {
+    static constexpr const char* value = "int8";
+};
+
+template <>
+struct LayoutName<double> {
+    static constexpr const char* value = "double";
+};
+
+constexpr std::size_t kDefaultChunkBars = std::size_t(1) << 16;
+constexpr std::size_t kDefaultScanBlockBars = std::size_t(1) << 16;
+
+// Largest of x[0..count), with four independent running maxima so the
+// compare chain does not serialise the loop.
+double max_of(const double* x, std::size_t count)
+{
+    double m0 = -std::numeric_limits<double>::infinity();
+    double m1 = m0;
+    double m2 = m0;
+    double m3 = m0;
+    std::size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        m0 = x[k] > m0 ? x[k] : m0;
+        m1 = x[k + 1] > m1 ? x[k + 1] : m1;
+        m2 = x[k + 2] > m2 ? x[k + 2] : m2;
+        m3 = x[k + 3] > m3 ? x[k + 3] : m3;
+    }
+    for (; k < count; ++k) {
+        m0 = x[k] > m0 ? x[k] : m0;
+    }
+    return std::max(std::max(m0, m1), std::max(m2, m3));
+}
+
+// State of one ParallelScan block.
+struct ScanBlock {
+    double total = 0.0;       // running local prefix sum (the block total after pass 1)
+    double max_prefix = -std::numeric_limits<double>::infinity();  // largest local prefix
+    RunningMetrics moments;   // PnL moments of the block (Sharpe)
+    double start_equity = 0.0;  // equity before the block's first bar
+    double start_peak = 0.0;    // running peak before it (then the block's own)
+    double max_drawdown = 0.0;
+};
+
+// Final statistics of a chunked run (empty for fewer than two bars, as
+// for the in-memory overloads).
+BacktestResult chunked_result(const StreamingBacktest& state)
+{
+    BacktestResult result;
+    if (state.bars() <= 1) {
+        return result;
+    }
+    result.total_return = state.total_return();
+    result.max_drawdown = state.max_drawdown();
+    result.sharpe_ratio = state.sharpe_ratio();
+    return result;
+}
+
+// Size counters of a single-run profile; the phase timings are filled in
+// by the run itself.
+template <typename PositionT>
+void record_profile(BasicBacktestResult<PositionT>& result,
+                    std::size_t n,
+                    std::uint64_t trades,
+                    std::uint64_t scratch_bytes = 0)
+{
+    if constexpr (kProfilingEnabled) {
+        BacktestStats& p = result.profile;
+        p.bytes_allocated = vector_bytes(result.equity_curve) + vector_bytes(result.pnl) +
+                            vector_bytes(result.position) + vector_bytes(result.position_runs) +
+                            scratch_bytes;
+        p.bars_processed = n;
+        p.trades = trades;
+        p.runs = 1;
+    }
+}
+
+}  // namespace
 
 BacktestEngine::BacktestEngine(double initial_capital,
                                double transaction_cost_pct,
@@ -14,65 +147,1265 @@ BacktestEngine::BacktestEngine(double initial_capital,
 
 BacktestResult BacktestEngine::run_backtest(const std::vector<double>& prices,
                                             const std::vector<int>& signals,
-                                            double dt_in_years)
+                                            double dt_in_years) const
 {
-    BacktestResult result;
+    return run_backtest(ArrayView<const double>(prices),
+                        ArrayView<const int>(signals),
+                        dt_in_years);
+}
 
-    // Basic sanity checks
+template <typename PositionT, typename Outputs, typename CostPolicy, typename SignalFn>
+BasicBacktestResult<PositionT> BacktestEngine::simulate(ArrayView<const double> prices,
+                                                        SignalFn&& signal_at,
+                                                        const CostPolicy& costs,
+                                                        Outputs outputs,
+                                                        double dt_in_years) const
+{
+    using Run = BasicPositionRun<PositionT>;
+
+    BasicBacktestResult<PositionT> result;
     std::size_t n = prices.size();
-    if (n == 0 || signals.size() != n || n == 1) {
-        // Return default result (everything zero / empty)
-        return result;
-    }
 
-    result.equity_curve.resize(n);
-    result.pnl.resize(n);
-    result.position.resize(n);
+    // Constants for a StaticOutputs policy, so unused work drops out.
+    const bool keep_equity = outputs.equity;
+    const bool keep_pnl = outputs.pnl;
+    const bool keep_position = outputs.position;
+    const bool keep_runs = outputs.runs;
+    const bool want_stats = outputs.stats;
+
+    // Without both curves, drawdown and PnL moments are folded into the loop.
+    const bool fused_stats = want_stats && !(keep_equity && keep_pnl);
 
     double equity = initial_capital_;
-    int current_pos = 0;
+    PositionT current_pos = 0;
+    RunningMetrics metrics;
+    std::uint64_t trades = 0;
+
+    PhaseTimer<> setup_timer(result.profile.setup_ns);
 
     // Initialise at t = 0
-    result.equity_curve[0] = equity;
-    result.pnl[0] = 0.0;
-    result.position[0] = current_pos;
+    if (keep_equity) {
+        result.equity_curve.resize(n);
+        result.equity_curve[0] = equity;
+    }
+    if (keep_pnl) {
+        result.pnl.resize(n);
+        result.pnl[0] = 0.0;
+    }
+    if (keep_position) {
+        result.position.resize(n);
+        result.position[0] = current_pos;
+    }
+    if (keep_runs) {
+        result.position_runs.push_back(Run{0, 0, current_pos});
+    }
+    if (fused_stats) {
+        metrics.reset(equity);
+        metrics.add_equity(equity);
+        metrics.add_pnl(0.0);
+    }
+    setup_timer.stop();
 
+    PhaseTimer<> loop_timer(result.profile.loop_ns);
     for (std::size_t i = 1; i < n; ++i) {
-        int desired_pos = signals[i];
-
-        // If position changes, pay transaction cost
-        if (desired_pos != current_pos) {
-            double traded_notional = std::abs(desired_pos - current_pos) * prices[i];
-            double cost = traded_notional * transaction_cost_pct_;
-            equity -= cost;
-            result.pnl[i] -= cost;
-            current_pos = desired_pos;
+        PositionT desired_pos = signal_at(i);
+
+        // Transaction cost of the position change, 0 when there is none,
+        // so the step needs no branch (0.0 - 0.0 and equity - 0.0 leave the
+        // values bit-identical to skipping the update).
+        double units = std::abs(desired_pos - current_pos);
+        double cost = costs(i, units, prices[i]);
+        if constexpr (kProfilingEnabled) {
+            trades += desired_pos != current_pos;
         }
+        if (keep_runs && desired_pos != current_pos) {
+            Run& last = result.position_runs.back();
+            last.length = i - last.start;
+            result.position_runs.push_back(Run{i, 0, desired_pos});
+        }
+        equity -= cost;
+        double step_total = 0.0 - cost;
+        current_pos = desired_pos;
 
         // PnL from price movement
         double price_change = prices[i] - prices[i - 1];
         double step_pnl = current_pos * price_change;
-        result.pnl[i] += step_pnl;
+        step_total += step_pnl;
         equity += step_pnl;
 
         // Store results
-        result.position[i] = current_pos;
-        result.equity_curve[i] = equity;
+        if (keep_pnl) {
+            result.pnl[i] = step_total;
+        }
+        if (keep_position) {
+            result.position[i] = current_pos;
+        }
+        if (keep_equity) {
+            result.equity_curve[i] = equity;
+        }
+        if (fused_stats) {
+            metrics.add_pnl(step_total);
+            metrics.add_equity(equity);
+        }
+    }
+
+    if (keep_runs) {
+        Run& last = result.position_runs.back();
+        last.length = n - last.start;
     }
+    loop_timer.stop();
 
     // Total return
     result.total_return = (equity / initial_capital_) - 1.0;
 
-    // Max drawdown based on equity curve
-    result.max_drawdown = compute_max_drawdown(result.equity_curve);
+    if (fused_stats) {
+        result.max_drawdown = metrics.max_drawdown;
+        result.sharpe_ratio = metrics.sharpe(dt_in_years);
+    } else if (want_stats) {
+        PhaseTimer<> metrics_timer(result.profile.metrics_ns);
+
+        // Max drawdown based on equity curve
+        result.max_drawdown = compute_max_drawdown(result.equity_curve);
 
-    // Sharpe ratio based on PnL series
-    result.sharpe_ratio = compute_sharpe(result.pnl, dt_in_years);
+        // Sharpe ratio based on PnL series
+        result.sharpe_ratio = compute_sharpe(result.pnl, dt_in_years);
+    }
 
+    record_profile(result, n, trades);
     return result;
 }
 
-double BacktestEngine::compute_max_drawdown(const std::vector<double>& equity) const
+template <typename PositionT, typename SignalFn>
+BasicBacktestResult<PositionT> BacktestEngine::dispatch_outputs(ArrayView<const double> prices,
+                                                                SignalFn&& signal_at,
+                                                                double dt_in_years,
+                                                                OutputMask outputs) const
+{
+    ProportionalCost costs(transaction_cost_pct_);
+    if (outputs == OutputMask::All) {
+        return simulate<PositionT>(prices, signal_at, costs, StaticOutputs<OutputMask::All>(), dt_in_years);
+    }
+    if (outputs == OutputMask::Curves) {
+        return simulate<PositionT>(prices, signal_at, costs, StaticOutputs<OutputMask::Curves>(), dt_in_years);
+    }
+    if (outputs == OutputMask::Stats) {
+        return simulate<PositionT>(prices, signal_at, costs, StaticOutputs<OutputMask::Stats>(), dt_in_years);
+    }
+    if (outputs == kStatsRuns) {
+        return simulate<PositionT>(prices, signal_at, costs, StaticOutputs<kStatsRuns>(), dt_in_years);
+    }
+    if (outputs == OutputMask::None) {
+        return simulate<PositionT>(prices, signal_at, costs, StaticOutputs<OutputMask::None>(), dt_in_years);
+    }
+    return simulate<PositionT>(prices, signal_at, costs, DynamicOutputs(outputs), dt_in_years);
+}
+
+template <typename PositionT, OutputMask Outputs>
+BasicBacktestResult<PositionT> BacktestEngine::run_fixed(ArrayView<const double> prices,
+                                                         ArrayView<const PositionT> positions,
+                                                         double dt_in_years) const
+{
+    if (prices.size() <= 1 || positions.size() != prices.size()) {
+        return BasicBacktestResult<PositionT>();
+    }
+    return simulate<PositionT>(prices, [&](std::size_t i) { return positions[i]; },
+                               ProportionalCost(transaction_cost_pct_),
+                               StaticOutputs<Outputs>(), dt_in_years);
+}
+
+template <typename PositionT>
+ArrayView<const EngineVariant<PositionT>> BacktestEngine::variants()
+{
+    using Variant = EngineVariant<PositionT>;
+    const std::string layout = LayoutName<PositionT>::value;
+    static const Variant table[] = {
+        {layout + "_flat_all", OutputMask::All, &BacktestEngine::run_fixed<PositionT, OutputMask::All>},
+        {layout + "_flat_curves", OutputMask::Curves, &BacktestEngine::run_fixed<PositionT, OutputMask::Curves>},
+        {layout + "_flat_stats", OutputMask::Stats, &BacktestEngine::run_fixed<PositionT, OutputMask::Stats>},
+        {layout + "_flat_stats_runs", kStatsRuns, &BacktestEngine::run_fixed<PositionT, kStatsRuns>},
+        {layout + "_flat_return_only", OutputMask::None, &BacktestEngine::run_fixed<PositionT, OutputMask::None>},
+    };
+    return ArrayView<const Variant>(table, sizeof(table) / sizeof(table[0]));
+}
+
+template <typename PositionT>
+const EngineVariant<PositionT>* BacktestEngine::find_variant(const std::string& name)
+{
+    for (const EngineVariant<PositionT>& v : variants<PositionT>()) {
+        if (v.name == name) {
+            return &v;
+        }
+    }
+    return nullptr;
+}
+
+std::vector<std::string> BacktestEngine::variant_names()
+{
+    std::vector<std::string> names;
+    for (const auto& v : variants<int>()) {
+        names.push_back(v.name);
+    }
+    for (const auto& v : variants<std::int8_t>()) {
+        names.push_back(v.name);
+    }
+    for (const auto& v : variants<double>()) {
+        names.push_back(v.name);
+    }
+    return names;
+}
+
+template ArrayView<const EngineVariant<int>> BacktestEngine::variants<int>();
+template ArrayView<const EngineVariant<std::int8_t>> BacktestEngine::variants<std::int8_t>();
+template ArrayView<const EngineVariant<double>> BacktestEngine::variants<double>();
+template const EngineVariant<int>* BacktestEngine::find_variant<int>(const std::string&);
+template const EngineVariant<std::int8_t>* BacktestEngine::find_variant<std::int8_t>(const std::string&);
+template const EngineVariant<double>* BacktestEngine::find_variant<double>(const std::string&);
+
+BacktestResult BacktestEngine::run_backtest(ArrayView<const double> prices,
+                                            ArrayView<const int> signals,
+                                            double dt_in_years,
+                                            OutputMask outputs) const
+{
+    // Basic sanity checks
+    std::size_t n = prices.size();
+    if (n == 0 || signals.size() != n || n == 1) {
+        // Return default result (everything zero / empty)
+        return BacktestResult();
+    }
+
+    return dispatch_outputs<int>(prices, [&](std::size_t i) { return signals[i]; }, dt_in_years, outputs);
+}
+
+template <typename PositionT>
+BasicBacktestResult<PositionT> BacktestEngine::run_backtest(ArrayView<const double> prices,
+                                                            ArrayView<const PositionT> positions,
+                                                            double dt_in_years,
+                                                            OutputMask outputs) const
+{
+    std::size_t n = prices.size();
+    if (n <= 1 || positions.size() != n) {
+        return BasicBacktestResult<PositionT>();
+    }
+
+    return dispatch_outputs<PositionT>(prices, [&](std::size_t i) { return positions[i]; },
+                                       dt_in_years, outputs);
+}
+
+template <typename PositionT>
+FractionalBacktestResult BacktestEngine::run_backtest(ArrayView<const double> prices,
+                                                      ArrayView<const PositionT> signals,
+                                                      ArrayView<const double> multipliers,
+                                                      double dt_in_years,
+                                                      OutputMask outputs) const
+{
+    std::size_t n = prices.size();
+    if (n <= 1 || signals.size() != n || multipliers.size() != n) {
+        return FractionalBacktestResult();
+    }
+
+    return dispatch_outputs<double>(
+        prices,
+        [&](std::size_t i) { return static_cast<double>(signals[i]) * multipliers[i]; },
+        dt_in_years,
+        outputs);
+}
+
+// Supported position layouts.
+template DiscreteBacktestResult BacktestEngine::run_backtest<std::int8_t>(
+    ArrayView<const double>, ArrayView<const std::int8_t>, double, OutputMask) const;
+template BacktestResult BacktestEngine::run_backtest<int>(
+    ArrayView<const double>, ArrayView<const int>, double, OutputMask) const;
+template FractionalBacktestResult BacktestEngine::run_backtest<double>(
+    ArrayView<const double>, ArrayView<const double>, double, OutputMask) const;
+
+template FractionalBacktestResult BacktestEngine::run_backtest<std::int8_t>(
+    ArrayView<const double>, ArrayView<const std::int8_t>, ArrayView<const double>, double,
+    OutputMask) const;
+template FractionalBacktestResult BacktestEngine::run_backtest<int>(
+    ArrayView<const double>, ArrayView<const int>, ArrayView<const double>, double,
+    OutputMask) const;
+template FractionalBacktestResult BacktestEngine::run_backtest<double>(
+    ArrayView<const double>, ArrayView<const double>, ArrayView<const double>, double,
+    OutputMask) const;
+
+BacktestResult BacktestEngine::run_backtest(ArrayView<const double> prices,
+                                            SignalGenerator& generator,
+                                            double dt_in_years,
+                                            OutputMask outputs) const
+{
+    if (prices.size() <= 1) {
+        return BacktestResult();
+    }
+
+    // Signals are produced bar by bar inside the loop; bar 0 only warms up
+    // the generator since the engine always starts flat.
+    generator.reset();
+    generator.update(prices[0]);
+
+    return dispatch_outputs<int>(prices,
+                                 [&](std::size_t i) { return generator.update(prices[i]); },
+                                 dt_in_years,
+                                 outputs);
+}
+
+BacktestResult BacktestEngine::run_metrics(ArrayView<const double> prices,
+                                           ArrayView<const int> signals,
+                                           double dt_in_years) const
+{
+    return run_backtest(prices, signals, dt_in_years, OutputMask::Stats);
+}
+
+BacktestResult BacktestEngine::run_metrics(ArrayView<const double> prices,
+                                           SignalGenerator& generator,
+                                           double dt_in_years) const
+{
+    return run_backtest(prices, generator, dt_in_years, OutputMask::Stats);
+}
+
+BacktestResult BacktestEngine::run_backtest_chunked(ChunkReader<double>& prices,
+                                                    ChunkReader<int>& signals,
+                                                    double dt_in_years,
+                                                    std::size_t chunk_bars) const
+{
+    if (chunk_bars == 0) {
+        chunk_bars = kDefaultChunkBars;
+    }
+
+    StreamingBacktest state(initial_capital_, transaction_cost_pct_, dt_in_years);
+    for (;;) {
+        ArrayView<const double> price_block = prices.next(chunk_bars);
+        if (price_block.empty()) {
+            break;
+        }
+        ArrayView<const int> signal_block = signals.next(price_block.size());
+        if (signal_block.size() != price_block.size()) {
+            return BacktestResult();
+        }
+        state.on_bars(price_block, signal_block);
+    }
+    if (!signals.next(1).empty()) {
+        return BacktestResult();
+    }
+
+    return chunked_result(state);
+}
+
+BacktestResult BacktestEngine::run_backtest_chunked(ChunkReader<double>& prices,
+                                                    SignalGenerator& generator,
+                                                    double dt_in_years,
+                                                    std::size_t chunk_bars) const
+{
+    if (chunk_bars == 0) {
+        chunk_bars = kDefaultChunkBars;
+    }
+
+    // The signal of bar 0 is ignored by the state, as the engine starts flat.
+    generator.reset();
+    std::vector<int> signal_block(chunk_bars);
+    StreamingBacktest state(initial_capital_, transaction_cost_pct_, dt_in_years);
+    for (;;) {
+        ArrayView<const double> price_block = prices.next(chunk_bars);
+        if (price_block.empty()) {
+            break;
+        }
+        for (std::size_t i = 0; i < price_block.size(); ++i) {
+            signal_block[i] = generator.update(price_block[i]);
+        }
+        state.on_bars(price_block, ArrayView<const int>(signal_block.data(), price_block.size()));
+    }
+
+    return chunked_result(state);
+}
+
+OrderBacktestResult BacktestEngine::run_orders(const OhlcBars& bars,
+                                               ArrayView<const OrderEvent> orders,
+                                               double dt_in_years,
+                                               OutputMask outputs) const
+{
+    OrderBacktestResult out;
+
+    std::size_t n = bars.size();
+    if (n <= 1 || bars.open.size() != n || bars.high.size() != n || bars.low.size() != n) {
+        return out;
+    }
+    for (std::size_t k = 0; k < orders.size(); ++k) {
+        if (!OrderBook::valid(orders[k]) || (k > 0 && orders[k].bar < orders[k - 1].bar)) {
+            return out;
+        }
+    }
+
+    BacktestResult& result = out.backtest;
+    PhaseTimer<> setup_timer(result.profile.setup_ns);
+    double* eq_out = nullptr;
+    double* pnl_out = nullptr;
+    int* pos_out = nullptr;
+    if (has_output(outputs, OutputMask::Equity)) {
+        result.equity_curve.resize(n);
+        eq_out = result.equity_curve.data();
+    }
+    if (has_output(outputs, OutputMask::Pnl)) {
+        result.pnl.resize(n);
+        pnl_out = result.pnl.data();
+    }
+    if (has_output(outputs, OutputMask::Position)) {
+        result.position.resize(n);
+        pos_out = result.position.data();
+    }
+    setup_timer.stop();
+
+    PhaseTimer<> loop_timer(result.profile.loop_ns);
+    const double* close = bars.close.data();
+    double equity = initial_capital_;
+    int position = 0;
+
+    RunningMetrics metrics;
+    metrics.reset(equity);
+    metrics.add_equity(equity);
+    metrics.add_pnl(0.0);
+    if (eq_out) {
+        eq_out[0] = equity;
+    }
+    if (pnl_out) {
+        pnl_out[0] = 0.0;
+    }
+    if (pos_out) {
+        pos_out[0] = position;
+    }
+
+    auto record = [&](std::size_t i, double pnl) {
+        equity += pnl;
+        metrics.add_pnl(pnl);
+        metrics.add_equity(equity);
+        if (eq_out) {
+            eq_out[i] = equity;
+        }
+        if (pnl_out) {
+            pnl_out[i] = pnl;
+        }
+        if (pos_out) {
+            pos_out[i] = position;
+        }
+    };
+
+    OrderBook book;
+    std::size_t next_order = 0;
+    std::size_t i = 1;
+    while (i < n) {
+        while (next_order < orders.size() && orders[next_order].bar <= i) {
+            book.apply(orders[next_order++]);
+        }
+
+        if (book.empty(position)) {
+            // Nothing can fill before the next order event: mark the
+            // stretch [i, end) to market without looking at the bars.
+            std::size_t end = (next_order < orders.size()) ? std::min(orders[next_order].bar, n) : n;
+            if (position != 0) {
+                for (; i < end; ++i) {
+                    record(i, position * (close[i] - close[i - 1]));
+                }
+            } else {
+                metrics.add_pnl_block(end - i, 0.0, 0.0);
+                if (eq_out) {
+                    std::fill(eq_out + i, eq_out + end, equity);
+                }
+                if (pnl_out) {
+                    std::fill(pnl_out + i, pnl_out + end, 0.0);
+                }
+                if (pos_out) {
+                    std::fill(pos_out + i, pos_out + end, 0);
+                }
+                i = end;
+            }
+            continue;
+        }
+
+        OrderFill fill;
+        if (book.trigger(position, bars.open[i], bars.high[i], bars.low[i], fill)) {
+            fill.bar = i;
+            fill.cost = std::abs(fill.to_position - fill.from_position) * fill.price * transaction_cost_pct_;
+            double pnl = position * (fill.price - close[i - 1]) +
+                         fill.to_position * (close[i] - fill.price) - fill.cost;
+            // The other orders of the position just left are cancelled.
+            book.clear(position);
+            position = fill.to_position;
+            out.fills.push_back(fill);
+            record(i, pnl);
+        } else {
+            record(i, position * (close[i] - close[i - 1]));
+        }
+        ++i;
+    }
+    loop_timer.stop();
+
+    result.total_return = (equity / initial_capital_) - 1.0;
+    result.max_drawdown = metrics.max_drawdown;
+    result.sharpe_ratio = metrics.sharpe(dt_in_years);
+    record_profile(result, n, out.fills.size(), vector_bytes(out.fills));
+    return out;
+}
+
+SparseBacktestResult BacktestEngine::run_sparse(const PriceRangeIndex& index,
+                                                ArrayView<const PositionChange> changes,
+                                                double dt_in_years) const
+{
+    SparseBacktestResult result;
+
+    std::size_t n = index.size();
+    if (n <= 1) {
+        return result;
+    }
+    for (std::size_t k = 0; k < changes.size(); ++k) {
+        const PositionChange& c = changes[k];
+        if (c.bar >= n || c.position < -1 || c.position > 1 ||
+            (k > 0 && c.bar <= changes[k - 1].bar)) {
+            return result;
+        }
+    }
+
+    PhaseTimer<> loop_timer(result.profile.loop_ns);
+    ArrayView<const double> prices = index.prices();
+    double equity = initial_capital_;
+    int position = 0;
+    std::uint64_t trades = 0;
+
+    RunningMetrics metrics;
+    metrics.reset(equity);
+    metrics.add_equity(equity);
+    metrics.add_pnl(0.0);
+
+    // Bars [entry, end) held at `position`, entered at `entry` for `cost`
+    // out of equity `before`.
+    auto hold = [&](std::size_t entry, std::size_t end, double before, double cost) {
+        if (end <= entry) {
+            return;
+        }
+        double reference = prices[entry - 1];
+        double count = static_cast<double>(end - entry);
+        double first_move = prices[entry] - reference;
+        double sum = position * (prices[end - 1] - reference) - cost;
+        double sum_sq = position * position * index.sum_sq_moves(entry, end) -
+                        2.0 * position * cost * first_move + cost * cost;
+        double mean = sum / count;
+        metrics.add_pnl_block(end - entry, mean, std::max(sum_sq - sum * mean, 0.0));
+
+        index.fold_drawdown(entry, end, before - cost, position, reference,
+                            metrics.peak, metrics.max_drawdown);
+        equity = before - cost + position * (prices[end - 1] - reference);
+    };
+
+    std::size_t entry = 1;
+    double entry_cost = 0.0;
+    double before = equity;
+    for (std::size_t k = 0; k < changes.size(); ++k) {
+        // A change at bar 0 acts from bar 1, where a change of its own
+        // supersedes it.
+        std::size_t bar = std::max<std::size_t>(changes[k].bar, 1);
+        if (k + 1 < changes.size() && changes[k + 1].bar <= bar) {
+            continue;
+        }
+        int target = changes[k].position;
+        if (target == position) {
+            continue;
+        }
+
+        hold(entry, bar, before, entry_cost);
+
+        double unit_cost = prices[bar] * transaction_cost_pct_;
+        if (position != 0) {
+            TradeRecord& open = result.trades.back();
+            open.exit_bar = bar;
+            open.exit_price = prices[bar - 1];
+            open.cost += std::abs(position) * unit_cost;
+            open.pnl = open.position * (open.exit_price - open.entry_price) - open.cost;
+            open.closed = true;
+        }
+        if (target != 0) {
+            TradeRecord trade;
+            trade.entry_bar = bar;
+            trade.position = target;
+            trade.entry_price = prices[bar - 1];
+            trade.cost = std::abs(target) * unit_cost;
+            result.trades.push_back(trade);
+        }
+
+        entry_cost = std::abs(target - position) * unit_cost;
+        entry = bar;
+        before = equity;
+        position = target;
+        ++trades;
+    }
+    hold(entry, n, before, entry_cost);
+    if (position != 0) {
+        TradeRecord& open = result.trades.back();
+        open.exit_bar = n;
+        open.exit_price = prices[n - 1];
+        open.pnl = open.position * (open.exit_price - open.entry_price) - open.cost;
+    }
+    loop_timer.stop();
+
+    result.total_return = (equity / initial_capital_) - 1.0;
+    result.max_drawdown = metrics.max_drawdown;
+    result.sharpe_ratio = metrics.sharpe(dt_in_years);
+    if constexpr (kProfilingEnabled) {
+        result.profile.bars_processed = n;
+        result.profile.trades = trades;
+        result.profile.runs = 1;
+        result.profile.bytes_allocated = vector_bytes(result.trades);
+    }
+    return result;
+}
+
+SparseBacktestResult BacktestEngine::run_sparse(ArrayView<const double> prices,
+                                                ArrayView<const PositionChange> changes,
+                                                double dt_in_years) const
+{
+    SparseBacktestResult result;
+    std::uint64_t setup_ns = 0;
+    PhaseTimer<> setup_timer(setup_ns);
+    PriceRangeIndex index(prices);
+    setup_timer.stop();
+
+    result = run_sparse(index, changes, dt_in_years);
+    result.profile.setup_ns += setup_ns;
+    return result;
+}
+
+BacktestResult BacktestEngine::run_backtest_vectorized(ArrayView<const double> prices,
+                                                      ArrayView<const int> signals,
+                                                      double dt_in_years,
+                                                      OutputMask outputs,
+                                                      KernelIsa isa) const
+{
+    struct FlatStep {
+        const PnlKernels* kernels;
+        double cost_pct;
+    };
+    const FlatStep flat{&select_pnl_kernels(isa), transaction_cost_pct_};
+
+    auto step = [](const void* context, const double* p, const int* s,
+                   std::size_t begin, std::size_t end, double* out) {
+        const FlatStep& c = *static_cast<const FlatStep*>(context);
+        c.kernels->step_pnl(p, s, begin, end, c.cost_pct, out);
+    };
+    return run_blocked(prices, signals, dt_in_years, outputs, *flat.kernels, step, &flat);
+}
+
+BacktestResult BacktestEngine::run_backtest(ArrayView<const double> prices,
+                                            ArrayView<const int> signals,
+                                            double dt_in_years,
+                                            OutputMask outputs,
+                                            const ExecutionPolicy& policy) const
+{
+    switch (policy.mode) {
+    case ExecutionMode::Vectorized:
+        return run_backtest_vectorized(prices, signals, dt_in_years, outputs, policy.isa);
+    case ExecutionMode::ParallelScan:
+        return run_parallel_scan(prices, signals, dt_in_years, outputs, policy);
+    case ExecutionMode::Sequential:
+    default:
+        return run_backtest(prices, signals, dt_in_years, outputs);
+    }
+}
+
+BacktestResult BacktestEngine::run_parallel_scan(ArrayView<const double> prices,
+                                                 ArrayView<const int> signals,
+                                                 double dt_in_years,
+                                                 OutputMask outputs,
+                                                 const ExecutionPolicy& policy) const
+{
+    BacktestResult result;
+
+    std::size_t n = prices.size();
+    if (n <= 1 || signals.size() != n) {
+        return result;
+    }
+
+    const PnlKernels& kernels = select_pnl_kernels(policy.isa);
+    const bool keep_equity = has_output(outputs, OutputMask::Equity);
+    const bool keep_pnl = has_output(outputs, OutputMask::Pnl);
+    const bool want_stats = has_output(outputs, OutputMask::Stats);
+
+    // Block boundaries depend only on n and block_bars.
+    const std::size_t block = policy.block_bars ? policy.block_bars : kDefaultScanBlockBars;
+    const std::size_t num_blocks = (n + block - 1) / block;
+
+    PhaseTimer<> setup_timer(result.profile.setup_ns);
+    if (keep_pnl) {
+        result.pnl.resize(n);
+    }
+    if (keep_equity) {
+        result.equity_curve.resize(n);
+    }
+    if (has_output(outputs, OutputMask::Position)) {
+        result.position.resize(n);
+    }
+    std::vector<ScanBlock> blocks(num_blocks);
+    setup_timer.stop();
+
+    // Each task walks its block in cache-sized pieces, like run_blocked;
+    // fn(begin, end, pnl, prefix) gets one piece with pnl / prefix pointing
+    // at the kept curves or at scratch.
+    constexpr std::size_t piece = 4096;
+    auto for_each_block = [&](auto&& fn) {
+        auto run = [&](std::size_t first, std::size_t last) {
+            std::vector<double> pnl_scratch(keep_pnl ? 0 : std::min(piece, n));
+            std::vector<double> prefix_scratch(keep_equity ? 0 : std::min(piece, n));
+            for (std::size_t b = first; b < last; ++b) {
+                std::size_t block_end = std::min(n, (b + 1) * block);
+                for (std::size_t begin = b * block; begin < block_end; begin += piece) {
+                    std::size_t end = std::min(block_end, begin + piece);
+                    double* pnl = keep_pnl ? result.pnl.data() + begin : pnl_scratch.data();
+                    double* prefix = keep_equity ? result.equity_curve.data() + begin
+                                                 : prefix_scratch.data();
+                    fn(blocks[b], begin, end, pnl, prefix);
+                }
+            }
+        };
+        if (policy.pool) {
+            policy.pool->parallel_for(num_blocks, 1, run);
+        } else {
+            run(0, num_blocks);
+        }
+    };
+
+    PhaseTimer<> loop_timer(result.profile.loop_ns);
+
+    // Pass 1: step PnL, the block-local prefix sum (kept in equity_curve if
+    // wanted) with its maximum, and the block's PnL moments.
+    for_each_block([&](ScanBlock& sb, std::size_t begin, std::size_t end, double* pnl, double* prefix) {
+        std::size_t count = end - begin;
+        kernels.step_pnl(prices.data(), signals.data(), begin, end, transaction_cost_pct_, pnl);
+        sb.total = kernels.prefix_sum(pnl, count, sb.total, prefix);
+        sb.max_prefix = std::max(sb.max_prefix, max_of(prefix, count));
+        if (want_stats) {
+            double sum = 0.0;
+            double m2 = 0.0;
+            kernels.moments(pnl, count, sum, m2);
+            sb.moments.add_pnl_block(count, sum / static_cast<double>(count), m2);
+        }
+        if (!result.position.empty()) {
+            std::copy(signals.data() + begin, signals.data() + end, result.position.data() + begin);
+        }
+    });
+
+    // Exclusive scans of the block totals (starting equity) and of the
+    // block maxima (starting peak). Rounding is monotonic, so the largest
+    // start + prefix value of a block is start + max_prefix exactly.
+    double equity = initial_capital_;
+    double peak = initial_capital_;
+    for (ScanBlock& sb : blocks) {
+        sb.start_equity = equity;
+        sb.start_peak = peak;
+        peak = std::max(peak, equity + sb.max_prefix);
+        equity += sb.total;
+        sb.total = 0.0;  // reused as the pass-2 prefix carry
+    }
+
+    // Pass 2: equity and drawdown from each block's starting state; the
+    // prefix is recomputed when it was not kept.
+    if (keep_equity || want_stats) {
+        for_each_block([&](ScanBlock& sb, std::size_t begin, std::size_t end, double* pnl, double* prefix) {
+            std::size_t count = end - begin;
+            if (!keep_equity) {
+                if (!keep_pnl) {
+                    kernels.step_pnl(prices.data(), signals.data(), begin, end,
+                                     transaction_cost_pct_, pnl);
+                }
+                sb.total = kernels.prefix_sum(pnl, count, sb.total, prefix);
+            }
+            const double start = sb.start_equity;
+            for (std::size_t k = 0; k < count; ++k) {
+                prefix[k] = start + prefix[k];
+            }
+            if (want_stats) {
+                kernels.drawdown(prefix, count, sb.start_peak, sb.max_drawdown);
+            }
+        });
+    }
+
+    if (!result.position.empty()) {
+        result.position[0] = 0;
+    }
+    if (has_output(outputs, OutputMask::PositionRuns)) {
+        result.position_runs.push_back(PositionRun{0, 0, 0});
+        for (std::size_t i = 1; i < n; ++i) {
+            if (signals[i] != result.position_runs.back().position) {
+                PositionRun& last = result.position_runs.back();
+                last.length = i - last.start;
+                result.position_runs.push_back(PositionRun{i, 0, signals[i]});
+            }
+        }
+        PositionRun& last = result.position_runs.back();
+        last.length = n - last.start;
+    }
+    loop_timer.stop();
+
+    result.total_return = (equity / initial_capital_) - 1.0;
+    if (want_stats) {
+        PhaseTimer<> metrics_timer(result.profile.metrics_ns);
+        RunningMetrics metrics;
+        metrics.reset(initial_capital_);
+        for (const ScanBlock& sb : blocks) {
+            metrics.add_pnl_block(sb.moments.count, sb.moments.mean, sb.moments.m2);
+            metrics.max_drawdown = std::max(metrics.max_drawdown, sb.max_drawdown);
+        }
+        result.max_drawdown = metrics.max_drawdown;
+        result.sharpe_ratio = metrics.sharpe(dt_in_years);
+    }
+
+    std::uint64_t trades = 0;
+    if constexpr (kProfilingEnabled) {
+        int prev = 0;
+        for (std::size_t i = 1; i < n; ++i) {
+            trades += signals[i] != prev ? 1 : 0;
+            prev = signals[i];
+        }
+    }
+    record_profile(result, n, trades, vector_bytes(blocks));
+    return result;
+}
+
+BacktestResult BacktestEngine::run_blocked(ArrayView<const double> prices,
+                                           ArrayView<const int> signals,
+                                           double dt_in_years,
+                                           OutputMask outputs,
+                                           const PnlKernels& kernels,
+                                           StepPnlFn step_pnl,
+                                           const void* context) const
+{
+    BacktestResult result;
+
+    std::size_t n = prices.size();
+    if (n <= 1 || signals.size() != n) {
+        return result;
+    }
+
+    const bool keep_equity = has_output(outputs, OutputMask::Equity);
+    const bool keep_pnl = has_output(outputs, OutputMask::Pnl);
+    const bool want_stats = has_output(outputs, OutputMask::Stats);
+
+    // Blocks small enough that pnl and equity stay in L1/L2 between the
+    // kernels; scratch is only needed for outputs that are not kept.
+    constexpr std::size_t block = 4096;
+    std::vector<double> pnl_scratch;
+    std::vector<double> equity_scratch;
+
+    PhaseTimer<> setup_timer(result.profile.setup_ns);
+    if (keep_pnl) {
+        result.pnl.resize(n);
+    } else {
+        pnl_scratch.resize(std::min(block, n));
+    }
+    if (keep_equity) {
+        result.equity_curve.resize(n);
+    } else {
+        equity_scratch.resize(std::min(block, n));
+    }
+
+    double equity = initial_capital_;
+    RunningMetrics metrics;
+    metrics.reset(equity);
+    setup_timer.stop();
+
+    PhaseTimer<> loop_timer(result.profile.loop_ns);
+    for (std::size_t begin = 0; begin < n; begin += block) {
+        std::size_t end = std::min(n, begin + block);
+        std::size_t count = end - begin;
+
+        double* pnl = keep_pnl ? result.pnl.data() + begin : pnl_scratch.data();
+        double* eq = keep_equity ? result.equity_curve.data() + begin : equity_scratch.data();
+
+        step_pnl(context, prices.data(), signals.data(), begin, end, pnl);
+        equity = kernels.prefix_sum(pnl, count, equity, eq);
+
+        if (want_stats) {
+            kernels.drawdown(eq, count, metrics.peak, metrics.max_drawdown);
+
+            double sum = 0.0;
+            double m2 = 0.0;
+            kernels.moments(pnl, count, sum, m2);
+            metrics.add_pnl_block(count, sum / static_cast<double>(count), m2);
+        }
+    }
+
+    // Positions are the signals themselves (flat at t = 0).
+    if (has_output(outputs, OutputMask::Position)) {
+        result.position.assign(signals.begin(), signals.end());
+        result.position[0] = 0;
+    }
+    if (has_output(outputs, OutputMask::PositionRuns)) {
+        result.position_runs.push_back(PositionRun{0, 0, 0});
+        for (std::size_t i = 1; i < n; ++i) {
+            if (signals[i] != result.position_runs.back().position) {
+                PositionRun& last = result.position_runs.back();
+                last.length = i - last.start;
+                result.position_runs.push_back(PositionRun{i, 0, signals[i]});
+            }
+        }
+        PositionRun& last = result.position_runs.back();
+        last.length = n - last.start;
+    }
+    loop_timer.stop();
+
+    result.total_return = (equity / initial_capital_) - 1.0;
+    if (want_stats) {
+        result.max_drawdown = metrics.max_drawdown;
+        result.sharpe_ratio = metrics.sharpe(dt_in_years);
+    }
+
+    // The kernels do not branch on trades, so they are counted separately
+    // (the position is flat at t = 0, whatever signals[0] says).
+    std::uint64_t trades = 0;
+    if constexpr (kProfilingEnabled) {
+        int prev = 0;
+        for (std::size_t i = 1; i < n; ++i) {
+            trades += signals[i] != prev ? 1 : 0;
+            prev = signals[i];
+        }
+    }
+    record_profile(result, n, trades, vector_bytes(pnl_scratch) + vector_bytes(equity_scratch));
+    return result;
+}
+
+BatchResult BacktestEngine::run_batch(const std::vector<double>& prices,
+                                      const std::vector<int>& signal_matrix,
+                                      double dt_in_years) const
+{
+    return run_batch(ArrayView<const double>(prices),
+                     ArrayView<const int>(signal_matrix),
+                     dt_in_years);
+}
+
+BatchResult BacktestEngine::run_batch(ArrayView<const double> prices,
+                                      ArrayView<const int> signal_matrix,
+                                      double dt_in_years) const
+{
+    // No curves requested, so the null resource is never asked for memory.
+    return run_batch(prices, signal_matrix, dt_in_years, *std::pmr::null_memory_resource(),
+                     OutputMask::None);
+}
+
+BatchResult BacktestEngine::run_batch(ArrayView<const double> prices,
+                                      ArrayView<const int> signal_matrix,
+                                      double dt_in_years,
+                                      std::pmr::memory_resource& curve_memory,
+                                      OutputMask outputs) const
+{
+    BatchResult result;
+
+    std::size_t n = prices.size();
+    if (n <= 1 || signal_matrix.empty() || signal_matrix.size() % n != 0) {
+        return result;
+    }
+
+    std::size_t num_candidates = signal_matrix.size() / n;
+
+    PhaseTimer<> setup_timer(result.profile.setup_ns);
+    allocate_curves(result, num_candidates, n, curve_memory, outputs);
+    PriceMoves moves = precompute_moves(prices);
+    setup_timer.stop();
+
+    run_candidates(moves, signal_matrix, 0, num_candidates, dt_in_years, result, &result.profile);
+
+    if constexpr (kProfilingEnabled) {
+        result.profile.bytes_allocated += vector_bytes(moves.price_change) +
+                                          vector_bytes(moves.unit_cost) +
+                                          3 * num_candidates * sizeof(double);
+    }
+    return result;
+}
+
+template <typename Real, typename PositionT>
+BatchResult BacktestEngine::run_batch_mixed(ArrayView<const double> prices,
+                                            ArrayView<const PositionT> signal_matrix,
+                                            double dt_in_years) const
+{
+    BatchResult result;
+
+    std::size_t n = prices.size();
+    if (n <= 1 || signal_matrix.empty() || signal_matrix.size() % n != 0) {
+        return result;
+    }
+
+    std::size_t num_candidates = signal_matrix.size() / n;
+
+    PhaseTimer<> setup_timer(result.profile.setup_ns);
+    allocate_curves(result, num_candidates, n, *std::pmr::null_memory_resource(), OutputMask::None);
+
+    // The same products as precompute_moves, rounded once to Real.
+    std::vector<Real> price_change(n, Real(0));
+    std::vector<Real> unit_cost(n, Real(0));
+    for (std::size_t i = 1; i < n; ++i) {
+        price_change[i] = static_cast<Real>(prices[i] - prices[i - 1]);
+        unit_cost[i] = static_cast<Real>(prices[i] * transaction_cost_pct_);
+    }
+    setup_timer.stop();
+
+    std::uint64_t trades = 0;
+    PhaseTimer<> loop_timer(result.profile.loop_ns);
+
+    constexpr std::size_t kLanes = 8;
+    Real step[kMixedBlockBars];
+    const Real* dp = price_change.data();
+    const Real* uc = unit_cost.data();
+
+    for (std::size_t k = 0; k < num_candidates; ++k) {
+        const PositionT* signals = signal_matrix.data() + k * n;
+
+        // Bar 0 is flat with zero PnL, as in run_batch.
+        RunningMetrics metrics;
+        metrics.reset(initial_capital_);
+        metrics.add_pnl(0.0);
+        double base = initial_capital_;  // equity at the end of the previous block
+        double peak = initial_capital_;
+        double max_dd = 0.0;
+
+        for (std::size_t start = 1; start < n; start += kMixedBlockBars) {
+            std::size_t len = std::min(kMixedBlockBars, n - start);
+
+            // Step PnL in Real, elementwise so it vectorises. Bar 1 trades
+            // from flat, not from signals[0].
+            for (std::size_t j = 0; j < len; ++j) {
+                std::size_t i = start + j;
+                int prev = (i == 1) ? 0 : static_cast<int>(signals[i - 1]);
+                Real units = static_cast<Real>(std::abs(static_cast<int>(signals[i]) - prev));
+                step[j] = static_cast<Real>(signals[i]) * dp[i] - units * uc[i];
+            }
+            if constexpr (kProfilingEnabled) {
+                for (std::size_t j = 0; j < len; ++j) {
+                    std::size_t i = start + j;
+                    trades += signals[i] != ((i == 1) ? PositionT(0) : signals[i - 1]);
+                }
+            }
+
+            // Two-pass block moments in double over independent lanes.
+            double lane[kLanes] = {};
+            std::size_t j = 0;
+            for (; j + kLanes <= len; j += kLanes) {
+                for (std::size_t l = 0; l < kLanes; ++l) {
+                    lane[l] += static_cast<double>(step[j + l]);
+                }
+            }
+            double sum = 0.0;
+            for (; j < len; ++j) {
+                sum += static_cast<double>(step[j]);
+            }
+            for (double v : lane) {
+                sum += v;
+            }
+            double block_mean = sum / static_cast<double>(len);
+
+            double lane_sq[kLanes] = {};
+            j = 0;
+            for (; j + kLanes <= len; j += kLanes) {
+                for (std::size_t l = 0; l < kLanes; ++l) {
+                    double d = static_cast<double>(step[j + l]) - block_mean;
+                    lane_sq[l] += d * d;
+                }
+            }
+            double block_m2 = 0.0;
+            for (; j < len; ++j) {
+                double d = static_cast<double>(step[j]) - block_mean;
+                block_m2 += d * d;
+            }
+            for (double v : lane_sq) {
+                block_m2 += v;
+            }
+            metrics.add_pnl_block(len, block_mean, block_m2);
+
+            // Equity, peak and drawdown; the division only runs when the
+            // gap may set a new maximum.
+            double local = 0.0;
+            for (j = 0; j < len; ++j) {
+                local += static_cast<double>(step[j]);
+                double equity = base + local;
+                peak = std::max(peak, equity);
+                double gap = peak - equity;
+                if (gap > max_dd * peak) {
+                    max_dd = std::max(max_dd, gap / peak);
+                }
+            }
+            base += local;
+        }
+
+        result.total_return[k] = (base / initial_capital_) - 1.0;
+        result.max_drawdown[k] = max_dd;
+        result.sharpe_ratio[k] = metrics.sharpe(dt_in_years);
+    }
+    loop_timer.stop();
+
+    if constexpr (kProfilingEnabled) {
+        result.profile.trades = trades;
+        result.profile.bars_processed = num_candidates * n;
+        result.profile.runs = num_candidates;
+        result.profile.bytes_allocated += vector_bytes(price_change) + vector_bytes(unit_cost) +
+                                          3 * num_candidates * sizeof(double);
+    }
+    return result;
+}
+
+template BatchResult BacktestEngine::run_batch_mixed<float, std::int8_t>(
+    ArrayView<const double>, ArrayView<const std::int8_t>, double) const;
+template BatchResult BacktestEngine::run_batch_mixed<float, int>(
+    ArrayView<const double>, ArrayView<const int>, double) const;
+template BatchResult BacktestEngine::run_batch_mixed<double, std::int8_t>(
+    ArrayView<const double>, ArrayView<const std::int8_t>, double) const;
+template BatchResult BacktestEngine::run_batch_mixed<double, int>(
+    ArrayView<const double>, ArrayView<const int>, double) const;
+
+PriceMoves BacktestEngine::precompute_moves(ArrayView<const double> prices) const
+{
+    // Shared precomputation: price moves and cost per unit traded.
+    // For |delta pos| <= 2 (the -1/0/+1 convention) the products below are
+    // bit-identical to the ones formed inside run_backtest.
+    std::size_t n = prices.size();
+    PriceMoves moves;
+    moves.price_change.assign(n, 0.0);
+    moves.unit_cost.assign(n, 0.0);
+    for (std::size_t i = 1; i < n; ++i) {
+        moves.price_change[i] = prices[i] - prices[i - 1];
+        moves.unit_cost[i] = prices[i] * transaction_cost_pct_;
+    }
+    return moves;
+}
+
+void BacktestEngine::allocate_curves(BatchResult& out,
+                                     std::size_t num_candidates,
+                                     std::size_t num_steps,
+                                     std::pmr::memory_resource& curve_memory,
+                                     OutputMask outputs) const
+{
+    std::size_t count = num_candidates * num_steps;
+    out.num_candidates = num_candidates;
+    out.num_steps = num_steps;
+    out.total_return.resize(num_candidates);
+    out.max_drawdown.resize(num_candidates);
+    out.sharpe_ratio.resize(num_candidates);
+
+    if (has_output(outputs, OutputMask::Equity)) {
+        void* p = curve_memory.allocate(count * sizeof(double), alignof(double));
+        out.equity_curve = ArrayView<double>(static_cast<double*>(p), count);
+    }
+    if (has_output(outputs, OutputMask::Pnl)) {
+        void* p = curve_memory.allocate(count * sizeof(double), alignof(double));
+        out.pnl = ArrayView<double>(static_cast<double*>(p), count);
+    }
+    if (has_output(outputs, OutputMask::Position)) {
+        void* p = curve_memory.allocate(count * sizeof(int), alignof(int));
+        out.position = ArrayView<int>(static_cast<int*>(p), count);
+    }
+
+    if constexpr (kProfilingEnabled) {
+        out.profile.bytes_allocated += out.equity_curve.size() * sizeof(double) +
+                                       out.pnl.size() * sizeof(double) +
+                                       out.position.size() * sizeof(int);
+    }
+}
+
+void BacktestEngine::run_candidates(const PriceMoves& moves,
+                                    ArrayView<const int> signal_matrix,
+                                    std::size_t begin,
+                                    std::size_t end,
+                                    double dt_in_years,
+                                    BatchResult& out,
+                                    BacktestStats* stats) const
+{
+    if (out.equity_curve.empty() && out.pnl.empty() && out.position.empty()) {
+        run_candidate_range<false>(moves, signal_matrix, begin, end, dt_in_years, out, stats);
+    } else {
+        run_candidate_range<true>(moves, signal_matrix, begin, end, dt_in_years, out, stats);
+    }
+}
+
+template <bool StoreCurves>
+void BacktestEngine::run_candidate_range(const PriceMoves& moves,
+                                         ArrayView<const int> signal_matrix,
+                                         std::size_t begin,
+                                         std::size_t end,
+                                         double dt_in_years,
+                                         BatchResult& out,
+                                         BacktestStats* stats) const
+{
+    std::size_t n = moves.price_change.size();
+    std::uint64_t trades = 0;
+    std::uint64_t loop_ns = 0;
+    PhaseTimer<> loop_timer(loop_ns);
+
+    for (std::size_t k = begin; k < end; ++k) {
+        const int* signals = signal_matrix.data() + k * n;
+
+        // Fused single pass; curves are only written when requested.
+        double equity = initial_capital_;
+        int current_pos = 0;
+
+        double* eq_out = nullptr;
+        double* pnl_out = nullptr;
+        int* pos_out = nullptr;
+        if constexpr (StoreCurves) {
+            eq_out = out.equity_curve.empty() ? nullptr : out.equity_curve.data() + k * n;
+            pnl_out = out.pnl.empty() ? nullptr : out.pnl.data() + k * n;
+            pos_out = out.position.empty() ? nullptr : out.position.data() + k * n;
+            if (eq_out) {
+                eq_out[0] = equity;
+            }
+            if (pnl_out) {
+                pnl_out[0] = 0.0;
+            }
+            if (pos_out) {
+                pos_out[0] = current_pos;
+            }
+        }
+
+        RunningMetrics metrics;
+        metrics.reset(equity);
+        metrics.add_equity(equity);
+        metrics.add_pnl(0.0);
+
+        for (std::size_t i = 1; i < n; ++i) {
+            int desired_pos = signals[i];
+
+            // Branch-free, as in simulate: no trade costs exactly 0.
+            double step_cost = std::abs(desired_pos - current_pos) * moves.unit_cost[i];
+            if constexpr (kProfilingEnabled) {
+                trades += desired_pos != current_pos;
+            }
+            equity -= step_cost;
+            current_pos = desired_pos;
+
+            double step_pnl = current_pos * moves.price_change[i];
+            equity += step_pnl;
+            metrics.add_pnl(-step_cost + step_pnl);
+            metrics.add_equity(equity);
+
+            if constexpr (StoreCurves) {
+                if (eq_out) {
+                    eq_out[i] = equity;
+                }
+                if (pnl_out) {
+                    // Same zero sign as run_backtest's pnl on flat bars.
+                    pnl_out[i] = (0.0 - step_cost) + step_pnl;
+                }
+                if (pos_out) {
+                    pos_out[i] = current_pos;
+                }
+            }
+        }
+
+        out.total_return[k] = (equity / initial_capital_) - 1.0;
+        out.max_drawdown[k] = metrics.max_drawdown;
+        out.sharpe_ratio[k] = metrics.sharpe(dt_in_years);
+    }
+    loop_timer.stop();
+
+    if (stats) {
+        stats->loop_ns += loop_ns;
+        stats->trades += trades;
+        stats->bars_processed += kProfilingEnabled ? (end - begin) * n : 0;
+        stats->runs += kProfilingEnabled ? end - begin : 0;
+    }
+}
+
+double BacktestEngine::compute_max_drawdown(ArrayView<const double> equity) const
 {
     if (equity.empty()) {
         return 0.0;
@@ -94,7 +1427,7 @@ double BacktestEngine::compute_max_drawdown(const std::vector<double>& equity) c
     return max_dd;
 }
 
-double BacktestEngine::compute_sharpe(const std::vector<double>& pnl,
+double BacktestEngine::compute_sharpe(ArrayView<const double> pnl,
                                       double dt_in_years) const
 {
     if (pnl.size() <= 1 || dt_in_years <= 0.0) {
@@ -0,0 +1,161 @@
+#include "Bootstrap.hpp"
+
+#include <algorithm>    // std::max, std::min, std::sort
+#include <cmath>        // std::log1p, std::floor, std::lround
+
+#include "CounterRng.hpp"
+#include "RunningMetrics.hpp"
+
+namespace {
+
+// Quantile of sorted values at probability p with linear interpolation
+// between order statistics (numpy's default method).
+double sorted_quantile(const double* sorted, std::size_t n, double p)
+{
+    if (n == 0) {
+        return 0.0;
+    }
+    double h = (static_cast<double>(n) - 1.0) * std::min(std::max(p, 0.0), 1.0);
+    std::size_t lo = static_cast<std::size_t>(std::floor(h));
+    if (lo + 1 >= n) {
+        return sorted[n - 1];
+    }
+    double frac = h - static_cast<double>(lo);
+    return sorted[lo] + frac * (sorted[lo + 1] - sorted[lo]);
+}
+
+}  // namespace
+
+BootstrapEngine::BootstrapEngine(double initial_capital,
+                                 std::size_t num_resamples,
+                                 double mean_block_length,
+                                 BootstrapMethod method,
+                                 std::uint64_t seed,
+                                 std::size_t num_threads)
+    : initial_capital_(initial_capital),
+      num_resamples_(num_resamples == 0 ? 1 : num_resamples),
+      mean_block_length_(mean_block_length < 1.0 ? 1.0 : mean_block_length),
+      method_(method),
+      seed_(seed),
+      pool_(std::make_unique<ThreadPool>(num_threads)) {}
+
+BootstrapResult BootstrapEngine::run(ArrayView<const double> pnl_matrix,
+                                     std::size_t num_steps,
+                                     double dt_in_years,
+                                     const std::vector<double>& probabilities) const
+{
+    BootstrapResult result;
+
+    std::size_t n = num_steps;
+    if (n <= 1 || pnl_matrix.empty() || pnl_matrix.size() % n != 0) {
+        return result;
+    }
+
+    std::size_t num_configs = pnl_matrix.size() / n;
+    std::size_t num_resamples = num_resamples_;
+    std::size_t num_quantiles = probabilities.size();
+
+    result.num_configs = num_configs;
+    result.num_quantiles = num_quantiles;
+    result.num_resamples = num_resamples;
+    result.probabilities = probabilities;
+
+    // Per-resample statistics; only these scalars are kept, never the series.
+    std::vector<double> sharpe(num_configs * num_resamples);
+    std::vector<double> drawdown(num_configs * num_resamples);
+    std::vector<double> total_return(num_configs * num_resamples);
+
+    const double dn = static_cast<double>(n);
+    const std::size_t fixed_length =
+        static_cast<std::size_t>(std::lround(mean_block_length_));
+    // log(1 - p) for the geometric block lengths of the stationary bootstrap.
+    const double log_continue = std::log1p(-1.0 / mean_block_length_);
+    const bool stationary = method_ == BootstrapMethod::Stationary && mean_block_length_ > 1.0;
+
+    std::size_t total = num_configs * num_resamples;
+    std::size_t grain = std::max<std::size_t>(1, total / (pool_->size() * 8));
+
+    pool_->parallel_for(total, grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t task = begin; task < end; ++task) {
+            std::size_t k = task / num_resamples;
+            std::size_t r = task % num_resamples;
+            const double* pnl = pnl_matrix.data() + k * n;
+
+            CounterRng rng(CounterRng::stream_key(seed_, k, r));
+
+            double equity = initial_capital_;
+            RunningMetrics metrics;
+            metrics.reset(equity);
+
+            std::size_t remaining = n;
+            while (remaining > 0) {
+                std::size_t start = static_cast<std::size_t>(rng.next_double() * dn);
+                if (start >= n) {
+                    start = n - 1;
+                }
+
+                std::size_t length = fixed_length;
+                if (stationary) {
+                    // Geometric(1 / mean) on {1, 2, ...} by inversion.
+                    double u = rng.next_double();
+                    double extra = std::floor(std::log1p(-u) / log_continue);
+                    length = 1 + (extra < dn ? static_cast<std::size_t>(extra) : n);
+                }
+                length = std::min(length, remaining);
+                remaining -= length;
+
+                // One block, split where it wraps past the end of the series.
+                std::size_t first = std::min(length, n - start);
+                for (std::size_t i = start; i < start + first; ++i) {
+                    metrics.add_pnl(pnl[i]);
+                    equity += pnl[i];
+                    metrics.add_equity(equity);
+                }
+                for (std::size_t i = 0; i < length - first; ++i) {
+                    metrics.add_pnl(pnl[i]);
+                    equity += pnl[i];
+                    metrics.add_equity(equity);
+                }
+            }
+
+            sharpe[task] = metrics.sharpe(dt_in_years);
+            drawdown[task] = metrics.max_drawdown;
+            total_return[task] = (equity / initial_capital_) - 1.0;
+        }
+    });
+
+    result.sharpe_ratio.resize(num_configs * num_quantiles);
+    result.max_drawdown.resize(num_configs * num_quantiles);
+    result.total_return.resize(num_configs * num_quantiles);
+    result.sharpe_mean.resize(num_configs);
+    result.max_drawdown_mean.resize(num_configs);
+
+    pool_->parallel_for(num_configs, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t k = begin; k < end; ++k) {
+            double* s = sharpe.data() + k * num_resamples;
+            double* d = drawdown.data() + k * num_resamples;
+            double* t = total_return.data() + k * num_resamples;
+
+            double sum_s = 0.0;
+            double sum_d = 0.0;
+            for (std::size_t r = 0; r < num_resamples; ++r) {
+                sum_s += s[r];
+                sum_d += d[r];
+            }
+            result.sharpe_mean[k] = sum_s / static_cast<double>(num_resamples);
+            result.max_drawdown_mean[k] = sum_d / static_cast<double>(num_resamples);
+
+            std::sort(s, s + num_resamples);
+            std::sort(d, d + num_resamples);
+            std::sort(t, t + num_resamples);
+            for (std::size_t q = 0; q < num_quantiles; ++q) {
+                double p = probabilities[q];
+                result.sharpe_ratio[k * num_quantiles + q] = sorted_quantile(s, num_resamples, p);
+                result.max_drawdown[k * num_quantiles + q] = sorted_quantile(d, num_resamples, p);
+                result.total_return[k * num_quantiles + q] = sorted_quantile(t, num_resamples, p);
+            }
+        }
+    });
+
+    return result;
+}
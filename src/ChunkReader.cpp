@@ -0,0 +1,21 @@
+#include "ChunkReader.hpp"
+
+#include "CsvPriceReader.hpp"
+
+CsvChunkReader::CsvChunkReader(CsvPriceReader& reader, PriceStore::Column column)
+    : reader_(reader), column_(column) {}
+
+ArrayView<const double> CsvChunkReader::next(std::size_t max_items)
+{
+    if (!error_.empty() || max_items == 0 || !reader_.read_rows(rows_, max_items, &error_)) {
+        return ArrayView<const double>();
+    }
+
+    switch (column_) {
+    case PriceStore::Open:     return rows_.open;
+    case PriceStore::High:     return rows_.high;
+    case PriceStore::Low:      return rows_.low;
+    case PriceStore::AdjClose: return rows_.adj_close;
+    default:                   return rows_.close;
+    }
+}
@@ -0,0 +1,333 @@
+#include "ColumnarFile.hpp"
+
+#include <algorithm>    // std::min
+#include <cmath>        // std::isnan
+#include <cstring>      // std::memcpy, std::memcmp
+#include <utility>      // std::move
+
+namespace {
+
+constexpr char kMagic[8] = {'M', 'R', 'T', 'A', 'B', 'L', 'E', '\0'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kHeaderSize = 64;
+constexpr std::size_t kChunkAlign = 64;
+
+constexpr std::uint32_t kPlain = 0;
+constexpr std::uint32_t kConstant = 1;
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t num_columns;
+    std::uint64_t num_rows;
+    std::uint64_t num_row_groups;
+    std::uint64_t footer_offset;
+};
+
+static_assert(sizeof(Header) == 40, "unexpected header padding");
+static_assert(sizeof(Header) <= kHeaderSize, "header does not fit");
+
+void set_error(std::string* error, const std::string& message)
+{
+    if (error) {
+        *error = message;
+    }
+}
+
+// All `rows` 8-byte values at `data` bitwise equal to the first.
+bool all_equal(const void* data, std::size_t rows)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 1; i < rows; ++i) {
+        if (std::memcmp(bytes, bytes + i * 8, 8) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+ColumnChunk ColumnChunk::repeat(std::int64_t value, std::size_t rows)
+{
+    ColumnChunk c{ArrayView<const std::int64_t>()};
+    c.rows = rows;
+    c.repeated = true;
+    c.int_value = value;
+    return c;
+}
+
+ColumnChunk ColumnChunk::repeat(double value, std::size_t rows)
+{
+    ColumnChunk c{ArrayView<const double>()};
+    c.rows = rows;
+    c.repeated = true;
+    c.double_value = value;
+    return c;
+}
+
+ColumnarWriter::~ColumnarWriter()
+{
+    // Without close() the header stays zeroed, so readers reject the file.
+    if (out_.is_open()) {
+        out_.close();
+    }
+}
+
+bool ColumnarWriter::open(const std::string& path, std::vector<ColumnSpec> columns, std::string* error)
+{
+    if (out_.is_open()) {
+        out_.close();
+    }
+    if (columns.empty()) {
+        set_error(error, "a columnar file needs at least one column");
+        return false;
+    }
+
+    out_.open(path, std::ios::binary | std::ios::trunc);
+    if (!out_) {
+        set_error(error, "cannot create " + path);
+        return false;
+    }
+    path_ = path;
+    columns_ = std::move(columns);
+    groups_.clear();
+    num_rows_ = 0;
+    position_ = 0;
+
+    // Zeroed header until close() fills it in.
+    const char header[kHeaderSize] = {};
+    put(header, sizeof(header));
+    if (!out_) {
+        set_error(error, "write failed for " + path_);
+        return false;
+    }
+    return true;
+}
+
+bool ColumnarWriter::write_row_group(const std::vector<ColumnChunk>& chunks, std::string* error)
+{
+    if (!out_.is_open()) {
+        set_error(error, "columnar writer is not open");
+        return false;
+    }
+    if (chunks.size() != columns_.size()) {
+        set_error(error, "row group must have one chunk per column");
+        return false;
+    }
+    std::size_t rows = chunks[0].rows;
+    for (std::size_t c = 0; c < chunks.size(); ++c) {
+        if (chunks[c].rows != rows || chunks[c].type != columns_[c].type ||
+            (!chunks[c].repeated && rows > 0 && !chunks[c].data)) {
+            set_error(error, "chunk for column '" + columns_[c].name + "' has the wrong type or length");
+            return false;
+        }
+    }
+    if (rows == 0) {
+        return true;
+    }
+
+    GroupEntry group;
+    group.rows = rows;
+    group.chunks.resize(chunks.size());
+    for (std::size_t c = 0; c < chunks.size(); ++c) {
+        const ColumnChunk& chunk = chunks[c];
+        pad_to(kChunkAlign);
+        group.chunks[c].offset = position_;
+
+        if (chunk.repeated) {
+            group.chunks[c].encoding = kConstant;
+            if (chunk.type == ColumnType::Int64) {
+                put(&chunk.int_value, 8);
+            } else {
+                put(&chunk.double_value, 8);
+            }
+        } else if (all_equal(chunk.data, rows)) {
+            group.chunks[c].encoding = kConstant;
+            put(chunk.data, 8);
+        } else {
+            group.chunks[c].encoding = kPlain;
+            put(chunk.data, rows * 8);
+        }
+    }
+
+    if (!out_) {
+        set_error(error, "write failed for " + path_);
+        return false;
+    }
+    groups_.push_back(std::move(group));
+    num_rows_ += rows;
+    return true;
+}
+
+bool ColumnarWriter::close(std::string* error)
+{
+    if (!out_.is_open()) {
+        return true;
+    }
+
+    pad_to(8);
+    Header header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.num_columns = static_cast<std::uint32_t>(columns_.size());
+    header.num_rows = num_rows_;
+    header.num_row_groups = groups_.size();
+    header.footer_offset = position_;
+
+    for (const ColumnSpec& column : columns_) {
+        std::uint32_t type = static_cast<std::uint32_t>(column.type);
+        std::uint32_t name_length = static_cast<std::uint32_t>(column.name.size());
+        put(&type, sizeof(type));
+        put(&name_length, sizeof(name_length));
+        put(column.name.data(), column.name.size());
+    }
+    for (const GroupEntry& group : groups_) {
+        put(&group.rows, sizeof(group.rows));
+        for (const ChunkEntry& chunk : group.chunks) {
+            const std::uint32_t reserved = 0;
+            put(&chunk.encoding, sizeof(chunk.encoding));
+            put(&reserved, sizeof(reserved));
+            put(&chunk.offset, sizeof(chunk.offset));
+        }
+    }
+
+    out_.seekp(0);
+    out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    bool ok = static_cast<bool>(out_);
+    out_.close();
+    ok = ok && !out_.fail();
+    if (!ok) {
+        set_error(error, "write failed for " + path_);
+    }
+    return ok;
+}
+
+void ColumnarWriter::pad_to(std::size_t alignment)
+{
+    const char padding[kChunkAlign] = {};
+    std::size_t pad = static_cast<std::size_t>((alignment - position_ % alignment) % alignment);
+    put(padding, pad);
+}
+
+void ColumnarWriter::put(const void* data, std::size_t bytes)
+{
+    out_.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+    position_ += bytes;
+}
+
+bool write_sharpe_panel(const std::string& path,
+                        ArrayView<const std::int64_t> timestamps,
+                        const std::vector<std::size_t>& signal_windows,
+                        const std::vector<RollingSharpePanel>& panels,
+                        std::string* error)
+{
+    if (signal_windows.size() != panels.size()) {
+        set_error(error, "need one panel per signal window");
+        return false;
+    }
+    for (const RollingSharpePanel& panel : panels) {
+        if (panel.num_steps != timestamps.size()) {
+            set_error(error, "panel length does not match the timestamps");
+            return false;
+        }
+    }
+
+    ColumnarWriter writer;
+    if (!writer.open(path, {{"timestamp", ColumnType::Int64},
+                            {"signal_window", ColumnType::Int64},
+                            {"sharpe_window", ColumnType::Int64},
+                            {"rolling_sharpe", ColumnType::Float64}}, error)) {
+        return false;
+    }
+
+    std::vector<std::int64_t> ts;
+    std::vector<double> values;
+    for (std::size_t s = 0; s < panels.size(); ++s) {
+        const RollingSharpePanel& panel = panels[s];
+        for (std::size_t w = 0; w < panel.num_windows; ++w) {
+            const double* row = panel.values.data() + w * panel.num_steps;
+            ts.clear();
+            values.clear();
+            for (std::size_t t = 0; t < panel.num_steps; ++t) {
+                if (!std::isnan(row[t])) {
+                    ts.push_back(timestamps[t]);
+                    values.push_back(row[t]);
+                }
+            }
+            std::size_t rows = ts.size();
+            if (!writer.write_row_group({ArrayView<const std::int64_t>(ts),
+                                         ColumnChunk::repeat(static_cast<std::int64_t>(signal_windows[s]), rows),
+                                         ColumnChunk::repeat(static_cast<std::int64_t>(panel.windows[w]), rows),
+                                         ArrayView<const double>(values)}, error)) {
+                return false;
+            }
+        }
+    }
+    return writer.close(error);
+}
+
+bool write_batch_result(const std::string& path,
+                        const BatchResult& result,
+                        const std::vector<SignalParams>* grid,
+                        std::size_t rows_per_group,
+                        std::string* error)
+{
+    std::size_t n = result.num_candidates;
+    if (grid && grid->size() != n) {
+        set_error(error, "need one SignalParams per candidate");
+        return false;
+    }
+    if (rows_per_group == 0) {
+        rows_per_group = 65536;
+    }
+
+    std::vector<ColumnSpec> columns = {{"candidate", ColumnType::Int64}};
+    if (grid) {
+        columns.push_back({"window", ColumnType::Int64});
+        columns.push_back({"z_entry", ColumnType::Float64});
+        columns.push_back({"z_exit", ColumnType::Float64});
+    }
+    columns.push_back({"total_return", ColumnType::Float64});
+    columns.push_back({"max_drawdown", ColumnType::Float64});
+    columns.push_back({"sharpe_ratio", ColumnType::Float64});
+
+    ColumnarWriter writer;
+    if (!writer.open(path, std::move(columns), error)) {
+        return false;
+    }
+
+    std::vector<std::int64_t> candidate, window;
+    std::vector<double> z_entry, z_exit;
+    for (std::size_t begin = 0; begin < n; begin += rows_per_group) {
+        std::size_t rows = std::min(rows_per_group, n - begin);
+        candidate.resize(rows);
+        for (std::size_t k = 0; k < rows; ++k) {
+            candidate[k] = static_cast<std::int64_t>(begin + k);
+        }
+
+        std::vector<ColumnChunk> chunks = {ArrayView<const std::int64_t>(candidate)};
+        if (grid) {
+            window.resize(rows);
+            z_entry.resize(rows);
+            z_exit.resize(rows);
+            for (std::size_t k = 0; k < rows; ++k) {
+                const SignalParams& p = (*grid)[begin + k];
+                window[k] = static_cast<std::int64_t>(p.window);
+                z_entry[k] = p.z_entry;
+                z_exit[k] = p.z_exit;
+            }
+            chunks.push_back(ArrayView<const std::int64_t>(window));
+            chunks.push_back(ArrayView<const double>(z_entry));
+            chunks.push_back(ArrayView<const double>(z_exit));
+        }
+        chunks.push_back(ArrayView<const double>(result.total_return.data() + begin, rows));
+        chunks.push_back(ArrayView<const double>(result.max_drawdown.data() + begin, rows));
+        chunks.push_back(ArrayView<const double>(result.sharpe_ratio.data() + begin, rows));
+
+        if (!writer.write_row_group(chunks, error)) {
+            return false;
+        }
+    }
+    return writer.close(error);
+}
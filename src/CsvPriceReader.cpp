@@ -0,0 +1,446 @@
+#include "CsvPriceReader.hpp"
+
+#include <algorithm>    // std::max, std::fill
+#include <cerrno>
+#include <cmath>        // std::isnan
+#include <cstdlib>      // std::strtod
+#include <cstring>      // std::memchr, std::memmove, std::memcpy
+#include <limits>
+
+namespace {
+
+void set_error(std::string* error, const std::string& message)
+{
+    if (error) {
+        *error = message;
+    }
+}
+
+// Days since 1970-01-01 for a proleptic Gregorian date (H. Hinnant).
+std::int64_t days_from_civil(std::int64_t y, unsigned m, unsigned d)
+{
+    y -= m <= 2;
+    std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = static_cast<unsigned>(y - era * 400);
+    unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<std::int64_t>(doe) - 719468;
+}
+
+bool parse_digits(const char*& p, const char* end, int count, int& value)
+{
+    value = 0;
+    for (int k = 0; k < count; ++k) {
+        if (p == end || *p < '0' || *p > '9') {
+            return false;
+        }
+        value = value * 10 + (*p - '0');
+        ++p;
+    }
+    return true;
+}
+
+// Exactly representable powers of ten.
+constexpr double kPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                             1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                             1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+bool strtod_field(const char* begin, const char* end, double& out)
+{
+    std::string field(begin, end);
+    char* stop = nullptr;
+    errno = 0;
+    out = std::strtod(field.c_str(), &stop);
+    return stop == field.c_str() + field.size() && errno != ERANGE;
+}
+
+}  // namespace
+
+bool parse_csv_timestamp(const char* p, const char* end, std::int64_t& out)
+{
+    int y, mo, d;
+    if (!parse_digits(p, end, 4, y) || p == end || *p++ != '-' ||
+        !parse_digits(p, end, 2, mo) || p == end || *p++ != '-' ||
+        !parse_digits(p, end, 2, d) || mo < 1 || mo > 12 || d < 1 || d > 31) {
+        return false;
+    }
+
+    std::int64_t seconds = days_from_civil(y, static_cast<unsigned>(mo), static_cast<unsigned>(d)) * 86400;
+
+    if (p != end && (*p == ' ' || *p == 'T')) {
+        ++p;
+        int hh, mm, ss = 0;
+        if (!parse_digits(p, end, 2, hh) || p == end || *p++ != ':' || !parse_digits(p, end, 2, mm)) {
+            return false;
+        }
+        if (p != end && *p == ':') {
+            ++p;
+            if (!parse_digits(p, end, 2, ss)) {
+                return false;
+            }
+            if (p != end && *p == '.') {
+                ++p;
+                while (p != end && *p >= '0' && *p <= '9') {
+                    ++p;
+                }
+            }
+        }
+        seconds += hh * 3600 + mm * 60 + ss;
+
+        if (p != end && (*p == '+' || *p == '-')) {
+            int sign = (*p++ == '+') ? 1 : -1;
+            int oh, om = 0;
+            if (!parse_digits(p, end, 2, oh)) {
+                return false;
+            }
+            if (p != end && *p == ':') {
+                ++p;
+            }
+            if (p != end && !parse_digits(p, end, 2, om)) {
+                return false;
+            }
+            seconds -= sign * (oh * 3600 + om * 60);
+        } else if (p != end && *p == 'Z') {
+            ++p;
+        }
+    }
+
+    if (p != end) {
+        return false;
+    }
+    out = seconds;
+    return true;
+}
+
+bool parse_csv_double(const char* begin, const char* end, double& out)
+{
+    if (begin == end) {
+        return false;
+    }
+
+    // Fast path: m * 10^e with m < 2^53 and |e| <= 22 is exact in both
+    // factors, so one multiply or divide gives the correctly rounded value.
+    const char* p = begin;
+    bool negative = false;
+    if (*p == '-' || *p == '+') {
+        negative = *p == '-';
+        ++p;
+    }
+    if (end - p >= 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+        // Hex float: its leading 0 would otherwise stop the decimal parse.
+        return strtod_field(begin, end, out);
+    }
+
+    std::uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any_digit = false;
+    while (p != end && *p >= '0' && *p <= '9') {
+        if (mantissa != 0 || *p != '0') {
+            ++digits;
+        }
+        mantissa = mantissa * 10 + static_cast<std::uint64_t>(*p - '0');
+        any_digit = true;
+        ++p;
+        if (digits > 19) {
+            return strtod_field(begin, end, out);
+        }
+    }
+    if (p != end && *p == '.') {
+        ++p;
+        while (p != end && *p >= '0' && *p <= '9') {
+            if (mantissa != 0 || *p != '0') {
+                ++digits;
+            }
+            mantissa = mantissa * 10 + static_cast<std::uint64_t>(*p - '0');
+            --exponent;
+            any_digit = true;
+            ++p;
+            if (digits > 19) {
+                return strtod_field(begin, end, out);
+            }
+        }
+    }
+    if (!any_digit) {
+        // "nan", "inf", ...
+        return strtod_field(begin, end, out);
+    }
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool exp_negative = false;
+        if (p != end && (*p == '-' || *p == '+')) {
+            exp_negative = *p == '-';
+            ++p;
+        }
+        if (p == end) {
+            return false;
+        }
+        int e = 0;
+        while (p != end && *p >= '0' && *p <= '9') {
+            if (e < 100000) {
+                e = e * 10 + (*p - '0');
+            }
+            ++p;
+        }
+        exponent += exp_negative ? -e : e;
+    }
+    if (p != end) {
+        return false;
+    }
+
+    constexpr std::uint64_t kMaxExact = std::uint64_t(1) << 53;
+    if (mantissa > kMaxExact || exponent < -22 || exponent > 22) {
+        return strtod_field(begin, end, out);
+    }
+    double value = static_cast<double>(mantissa);
+    value = exponent < 0 ? value / kPow10[-exponent] : value * kPow10[exponent];
+    out = negative ? -value : value;
+    return true;
+}
+
+CsvPriceReader::CsvPriceReader(std::size_t buffer_bytes)
+    : buffer_(std::max<std::size_t>(buffer_bytes, 4096)) {}
+
+CsvPriceReader::~CsvPriceReader()
+{
+    close();
+}
+
+bool CsvPriceReader::open(const std::string& path, std::string* error)
+{
+    close();
+    file_ = std::fopen(path.c_str(), "rb");
+    if (!file_) {
+        set_error(error, "cannot open " + path);
+        return false;
+    }
+    path_ = path;
+
+    const char* line;
+    const char* line_end;
+    std::string read_error;
+    if (!next_line(line, line_end, &read_error)) {
+        set_error(error, read_error.empty() ? path + ": empty file" : read_error);
+        close();
+        return false;
+    }
+    if (!parse_header(line, line_end)) {
+        set_error(error, path + ": 'Close' column not found");
+        close();
+        return false;
+    }
+    return true;
+}
+
+void CsvPriceReader::close()
+{
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+    begin_ = 0;
+    end_ = 0;
+    eof_ = false;
+    rows_read_ = 0;
+    rows_skipped_ = 0;
+}
+
+bool CsvPriceReader::has_column(PriceStore::Column c) const
+{
+    return c == PriceStore::Timestamp || (c < PriceStore::NumColumns && col_[c] != kMissing);
+}
+
+bool CsvPriceReader::fill(std::string* error)
+{
+    // Keep the unparsed tail, growing the buffer if one line fills it.
+    std::size_t tail = end_ - begin_;
+    if (begin_ > 0) {
+        std::memmove(buffer_.data(), buffer_.data() + begin_, tail);
+    } else if (tail == buffer_.size()) {
+        buffer_.resize(buffer_.size() * 2);
+    }
+    begin_ = 0;
+    end_ = tail;
+
+    std::size_t got = std::fread(buffer_.data() + end_, 1, buffer_.size() - end_, file_);
+    end_ += got;
+    if (got == 0) {
+        if (std::ferror(file_)) {
+            set_error(error, path_ + ": read error");
+            return false;
+        }
+        eof_ = true;
+    }
+    return true;
+}
+
+bool CsvPriceReader::next_line(const char*& line, const char*& line_end, std::string* error)
+{
+    for (;;) {
+        const char* start = buffer_.data() + begin_;
+        const char* stop = buffer_.data() + end_;
+        const char* nl = static_cast<const char*>(std::memchr(start, '\n', static_cast<std::size_t>(stop - start)));
+
+        if (nl || (eof_ && start != stop)) {
+            const char* last = nl ? nl : stop;
+            begin_ = static_cast<std::size_t>(last - buffer_.data()) + (nl ? 1 : 0);
+            if (last != start && last[-1] == '\r') {
+                --last;
+            }
+            line = start;
+            line_end = last;
+            return true;
+        }
+        if (eof_) {
+            return false;
+        }
+        if (!fill(error)) {
+            return false;
+        }
+    }
+}
+
+bool CsvPriceReader::parse_header(const char* line, const char* line_end)
+{
+    // Column lookup; yfinance puts the dates under "Price" in column 0.
+    date_col_ = 0;
+    std::fill(std::begin(col_), std::end(col_), kMissing);
+
+    std::size_t index = 0;
+    const char* field = line;
+    for (const char* p = line;; ++p) {
+        if (p == line_end || *p == ',') {
+            std::string name(field, p);
+            if (name == "Date" || name == "Datetime") {
+                date_col_ = index;
+            } else if (name == "Open") {
+                col_[PriceStore::Open] = index;
+            } else if (name == "High") {
+                col_[PriceStore::High] = index;
+            } else if (name == "Low") {
+                col_[PriceStore::Low] = index;
+            } else if (name == "Close") {
+                col_[PriceStore::Close] = index;
+            } else if (name == "Adj Close") {
+                col_[PriceStore::AdjClose] = index;
+            } else if (name == "Volume") {
+                col_[PriceStore::Volume] = index;
+            }
+            ++index;
+            field = p + 1;
+            if (p == line_end) {
+                break;
+            }
+        }
+    }
+
+    if (col_[PriceStore::Close] == kMissing) {
+        return false;
+    }
+    num_needed_ = std::max(date_col_, col_[PriceStore::Close]) + 1;
+    std::size_t last_used = date_col_;
+    for (std::size_t c = PriceStore::Open; c < PriceStore::NumColumns; ++c) {
+        if (col_[c] != kMissing) {
+            last_used = std::max(last_used, col_[c]);
+        }
+    }
+    field_starts_.resize(last_used + 1);
+    field_stops_.resize(last_used + 1);
+    return true;
+}
+
+bool CsvPriceReader::parse_record(const char* line, const char* line_end, PriceColumns& out)
+{
+    // Boundaries of the fields up to the last column in use.
+    const char** starts = field_starts_.data();
+    const char** stops = field_stops_.data();
+    std::size_t max_fields = field_starts_.size();
+    std::size_t count = 0;
+
+    const char* field = line;
+    for (const char* p = line; count < max_fields; ++p) {
+        if (p == line_end || *p == ',') {
+            starts[count] = field;
+            stops[count] = p;
+            ++count;
+            field = p + 1;
+            if (p == line_end) {
+                break;
+            }
+        }
+    }
+    if (count < num_needed_) {
+        return false;
+    }
+
+    std::int64_t ts;
+    double close;
+    std::size_t c_close = col_[PriceStore::Close];
+    if (!parse_csv_timestamp(starts[date_col_], stops[date_col_], ts) ||
+        !parse_csv_double(starts[c_close], stops[c_close], close) || std::isnan(close)) {
+        // As dropna(subset=["Close"]): a literal "nan" parses but is still
+        // missing (inf is kept, as in pandas).
+        return false;
+    }
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    auto field_or_nan = [&](PriceStore::Column c) {
+        double v;
+        std::size_t i = col_[c];
+        if (i == kMissing || i >= count || !parse_csv_double(starts[i], stops[i], v)) {
+            return nan;
+        }
+        return v;
+    };
+
+    // Non-finite or out-of-range volumes count as missing; the cast would
+    // be undefined. 2^63 is exact in double and the first value past the
+    // int64 range.
+    double volume = field_or_nan(PriceStore::Volume);
+    if (!(volume >= -9223372036854775808.0 && volume < 9223372036854775808.0)) {
+        volume = nan;
+    }
+    out.timestamp.push_back(ts);
+    out.open.push_back(field_or_nan(PriceStore::Open));
+    out.high.push_back(field_or_nan(PriceStore::High));
+    out.low.push_back(field_or_nan(PriceStore::Low));
+    out.close.push_back(close);
+    out.adj_close.push_back(field_or_nan(PriceStore::AdjClose));
+    out.volume.push_back(std::isnan(volume) ? 0 : static_cast<std::int64_t>(volume));
+    return true;
+}
+
+bool CsvPriceReader::read_rows(PriceColumns& out, std::size_t max_rows, std::string* error)
+{
+    out.timestamp.clear();
+    out.open.clear();
+    out.high.clear();
+    out.low.clear();
+    out.close.clear();
+    out.adj_close.clear();
+    out.volume.clear();
+
+    if (!file_) {
+        set_error(error, "no file open");
+        return false;
+    }
+
+    const char* line;
+    const char* line_end;
+    while (out.size() < max_rows) {
+        std::string read_error;
+        if (!next_line(line, line_end, &read_error)) {
+            if (!read_error.empty()) {
+                set_error(error, read_error);
+                return false;
+            }
+            break;
+        }
+        if (parse_record(line, line_end, out)) {
+            ++rows_read_;
+        } else {
+            ++rows_skipped_;
+        }
+    }
+    return true;
+}
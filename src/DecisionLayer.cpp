@@ -0,0 +1,194 @@
+#include "DecisionLayer.hpp"
+
+#include <algorithm>    // std::nth_element, std::max_element
+#include <cmath>        // std::isnan
+#include <limits>
+
+namespace {
+
+// Median of the non-NaN values among values[0], values[stride], ...,
+// values[(count - 1) * stride], as pandas' median(skipna=True). `scratch`
+// must hold `count` doubles.
+double nan_median(const double* values, std::size_t count, std::size_t stride, double* scratch)
+{
+    std::size_t m = 0;
+    for (std::size_t h = 0; h < count; ++h) {
+        double v = values[h * stride];
+        if (!std::isnan(v)) {
+            scratch[m++] = v;
+        }
+    }
+    if (m == 0) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    std::size_t mid = m / 2;
+    std::nth_element(scratch, scratch + mid, scratch + m);
+    double upper = scratch[mid];
+    if (m % 2 == 1) {
+        return upper;
+    }
+    // Lower middle is the largest value left of the partition point.
+    double lower = *std::max_element(scratch, scratch + mid);
+    return (lower + upper) / 2.0;
+}
+
+}  // namespace
+
+double risk_mode_multiplier(RiskMode mode)
+{
+    switch (mode) {
+        case RiskMode::Stop:
+            return 0.0;
+        case RiskMode::Reduce:
+            return 0.5;
+        case RiskMode::Normal:
+        default:
+            return 1.0;
+    }
+}
+
+const char* risk_mode_name(RiskMode mode)
+{
+    switch (mode) {
+        case RiskMode::Stop:
+            return "STOP";
+        case RiskMode::Reduce:
+            return "REDUCE";
+        case RiskMode::Normal:
+        default:
+            return "NORMAL";
+    }
+}
+
+DecisionLayer::DecisionLayer(double warn_sharpe,
+                             double stop_sharpe,
+                             double frac_warn,
+                             double frac_stop)
+    : warn_sharpe_(warn_sharpe),
+      stop_sharpe_(stop_sharpe),
+      frac_warn_(frac_warn),
+      frac_stop_(frac_stop) {}
+
+Decision DecisionLayer::classify(std::size_t below_warn,
+                                 std::size_t below_stop,
+                                 std::size_t num_signal_windows) const
+{
+    Decision d;
+    if (num_signal_windows == 0) {
+        // Mean of an empty selection is NaN in pandas; no threshold fires.
+        d.frac_below_warn = std::numeric_limits<double>::quiet_NaN();
+        d.frac_below_stop = std::numeric_limits<double>::quiet_NaN();
+        return d;
+    }
+
+    double n = static_cast<double>(num_signal_windows);
+    d.frac_below_warn = static_cast<double>(below_warn) / n;
+    d.frac_below_stop = static_cast<double>(below_stop) / n;
+
+    if (d.frac_below_stop >= frac_stop_) {
+        d.risk_mode = RiskMode::Stop;
+    } else if (d.frac_below_warn >= frac_warn_) {
+        d.risk_mode = RiskMode::Reduce;
+    } else {
+        d.risk_mode = RiskMode::Normal;
+    }
+    d.position_multiplier = risk_mode_multiplier(d.risk_mode);
+    return d;
+}
+
+Decision DecisionLayer::decide(ArrayView<const double> snapshot,
+                               std::size_t num_signal_windows) const
+{
+    if (num_signal_windows == 0 || snapshot.size() % num_signal_windows != 0) {
+        return classify(0, 0, 0);
+    }
+    std::size_t num_sharpe_windows = snapshot.size() / num_signal_windows;
+
+    std::vector<double> scratch(num_sharpe_windows);
+    std::size_t below_warn = 0;
+    std::size_t below_stop = 0;
+    for (std::size_t s = 0; s < num_signal_windows; ++s) {
+        double score = nan_median(snapshot.data() + s * num_sharpe_windows,
+                                  num_sharpe_windows, 1, scratch.data());
+        below_warn += (score < warn_sharpe_);
+        below_stop += (score < stop_sharpe_);
+    }
+    return classify(below_warn, below_stop, num_signal_windows);
+}
+
+template <typename RowFn>
+DecisionSeries DecisionLayer::evaluate_impl(RowFn&& row_at,
+                                            std::size_t num_signal_windows,
+                                            std::size_t num_sharpe_windows,
+                                            std::size_t num_steps) const
+{
+    DecisionSeries out;
+    out.num_signal_windows = num_signal_windows;
+    out.num_steps = num_steps;
+    out.scores.resize(num_signal_windows * num_steps);
+
+    // Per-bar counts, accumulated one signal window at a time so every
+    // pass over the grid and the outputs is sequential in time.
+    std::vector<std::size_t> below_warn(num_steps, 0);
+    std::vector<std::size_t> below_stop(num_steps, 0);
+    std::vector<double> scratch(num_sharpe_windows);
+
+    for (std::size_t s = 0; s < num_signal_windows; ++s) {
+        double* scores = out.scores.data() + s * num_steps;
+        for (std::size_t t = 0; t < num_steps; ++t) {
+            // Sharpe window h of signal window s at bar t is row_at(s)[h * T + t].
+            double score = nan_median(row_at(s) + t, num_sharpe_windows, num_steps,
+                                      scratch.data());
+            scores[t] = score;
+            below_warn[t] += (score < warn_sharpe_);
+            below_stop[t] += (score < stop_sharpe_);
+        }
+    }
+
+    out.risk_mode.resize(num_steps);
+    out.position_multiplier.resize(num_steps);
+    out.frac_below_warn.resize(num_steps);
+    out.frac_below_stop.resize(num_steps);
+    for (std::size_t t = 0; t < num_steps; ++t) {
+        Decision d = classify(below_warn[t], below_stop[t], num_signal_windows);
+        out.risk_mode[t] = static_cast<std::int8_t>(d.risk_mode);
+        out.position_multiplier[t] = d.position_multiplier;
+        out.frac_below_warn[t] = d.frac_below_warn;
+        out.frac_below_stop[t] = d.frac_below_stop;
+    }
+    return out;
+}
+
+DecisionSeries DecisionLayer::evaluate(ArrayView<const double> grid,
+                                       std::size_t num_signal_windows,
+                                       std::size_t num_sharpe_windows) const
+{
+    std::size_t per_step = num_signal_windows * num_sharpe_windows;
+    if (per_step == 0 || grid.size() % per_step != 0) {
+        return DecisionSeries();
+    }
+    std::size_t num_steps = grid.size() / per_step;
+    std::size_t block = num_sharpe_windows * num_steps;
+
+    return evaluate_impl([&](std::size_t s) { return grid.data() + s * block; },
+                         num_signal_windows, num_sharpe_windows, num_steps);
+}
+
+DecisionSeries DecisionLayer::evaluate(const std::vector<RollingSharpePanel>& panels) const
+{
+    if (panels.empty()) {
+        return DecisionSeries();
+    }
+    std::size_t num_sharpe_windows = panels[0].num_windows;
+    std::size_t num_steps = panels[0].num_steps;
+    for (const RollingSharpePanel& p : panels) {
+        if (p.num_windows != num_sharpe_windows || p.num_steps != num_steps ||
+            p.values.size() != num_sharpe_windows * num_steps) {
+            return DecisionSeries();
+        }
+    }
+
+    return evaluate_impl([&](std::size_t s) { return panels[s].values.data(); },
+                         panels.size(), num_sharpe_windows, num_steps);
+}
@@ -0,0 +1,519 @@
+#include "PnlKernels.hpp"
+
+#include <algorithm>    // std::max
+#include <cstdlib>      // std::abs(int)
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PNL_KERNELS_X86 1
+#include <immintrin.h>
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx512f")))
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define PNL_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// =========================
+// Scalar reference kernels
+// =========================
+
+// Same expression (and operation order) as the engine loop.
+inline double step_pnl_at(const double* prices, const int* signals, std::size_t i, double cost_pct)
+{
+    if (i == 0) {
+        return 0.0;
+    }
+    int prev = (i == 1) ? 0 : signals[i - 1];
+    int cur = signals[i];
+    double cost = std::abs(cur - prev) * prices[i] * cost_pct;
+    return (0.0 - cost) + cur * (prices[i] - prices[i - 1]);
+}
+
+void step_pnl_scalar(const double* prices, const int* signals,
+                     std::size_t begin, std::size_t end,
+                     double cost_pct, double* out)
+{
+    for (std::size_t i = begin; i < end; ++i) {
+        out[i - begin] = step_pnl_at(prices, signals, i, cost_pct);
+    }
+}
+
+double prefix_sum_scalar(const double* x, std::size_t count, double carry, double* out)
+{
+    for (std::size_t k = 0; k < count; ++k) {
+        carry += x[k];
+        out[k] = carry;
+    }
+    return carry;
+}
+
+void drawdown_scalar(const double* equity, std::size_t count,
+                     double& peak, double& max_drawdown)
+{
+    for (std::size_t k = 0; k < count; ++k) {
+        double e = equity[k];
+        if (e > peak) {
+            peak = e;
+        }
+        double dd = (peak - e) / peak;
+        if (dd > max_drawdown) {
+            max_drawdown = dd;
+        }
+    }
+}
+
+void moments_scalar(const double* x, std::size_t count, double& sum, double& m2)
+{
+    sum = 0.0;
+    m2 = 0.0;
+    if (count == 0) {
+        return;
+    }
+    for (std::size_t k = 0; k < count; ++k) {
+        sum += x[k];
+    }
+    double mean = sum / static_cast<double>(count);
+    for (std::size_t k = 0; k < count; ++k) {
+        double d = x[k] - mean;
+        m2 += d * d;
+    }
+}
+
+const PnlKernels kScalarKernels = {
+    KernelIsa::Scalar, step_pnl_scalar, prefix_sum_scalar, drawdown_scalar, moments_scalar};
+
+#if defined(PNL_KERNELS_X86)
+
+// =========================
+// AVX2 (4 x double)
+// =========================
+
+TARGET_AVX2 inline double hsum_avx2(__m256d v)
+{
+    __m128d lo = _mm256_castpd256_pd128(v);
+    __m128d hi = _mm256_extractf128_pd(v, 1);
+    lo = _mm_add_pd(lo, hi);
+    return _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+}
+
+TARGET_AVX2 inline double hmax_avx2(__m256d v)
+{
+    __m128d lo = _mm256_castpd256_pd128(v);
+    __m128d hi = _mm256_extractf128_pd(v, 1);
+    lo = _mm_max_pd(lo, hi);
+    return _mm_cvtsd_f64(_mm_max_sd(lo, _mm_unpackhi_pd(lo, lo)));
+}
+
+TARGET_AVX2 void step_pnl_avx2(const double* prices, const int* signals,
+                               std::size_t begin, std::size_t end,
+                               double cost_pct, double* out)
+{
+    std::size_t i = begin;
+    for (; i < end && i < 2; ++i) {
+        out[i - begin] = step_pnl_at(prices, signals, i, cost_pct);
+    }
+
+    const __m256d vcost = _mm256_set1_pd(cost_pct);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    for (; i + 4 <= end; i += 4) {
+        __m256d cur = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(signals + i)));
+        __m256d prev = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(signals + i - 1)));
+        __m256d p = _mm256_loadu_pd(prices + i);
+        __m256d dp = _mm256_sub_pd(p, _mm256_loadu_pd(prices + i - 1));
+        __m256d dq = _mm256_andnot_pd(sign, _mm256_sub_pd(cur, prev));
+        __m256d cost = _mm256_mul_pd(_mm256_mul_pd(dq, p), vcost);
+        _mm256_storeu_pd(out + (i - begin), _mm256_add_pd(_mm256_sub_pd(zero, cost), _mm256_mul_pd(cur, dp)));
+    }
+
+    for (; i < end; ++i) {
+        out[i - begin] = step_pnl_at(prices, signals, i, cost_pct);
+    }
+}
+
+// In-register inclusive scan of four lanes, then add the running carry.
+TARGET_AVX2 double prefix_sum_avx2(const double* x, std::size_t count, double carry, double* out)
+{
+    const __m256d zero = _mm256_setzero_pd();
+    __m256d vcarry = _mm256_set1_pd(carry);
+
+    std::size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        __m256d v = _mm256_loadu_pd(x + k);
+        // [a, b, c, d] -> [a, a+b, b+c, c+d]
+        __m256d s1 = _mm256_blend_pd(_mm256_permute4x64_pd(v, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x1);
+        v = _mm256_add_pd(v, s1);
+        // -> [a, a+b, a+b+c, a+b+c+d]
+        v = _mm256_add_pd(v, _mm256_permute2f128_pd(v, v, 0x08));
+        v = _mm256_add_pd(v, vcarry);
+        _mm256_storeu_pd(out + k, v);
+        vcarry = _mm256_permute4x64_pd(v, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+
+    carry = _mm256_cvtsd_f64(vcarry);
+    return prefix_sum_scalar(x + k, count - k, carry, out + k);
+}
+
+TARGET_AVX2 void drawdown_avx2(const double* equity, std::size_t count,
+                               double& peak, double& max_drawdown)
+{
+    __m256d vpeak = _mm256_set1_pd(peak);
+    __m256d vdd = _mm256_set1_pd(max_drawdown);
+
+    std::size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        __m256d e = _mm256_loadu_pd(equity + k);
+        // Running max within the vector (max is idempotent, so lanes can
+        // be duplicated instead of zero-filled).
+        __m256d m = _mm256_max_pd(e, _mm256_permute4x64_pd(e, _MM_SHUFFLE(2, 1, 0, 0)));
+        m = _mm256_max_pd(m, _mm256_permute2f128_pd(m, m, 0x00));
+        m = _mm256_max_pd(m, vpeak);
+        __m256d dd = _mm256_div_pd(_mm256_sub_pd(m, e), m);
+        vdd = _mm256_max_pd(vdd, dd);
+        vpeak = _mm256_permute4x64_pd(m, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+
+    peak = _mm256_cvtsd_f64(vpeak);
+    max_drawdown = hmax_avx2(vdd);
+    drawdown_scalar(equity + k, count - k, peak, max_drawdown);
+}
+
+TARGET_AVX2 void moments_avx2(const double* x, std::size_t count, double& sum, double& m2)
+{
+    sum = 0.0;
+    m2 = 0.0;
+    if (count == 0) {
+        return;
+    }
+
+    __m256d acc = _mm256_setzero_pd();
+    std::size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        acc = _mm256_add_pd(acc, _mm256_loadu_pd(x + k));
+    }
+    sum = hsum_avx2(acc);
+    for (std::size_t j = k; j < count; ++j) {
+        sum += x[j];
+    }
+
+    double mean = sum / static_cast<double>(count);
+    const __m256d vmean = _mm256_set1_pd(mean);
+    acc = _mm256_setzero_pd();
+    for (k = 0; k + 4 <= count; k += 4) {
+        __m256d d = _mm256_sub_pd(_mm256_loadu_pd(x + k), vmean);
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(d, d));
+    }
+    m2 = hsum_avx2(acc);
+    for (std::size_t j = k; j < count; ++j) {
+        double d = x[j] - mean;
+        m2 += d * d;
+    }
+}
+
+const PnlKernels kAvx2Kernels = {
+    KernelIsa::Avx2, step_pnl_avx2, prefix_sum_avx2, drawdown_avx2, moments_avx2};
+
+// =========================
+// AVX-512 (8 x double)
+// =========================
+
+// GCC 12 reports the _mm512_undefined_pd() placeholders inside its own
+// intrinsic headers as uninitialised reads.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+TARGET_AVX512 void step_pnl_avx512(const double* prices, const int* signals,
+                                   std::size_t begin, std::size_t end,
+                                   double cost_pct, double* out)
+{
+    std::size_t i = begin;
+    for (; i < end && i < 2; ++i) {
+        out[i - begin] = step_pnl_at(prices, signals, i, cost_pct);
+    }
+
+    const __m512d vcost = _mm512_set1_pd(cost_pct);
+    const __m512d zero = _mm512_setzero_pd();
+    for (; i + 8 <= end; i += 8) {
+        __m512d cur = _mm512_cvtepi32_pd(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(signals + i)));
+        __m512d prev = _mm512_cvtepi32_pd(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(signals + i - 1)));
+        __m512d p = _mm512_loadu_pd(prices + i);
+        __m512d dp = _mm512_sub_pd(p, _mm512_loadu_pd(prices + i - 1));
+        __m512d dq = _mm512_abs_pd(_mm512_sub_pd(cur, prev));
+        __m512d cost = _mm512_mul_pd(_mm512_mul_pd(dq, p), vcost);
+        _mm512_storeu_pd(out + (i - begin), _mm512_add_pd(_mm512_sub_pd(zero, cost), _mm512_mul_pd(cur, dp)));
+    }
+
+    for (; i < end; ++i) {
+        out[i - begin] = step_pnl_at(prices, signals, i, cost_pct);
+    }
+}
+
+TARGET_AVX512 double prefix_sum_avx512(const double* x, std::size_t count, double carry, double* out)
+{
+    const __m512i shift1 = _mm512_set_epi64(6, 5, 4, 3, 2, 1, 0, 0);
+    const __m512i shift2 = _mm512_set_epi64(5, 4, 3, 2, 1, 0, 0, 0);
+    const __m512i shift4 = _mm512_set_epi64(3, 2, 1, 0, 0, 0, 0, 0);
+    const __m512i last = _mm512_set1_epi64(7);
+    __m512d vcarry = _mm512_set1_pd(carry);
+
+    std::size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        __m512d v = _mm512_loadu_pd(x + k);
+        v = _mm512_add_pd(v, _mm512_maskz_permutexvar_pd(0xFE, shift1, v));
+        v = _mm512_add_pd(v, _mm512_maskz_permutexvar_pd(0xFC, shift2, v));
+        v = _mm512_add_pd(v, _mm512_maskz_permutexvar_pd(0xF0, shift4, v));
+        v = _mm512_add_pd(v, vcarry);
+        _mm512_storeu_pd(out + k, v);
+        vcarry = _mm512_permutexvar_pd(last, v);
+    }
+
+    carry = _mm512_cvtsd_f64(vcarry);
+    return prefix_sum_scalar(x + k, count - k, carry, out + k);
+}
+
+TARGET_AVX512 void drawdown_avx512(const double* equity, std::size_t count,
+                                   double& peak, double& max_drawdown)
+{
+    const __m512i shift1 = _mm512_set_epi64(6, 5, 4, 3, 2, 1, 0, 0);
+    const __m512i shift2 = _mm512_set_epi64(5, 4, 3, 2, 1, 0, 0, 0);
+    const __m512i shift4 = _mm512_set_epi64(3, 2, 1, 0, 0, 0, 0, 0);
+    const __m512i last = _mm512_set1_epi64(7);
+    __m512d vpeak = _mm512_set1_pd(peak);
+    __m512d vdd = _mm512_set1_pd(max_drawdown);
+
+    std::size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        __m512d e = _mm512_loadu_pd(equity + k);
+        __m512d m = _mm512_max_pd(e, _mm512_permutexvar_pd(shift1, e));
+        m = _mm512_max_pd(m, _mm512_permutexvar_pd(shift2, m));
+        m = _mm512_max_pd(m, _mm512_permutexvar_pd(shift4, m));
+        m = _mm512_max_pd(m, vpeak);
+        __m512d dd = _mm512_div_pd(_mm512_sub_pd(m, e), m);
+        vdd = _mm512_max_pd(vdd, dd);
+        vpeak = _mm512_permutexvar_pd(last, m);
+    }
+
+    peak = _mm512_cvtsd_f64(vpeak);
+    max_drawdown = _mm512_reduce_max_pd(vdd);
+    drawdown_scalar(equity + k, count - k, peak, max_drawdown);
+}
+
+TARGET_AVX512 void moments_avx512(const double* x, std::size_t count, double& sum, double& m2)
+{
+    sum = 0.0;
+    m2 = 0.0;
+    if (count == 0) {
+        return;
+    }
+
+    __m512d acc = _mm512_setzero_pd();
+    std::size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        acc = _mm512_add_pd(acc, _mm512_loadu_pd(x + k));
+    }
+    sum = _mm512_reduce_add_pd(acc);
+    for (std::size_t j = k; j < count; ++j) {
+        sum += x[j];
+    }
+
+    double mean = sum / static_cast<double>(count);
+    const __m512d vmean = _mm512_set1_pd(mean);
+    acc = _mm512_setzero_pd();
+    for (k = 0; k + 8 <= count; k += 8) {
+        __m512d d = _mm512_sub_pd(_mm512_loadu_pd(x + k), vmean);
+        acc = _mm512_add_pd(acc, _mm512_mul_pd(d, d));
+    }
+    m2 = _mm512_reduce_add_pd(acc);
+    for (std::size_t j = k; j < count; ++j) {
+        double d = x[j] - mean;
+        m2 += d * d;
+    }
+}
+
+const PnlKernels kAvx512Kernels = {
+    KernelIsa::Avx512, step_pnl_avx512, prefix_sum_avx512, drawdown_avx512, moments_avx512};
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // PNL_KERNELS_X86
+
+#if defined(PNL_KERNELS_NEON)
+
+// =========================
+// NEON (2 x double)
+// =========================
+
+void step_pnl_neon(const double* prices, const int* signals,
+                   std::size_t begin, std::size_t end,
+                   double cost_pct, double* out)
+{
+    std::size_t i = begin;
+    for (; i < end && i < 2; ++i) {
+        out[i - begin] = step_pnl_at(prices, signals, i, cost_pct);
+    }
+
+    const float64x2_t vcost = vdupq_n_f64(cost_pct);
+    const float64x2_t zero = vdupq_n_f64(0.0);
+    for (; i + 2 <= end; i += 2) {
+        float64x2_t cur = vcvtq_f64_s64(vmovl_s32(vld1_s32(signals + i)));
+        float64x2_t prev = vcvtq_f64_s64(vmovl_s32(vld1_s32(signals + i - 1)));
+        float64x2_t p = vld1q_f64(prices + i);
+        float64x2_t dp = vsubq_f64(p, vld1q_f64(prices + i - 1));
+        float64x2_t dq = vabsq_f64(vsubq_f64(cur, prev));
+        float64x2_t cost = vmulq_f64(vmulq_f64(dq, p), vcost);
+        vst1q_f64(out + (i - begin), vaddq_f64(vsubq_f64(zero, cost), vmulq_f64(cur, dp)));
+    }
+
+    for (; i < end; ++i) {
+        out[i - begin] = step_pnl_at(prices, signals, i, cost_pct);
+    }
+}
+
+double prefix_sum_neon(const double* x, std::size_t count, double carry, double* out)
+{
+    const float64x2_t zero = vdupq_n_f64(0.0);
+    float64x2_t vcarry = vdupq_n_f64(carry);
+
+    std::size_t k = 0;
+    for (; k + 2 <= count; k += 2) {
+        float64x2_t v = vld1q_f64(x + k);
+        v = vaddq_f64(v, vextq_f64(zero, v, 1));
+        v = vaddq_f64(v, vcarry);
+        vst1q_f64(out + k, v);
+        vcarry = vdupq_laneq_f64(v, 1);
+    }
+
+    carry = vgetq_lane_f64(vcarry, 0);
+    return prefix_sum_scalar(x + k, count - k, carry, out + k);
+}
+
+void drawdown_neon(const double* equity, std::size_t count,
+                   double& peak, double& max_drawdown)
+{
+    float64x2_t vpeak = vdupq_n_f64(peak);
+    float64x2_t vdd = vdupq_n_f64(max_drawdown);
+
+    std::size_t k = 0;
+    for (; k + 2 <= count; k += 2) {
+        float64x2_t e = vld1q_f64(equity + k);
+        float64x2_t m = vmaxq_f64(e, vdupq_laneq_f64(e, 0));
+        m = vmaxq_f64(m, vpeak);
+        float64x2_t dd = vdivq_f64(vsubq_f64(m, e), m);
+        vdd = vmaxq_f64(vdd, dd);
+        vpeak = vdupq_laneq_f64(m, 1);
+    }
+
+    peak = vgetq_lane_f64(vpeak, 0);
+    max_drawdown = vmaxvq_f64(vdd);
+    drawdown_scalar(equity + k, count - k, peak, max_drawdown);
+}
+
+void moments_neon(const double* x, std::size_t count, double& sum, double& m2)
+{
+    sum = 0.0;
+    m2 = 0.0;
+    if (count == 0) {
+        return;
+    }
+
+    float64x2_t acc = vdupq_n_f64(0.0);
+    std::size_t k = 0;
+    for (; k + 2 <= count; k += 2) {
+        acc = vaddq_f64(acc, vld1q_f64(x + k));
+    }
+    sum = vaddvq_f64(acc);
+    for (std::size_t j = k; j < count; ++j) {
+        sum += x[j];
+    }
+
+    double mean = sum / static_cast<double>(count);
+    const float64x2_t vmean = vdupq_n_f64(mean);
+    acc = vdupq_n_f64(0.0);
+    for (k = 0; k + 2 <= count; k += 2) {
+        float64x2_t d = vsubq_f64(vld1q_f64(x + k), vmean);
+        acc = vaddq_f64(acc, vmulq_f64(d, d));
+    }
+    m2 = vaddvq_f64(acc);
+    for (std::size_t j = k; j < count; ++j) {
+        double d = x[j] - mean;
+        m2 += d * d;
+    }
+}
+
+const PnlKernels kNeonKernels = {
+    KernelIsa::Neon, step_pnl_neon, prefix_sum_neon, drawdown_neon, moments_neon};
+
+#endif // PNL_KERNELS_NEON
+
+} // namespace
+
+bool kernel_isa_supported(KernelIsa isa)
+{
+    switch (isa) {
+    case KernelIsa::Auto:
+    case KernelIsa::Scalar:
+        return true;
+#if defined(PNL_KERNELS_X86)
+    case KernelIsa::Avx2:
+        return __builtin_cpu_supports("avx2");
+    case KernelIsa::Avx512:
+        return __builtin_cpu_supports("avx512f");
+#endif
+#if defined(PNL_KERNELS_NEON)
+    case KernelIsa::Neon:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+KernelIsa resolve_kernel_isa(KernelIsa isa)
+{
+    if (isa == KernelIsa::Auto) {
+        for (KernelIsa candidate : {KernelIsa::Avx512, KernelIsa::Avx2, KernelIsa::Neon}) {
+            if (kernel_isa_supported(candidate)) {
+                return candidate;
+            }
+        }
+        return KernelIsa::Scalar;
+    }
+    return kernel_isa_supported(isa) ? isa : KernelIsa::Scalar;
+}
+
+const char* kernel_isa_name(KernelIsa isa)
+{
+    switch (isa) {
+    case KernelIsa::Auto:   return "auto";
+    case KernelIsa::Scalar: return "scalar";
+    case KernelIsa::Avx2:   return "avx2";
+    case KernelIsa::Avx512: return "avx512";
+    case KernelIsa::Neon:   return "neon";
+    }
+    return "unknown";
+}
+
+const PnlKernels& select_pnl_kernels(KernelIsa isa)
+{
+    switch (resolve_kernel_isa(isa)) {
+#if defined(PNL_KERNELS_X86)
+    case KernelIsa::Avx2:
+        return kAvx2Kernels;
+    case KernelIsa::Avx512:
+        return kAvx512Kernels;
+#endif
+#if defined(PNL_KERNELS_NEON)
+    case KernelIsa::Neon:
+        return kNeonKernels;
+#endif
+    default:
+        return kScalarKernels;
+    }
+}
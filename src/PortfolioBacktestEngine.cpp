@@ -0,0 +1,103 @@
+#include "PortfolioBacktestEngine.hpp"
+
+#include <cmath>        // std::fabs
+
+#include "RunningMetrics.hpp"
+
+PortfolioBacktestEngine::PortfolioBacktestEngine(double initial_capital,
+                                                 double transaction_cost_pct,
+                                                 double risk_free_rate)
+    : initial_capital_(initial_capital),
+      transaction_cost_pct_(transaction_cost_pct),
+      risk_free_rate_(risk_free_rate) {}
+
+PortfolioResult PortfolioBacktestEngine::run(ArrayView<const double> prices,
+                                             ArrayView<const double> positions,
+                                             std::size_t num_assets,
+                                             double dt_in_years,
+                                             bool keep_asset_curves) const
+{
+    PortfolioResult result;
+
+    // Basic sanity checks
+    if (num_assets == 0 || prices.size() % num_assets != 0 ||
+        positions.size() != prices.size() || prices.size() / num_assets <= 1) {
+        return result;
+    }
+
+    const std::size_t n = num_assets;
+    const std::size_t t_count = prices.size() / n;
+    result.num_steps = t_count;
+    result.num_assets = n;
+
+    result.equity_curve.resize(t_count);
+    result.pnl.resize(t_count);
+    result.turnover_cost.resize(t_count);
+    result.asset_pnl.assign(n, 0.0);
+    result.asset_cost.assign(n, 0.0);
+    result.asset_turnover.assign(n, 0.0);
+    if (keep_asset_curves) {
+        result.asset_pnl_curve.assign(t_count * n, 0.0);
+    }
+
+    double equity = initial_capital_;
+    RunningMetrics metrics;
+    metrics.reset(equity);
+
+    // Initialise at t = 0 (flat book)
+    result.equity_curve[0] = equity;
+    result.pnl[0] = 0.0;
+    result.turnover_cost[0] = 0.0;
+    metrics.add_equity(equity);
+    metrics.add_pnl(0.0);
+
+    // Positions held over the previous step; row 0 is the flat book.
+    std::vector<double> flat(n, 0.0);
+
+    double* asset_pnl = result.asset_pnl.data();
+    double* asset_cost = result.asset_cost.data();
+    double* asset_turnover = result.asset_turnover.data();
+
+    for (std::size_t t = 1; t < t_count; ++t) {
+        const double* p = prices.data() + t * n;
+        const double* p_prev = p - n;
+        const double* q = positions.data() + t * n;
+        const double* q_prev = (t == 1) ? flat.data() : q - n;
+
+        double step_pnl = 0.0;
+        double step_cost = 0.0;
+
+        for (std::size_t j = 0; j < n; ++j) {
+            double notional = std::fabs(q[j] - q_prev[j]) * p[j];
+            double cost = notional * transaction_cost_pct_;
+            double net = q[j] * (p[j] - p_prev[j]) - cost;
+
+            asset_turnover[j] += notional;
+            asset_cost[j] += cost;
+            asset_pnl[j] += net;
+            step_cost += cost;
+            step_pnl += net;
+        }
+
+        if (keep_asset_curves) {
+            double* curve = result.asset_pnl_curve.data() + t * n;
+            for (std::size_t j = 0; j < n; ++j) {
+                curve[j] = asset_pnl[j];
+            }
+        }
+
+        equity += step_pnl;
+        result.pnl[t] = step_pnl;
+        result.turnover_cost[t] = step_cost;
+        result.equity_curve[t] = equity;
+
+        metrics.add_pnl(step_pnl);
+        metrics.add_equity(equity);
+    }
+
+    result.total_return = (equity / initial_capital_) - 1.0;
+    result.max_drawdown = metrics.max_drawdown;
+    result.sharpe_ratio = metrics.sharpe(dt_in_years);
+
+    return result;
+}
@@ -0,0 +1,298 @@
+#include "PriceStore.hpp"
+#include "CsvPriceReader.hpp"
+
+#include <algorithm>    // std::stable_sort
+#include <cstring>      // std::memcpy, std::memcmp
+#include <fstream>
+#include <numeric>      // std::iota
+#include <utility>      // std::swap
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char kMagic[8] = {'M', 'R', 'P', 'R', 'I', 'C', 'E', '\0'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kHeaderSize = 128;
+constexpr std::size_t kColumnAlign = 64;
+
+// Fixed-size prefix of the header; column offsets follow it.
+struct HeaderPrefix {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t num_columns;
+    std::uint64_t num_rows;
+};
+
+static_assert(sizeof(HeaderPrefix) == 24, "unexpected header padding");
+static_assert(sizeof(HeaderPrefix) + PriceStore::NumColumns * sizeof(std::uint64_t) <= kHeaderSize,
+              "column directory does not fit the header");
+
+void set_error(std::string* error, const std::string& message)
+{
+    if (error) {
+        *error = message;
+    }
+}
+
+std::size_t align_up(std::size_t x, std::size_t a)
+{
+    return (x + a - 1) / a * a;
+}
+
+} // namespace
+
+PriceStore::~PriceStore()
+{
+    close();
+}
+
+PriceStore::PriceStore(PriceStore&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+PriceStore& PriceStore::operator=(PriceStore&& other) noexcept
+{
+    if (this != &other) {
+        close();
+        std::swap(base_, other.base_);
+        std::swap(mapped_size_, other.mapped_size_);
+        std::swap(num_rows_, other.num_rows_);
+        std::swap(offsets_, other.offsets_);
+#ifdef _WIN32
+        std::swap(file_handle_, other.file_handle_);
+        std::swap(mapping_handle_, other.mapping_handle_);
+#endif
+    }
+    return *this;
+}
+
+bool PriceStore::open(const std::string& path, std::string* error)
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        set_error(error, "cannot open " + path);
+        return false;
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart < static_cast<LONGLONG>(kHeaderSize)) {
+        CloseHandle(file);
+        set_error(error, path + ": file too small for a price store");
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        set_error(error, "cannot map " + path);
+        return false;
+    }
+    file_handle_ = file;
+    mapping_handle_ = mapping;
+    base_ = static_cast<const unsigned char*>(view);
+    mapped_size_ = static_cast<std::size_t>(file_size.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        set_error(error, "cannot open " + path);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(kHeaderSize)) {
+        ::close(fd);
+        set_error(error, path + ": file too small for a price store");
+        return false;
+    }
+    void* view = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // the mapping keeps the file referenced
+    if (view == MAP_FAILED) {
+        set_error(error, "cannot map " + path);
+        return false;
+    }
+    base_ = static_cast<const unsigned char*>(view);
+    mapped_size_ = static_cast<std::size_t>(st.st_size);
+#endif
+
+    HeaderPrefix header;
+    std::memcpy(&header, base_, sizeof(header));
+    std::memcpy(offsets_, base_ + sizeof(header), sizeof(offsets_));
+
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.version != kVersion ||
+        header.num_columns != NumColumns) {
+        close();
+        set_error(error, path + ": not a price store (bad magic or version)");
+        return false;
+    }
+
+    std::uint64_t column_bytes = header.num_rows * sizeof(double);
+    for (std::uint64_t offset : offsets_) {
+        if (offset % kColumnAlign != 0 || offset < kHeaderSize ||
+            offset > mapped_size_ || column_bytes > mapped_size_ - offset) {
+            close();
+            set_error(error, path + ": corrupt column directory");
+            return false;
+        }
+    }
+
+    num_rows_ = static_cast<std::size_t>(header.num_rows);
+    return true;
+}
+
+void PriceStore::close()
+{
+    if (base_) {
+#ifdef _WIN32
+        UnmapViewOfFile(base_);
+        CloseHandle(static_cast<HANDLE>(mapping_handle_));
+        CloseHandle(static_cast<HANDLE>(file_handle_));
+        mapping_handle_ = nullptr;
+        file_handle_ = nullptr;
+#else
+        munmap(const_cast<unsigned char*>(base_), mapped_size_);
+#endif
+    }
+    base_ = nullptr;
+    mapped_size_ = 0;
+    num_rows_ = 0;
+    std::fill(std::begin(offsets_), std::end(offsets_), 0);
+}
+
+ArrayView<const double> PriceStore::double_column(Column c) const
+{
+    if (!base_) {
+        return ArrayView<const double>();
+    }
+    return ArrayView<const double>(reinterpret_cast<const double*>(base_ + offsets_[c]), num_rows_);
+}
+
+ArrayView<const std::int64_t> PriceStore::int_column(Column c) const
+{
+    if (!base_) {
+        return ArrayView<const std::int64_t>();
+    }
+    return ArrayView<const std::int64_t>(reinterpret_cast<const std::int64_t*>(base_ + offsets_[c]), num_rows_);
+}
+
+bool PriceStore::write(const std::string& path, const PriceColumns& data, std::string* error)
+{
+    std::size_t n = data.size();
+    if (data.open.size() != n || data.high.size() != n || data.low.size() != n ||
+        data.close.size() != n || data.adj_close.size() != n || data.volume.size() != n) {
+        set_error(error, "all price columns must have the same length");
+        return false;
+    }
+
+    const void* columns[NumColumns] = {
+        data.timestamp.data(), data.open.data(), data.high.data(), data.low.data(),
+        data.close.data(), data.adj_close.data(), data.volume.data()};
+
+    std::uint64_t offsets[NumColumns];
+    std::size_t offset = kHeaderSize;
+    for (std::size_t c = 0; c < NumColumns; ++c) {
+        offsets[c] = offset;
+        offset = align_up(offset + n * sizeof(double), kColumnAlign);
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        set_error(error, "cannot create " + path);
+        return false;
+    }
+
+    unsigned char header[kHeaderSize] = {};
+    HeaderPrefix prefix;
+    std::memcpy(prefix.magic, kMagic, sizeof(kMagic));
+    prefix.version = kVersion;
+    prefix.num_columns = NumColumns;
+    prefix.num_rows = n;
+    std::memcpy(header, &prefix, sizeof(prefix));
+    std::memcpy(header + sizeof(prefix), offsets, sizeof(offsets));
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    const char padding[kColumnAlign] = {};
+    std::size_t written = kHeaderSize;
+    for (std::size_t c = 0; c < NumColumns; ++c) {
+        out.write(padding, static_cast<std::streamsize>(offsets[c] - written));
+        out.write(static_cast<const char*>(columns[c]), static_cast<std::streamsize>(n * sizeof(double)));
+        written = offsets[c] + n * sizeof(double);
+    }
+
+    if (!out) {
+        set_error(error, "write failed for " + path);
+        return false;
+    }
+    return true;
+}
+
+bool PriceStore::read_csv(const std::string& csv_path, PriceColumns& out, std::string* error)
+{
+    CsvPriceReader reader;
+    if (!reader.open(csv_path, error)) {
+        return false;
+    }
+
+    PriceColumns raw;
+    PriceColumns chunk;
+    constexpr std::size_t chunk_rows = 65536;
+    for (;;) {
+        if (!reader.read_rows(chunk, chunk_rows, error)) {
+            return false;
+        }
+        if (chunk.size() == 0) {
+            break;
+        }
+        raw.timestamp.insert(raw.timestamp.end(), chunk.timestamp.begin(), chunk.timestamp.end());
+        raw.open.insert(raw.open.end(), chunk.open.begin(), chunk.open.end());
+        raw.high.insert(raw.high.end(), chunk.high.begin(), chunk.high.end());
+        raw.low.insert(raw.low.end(), chunk.low.begin(), chunk.low.end());
+        raw.close.insert(raw.close.end(), chunk.close.begin(), chunk.close.end());
+        raw.adj_close.insert(raw.adj_close.end(), chunk.adj_close.begin(), chunk.adj_close.end());
+        raw.volume.insert(raw.volume.end(), chunk.volume.begin(), chunk.volume.end());
+    }
+
+    // Sort by timestamp (stable, so duplicate dates keep file order).
+    std::vector<std::size_t> order(raw.size());
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return raw.timestamp[a] < raw.timestamp[b];
+    });
+
+    out = PriceColumns();
+    for (std::size_t k : order) {
+        out.timestamp.push_back(raw.timestamp[k]);
+        out.open.push_back(raw.open[k]);
+        out.high.push_back(raw.high[k]);
+        out.low.push_back(raw.low[k]);
+        out.close.push_back(raw.close[k]);
+        out.adj_close.push_back(raw.adj_close[k]);
+        out.volume.push_back(raw.volume[k]);
+    }
+    return true;
+}
+
+bool PriceStore::convert_csv(const std::string& csv_path,
+                             const std::string& store_path,
+                             std::string* error)
+{
+    PriceColumns data;
+    return read_csv(csv_path, data, error) && write(store_path, data, error);
+}
@@ -0,0 +1,91 @@
+#include "ResultArena.hpp"
+
+#include <algorithm>    // std::max
+#include <cstdint>      // std::uintptr_t
+
+ResultArena::ResultArena(std::size_t initial_bytes, std::pmr::memory_resource* upstream)
+    : upstream_(upstream ? upstream : std::pmr::get_default_resource())
+{
+    reserve(initial_bytes);
+}
+
+ResultArena::~ResultArena()
+{
+    release_overflow();
+    release_slab();
+}
+
+void ResultArena::reset()
+{
+    // Fold this batch's overflow into one slab big enough for all of it.
+    std::size_t needed = used_;
+    release_overflow();
+    offset_ = 0;
+    used_ = 0;
+    if (needed > slab_size_) {
+        release_slab();
+        reserve(needed);
+    }
+}
+
+void ResultArena::reserve(std::size_t bytes)
+{
+    if (bytes <= slab_size_ || offset_ != 0 || !overflow_.empty()) {
+        return;
+    }
+    release_slab();
+    // Whole cache lines, so every allocation can be padded to kAlignment.
+    bytes = (bytes + kAlignment - 1) / kAlignment * kAlignment;
+    slab_ = static_cast<unsigned char*>(upstream_->allocate(bytes, kAlignment));
+    slab_size_ = bytes;
+}
+
+void* ResultArena::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    alignment = std::max(alignment, alignof(std::max_align_t));
+
+    if (slab_) {
+        std::uintptr_t base = reinterpret_cast<std::uintptr_t>(slab_);
+        std::uintptr_t aligned = (base + offset_ + alignment - 1) & ~(alignment - 1);
+        std::size_t start = static_cast<std::size_t>(aligned - base);
+        if (start <= slab_size_ && bytes <= slab_size_ - start) {
+            std::size_t padded = (bytes + kAlignment - 1) / kAlignment * kAlignment;
+            used_ += start - offset_ + padded;
+            offset_ = std::min(slab_size_, start + padded);
+            return slab_ + start;
+        }
+    }
+
+    void* p = upstream_->allocate(bytes, alignment);
+    overflow_.push_back(Block{p, bytes, alignment});
+    used_ += (bytes + kAlignment - 1) / kAlignment * kAlignment;
+    return p;
+}
+
+void ResultArena::do_deallocate(void*, std::size_t, std::size_t)
+{
+    // Monotonic: memory is only reclaimed by reset().
+}
+
+bool ResultArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+void ResultArena::release_slab()
+{
+    if (slab_) {
+        upstream_->deallocate(slab_, slab_size_, kAlignment);
+        slab_ = nullptr;
+        slab_size_ = 0;
+    }
+    offset_ = 0;
+}
+
+void ResultArena::release_overflow()
+{
+    for (const Block& b : overflow_) {
+        upstream_->deallocate(b.ptr, b.bytes, b.alignment);
+    }
+    overflow_.clear();
+}
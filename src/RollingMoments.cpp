@@ -0,0 +1,142 @@
+#include "RollingMoments.hpp"
+
+#include <cmath>        // std::sqrt
+#include <cstdint>
+#include <limits>
+
+#include "BinaryIO.hpp"
+#include "NumericUtils.hpp"
+
+namespace {
+
+// Upper bound on a stored window length, to reject corrupt input before
+// allocating for it.
+constexpr std::uint64_t kMaxWindow = std::uint64_t(1) << 28;
+
+}  // namespace
+
+RollingMoments::RollingMoments(std::size_t window_len)
+    : window(window_len == 0 ? 1 : window_len),
+      buffer(window, 0.0) {}
+
+void RollingMoments::reset()
+{
+    buffer.assign(window, 0.0);
+    head = 0;
+    count = 0;
+    since_rebuild = 0;
+    same_run = 0;
+    shift = 0.0;
+    sum = 0.0;
+    sum_sq = 0.0;
+}
+
+void RollingMoments::push(double x)
+{
+    if (count == 0) {
+        shift = x;
+    }
+
+    std::size_t newest = (head == 0) ? window - 1 : head - 1;
+    same_run = (count > 0 && buffer[newest] == x) ? same_run + 1 : 1;
+
+    // Drop the value leaving the window once it is full.
+    if (count == window) {
+        double old = buffer[head] - shift;
+        sum -= old;
+        sum_sq -= old * old;
+    } else {
+        ++count;
+    }
+
+    buffer[head] = x;
+    head = (head + 1 == window) ? 0 : head + 1;
+
+    double d = x - shift;
+    sum += d;
+    sum_sq += d * d;
+
+    if (++since_rebuild >= kRebuildEvery) {
+        rebuild();
+    }
+}
+
+void RollingMoments::rebuild()
+{
+    since_rebuild = 0;
+
+    // Re-centre on the newest value so the shifted values stay small.
+    std::size_t newest = (head == 0) ? window - 1 : head - 1;
+    shift = buffer[newest];
+
+    sum = 0.0;
+    sum_sq = 0.0;
+    // Slots [0, count) are filled until the buffer wraps, then all of them.
+    for (std::size_t i = 0; i < count; ++i) {
+        double d = buffer[i] - shift;
+        sum += d;
+        sum_sq += d * d;
+    }
+}
+
+double RollingMoments::sharpe(double scale) const
+{
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    if (count < window || same_run >= window) {
+        return nan;
+    }
+
+    double w = static_cast<double>(window);
+    double mean_d = sum / w;
+    double mean_sq = sum_sq / w;
+    double var = mean_sq - mean_d * mean_d;
+
+    // Near-constant windows leave only cancellation noise; treat as zero std.
+    if (!(var > kZeroVarianceTolerance * mean_sq)) {
+        return nan;
+    }
+    return (mean_d + shift) / std::sqrt(var) * scale;
+}
+
+void RollingMoments::write_state(BinaryWriter& out) const
+{
+    out.write<std::uint64_t>(window);
+    out.write<std::uint64_t>(head);
+    out.write<std::uint64_t>(count);
+    out.write<std::uint64_t>(since_rebuild);
+    out.write<std::uint64_t>(same_run);
+    out.write(shift);
+    out.write(sum);
+    out.write(sum_sq);
+    out.write_bytes(buffer.data(), buffer.size() * sizeof(double));
+}
+
+bool RollingMoments::read_state(BinaryReader& in)
+{
+    std::uint64_t w = 0, h = 0, c = 0, since = 0, run = 0;
+    double s = 0.0, sm = 0.0, sq = 0.0;
+    if (!(in.read(w) && in.read(h) && in.read(c) && in.read(since) && in.read(run) &&
+          in.read(s) && in.read(sm) && in.read(sq))) {
+        return false;
+    }
+    if (w == 0 || w > kMaxWindow || h >= w || c > w || run > c || since >= kRebuildEvery ||
+        w > in.remaining() / sizeof(double)) {
+        return false;
+    }
+
+    std::vector<double> values(static_cast<std::size_t>(w));
+    if (!in.read_bytes(values.data(), values.size() * sizeof(double))) {
+        return false;
+    }
+
+    window = static_cast<std::size_t>(w);
+    buffer.swap(values);
+    head = static_cast<std::size_t>(h);
+    count = static_cast<std::size_t>(c);
+    since_rebuild = static_cast<std::size_t>(since);
+    same_run = static_cast<std::size_t>(run);
+    shift = s;
+    sum = sm;
+    sum_sq = sq;
+    return true;
+}
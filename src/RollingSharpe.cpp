@@ -0,0 +1,98 @@
+#include "RollingSharpe.hpp"
+
+#include <cmath>        // std::sqrt
+#include <limits>
+
+#include "NumericUtils.hpp"
+
+namespace {
+
+// Running sum with Neumaier compensation; hi + lo is the prefix to about
+// eps^2 relative accuracy.
+struct CompensatedSum {
+    double hi = 0.0;
+    double lo = 0.0;
+
+    void add(double x) { compensated_add(hi, lo, x); }
+};
+
+} // namespace
+
+RollingSharpePanel compute_rolling_sharpe_panel(ArrayView<const double> returns,
+                                                const std::vector<std::size_t>& windows,
+                                                double annualization)
+{
+    RollingSharpePanel panel;
+
+    const std::size_t n = returns.size();
+    const std::size_t w_count = windows.size();
+    panel.num_windows = w_count;
+    panel.num_steps = n;
+    panel.windows = windows;
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    panel.values.assign(w_count * n, nan);
+    panel.latest.assign(w_count, nan);
+    if (n == 0 || w_count == 0) {
+        return panel;
+    }
+
+    // Centre on the series mean so the squared sums do not cancel.
+    double centre = 0.0;
+    for (double r : returns) {
+        centre += r;
+    }
+    centre /= static_cast<double>(n);
+
+    // Shared prefix sums: index i holds the sum over returns[0, i).
+    std::vector<double> s1_hi(n + 1), s1_lo(n + 1), s2_hi(n + 1), s2_lo(n + 1);
+    CompensatedSum s1, s2;
+    s1_hi[0] = s1_lo[0] = s2_hi[0] = s2_lo[0] = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        double d = returns[i] - centre;
+        s1.add(d);
+        s2.add(d * d);
+        s1_hi[i + 1] = s1.hi;
+        s1_lo[i + 1] = s1.lo;
+        s2_hi[i + 1] = s2.hi;
+        s2_lo[i + 1] = s2.lo;
+    }
+
+    const double scale = std::sqrt(annualization);
+
+    // Single sliding pass over time; every window reads the same prefixes.
+    for (std::size_t t = 0; t < n; ++t) {
+        std::size_t end = t + 1;
+        for (std::size_t k = 0; k < w_count; ++k) {
+            std::size_t w = windows[k];
+            if (w == 0 || end < w) {
+                continue;
+            }
+            std::size_t begin = end - w;
+            double inv_w = 1.0 / static_cast<double>(w);
+
+            double sum = (s1_hi[end] - s1_hi[begin]) + (s1_lo[end] - s1_lo[begin]);
+            double sum_sq = (s2_hi[end] - s2_hi[begin]) + (s2_lo[end] - s2_lo[begin]);
+            double mean_c = sum * inv_w;
+            double mean_sq = sum_sq * inv_w;
+            double var = mean_sq - mean_c * mean_c;
+
+            // A constant window leaves only cancellation noise of order
+            // eps * mean_sq; treat it as zero std like pandas does.
+            if (!(var > kZeroVarianceTolerance * mean_sq)) {
+                continue;  // zero std -> inf / NaN -> NaN
+            }
+
+            double sr = scale * (mean_c + centre) / std::sqrt(var);
+            if (std::isfinite(sr)) {
+                panel.values[k * n + t] = sr;
+            }
+        }
+    }
+
+    for (std::size_t k = 0; k < w_count; ++k) {
+        panel.latest[k] = panel.values[k * n + (n - 1)];
+    }
+
+    return panel;
+}
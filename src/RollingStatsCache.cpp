@@ -0,0 +1,254 @@
+#include "RollingStatsCache.hpp"
+
+#include <algorithm>    // std::max
+#include <cmath>        // std::sqrt
+#include <limits>
+#include <utility>      // std::move
+
+#include "NumericUtils.hpp"
+
+namespace {
+
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+}  // namespace
+
+void RollingStatsCache::add_series(const std::string& id, ArrayView<const double> prices)
+{
+    auto s = std::make_shared<Series>();
+    std::size_t n = prices.size();
+    s->prices.assign(prices.begin(), prices.end());
+    s->block_shift.resize((n + kBlockBars - 1) / kBlockBars);
+    s->sum_hi.resize(n);
+    s->sum_lo.resize(n);
+    s->sum_sq_hi.resize(n);
+    s->sum_sq_lo.resize(n);
+    s->same_run.resize(n);
+
+    double shift = 0.0, sum = 0.0, sum_c = 0.0, sum_sq = 0.0, sum_sq_c = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (i % kBlockBars == 0) {
+            shift = prices[i];
+            s->block_shift[i / kBlockBars] = shift;
+            sum = sum_c = sum_sq = sum_sq_c = 0.0;
+        }
+        double d = prices[i] - shift;
+        compensated_add(sum, sum_c, d);
+        compensated_add(sum_sq, sum_sq_c, d * d);
+        s->sum_hi[i] = sum;
+        s->sum_lo[i] = sum_c;
+        s->sum_sq_hi[i] = sum_sq;
+        s->sum_sq_lo[i] = sum_sq_c;
+        s->same_run[i] = (i > 0 && prices[i] == prices[i - 1]) ? s->same_run[i - 1] + 1 : 1;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    series_[id] = std::move(s);
+}
+
+bool RollingStatsCache::has_series(const std::string& id) const
+{
+    return find(id) != nullptr;
+}
+
+void RollingStatsCache::erase(const std::string& id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    series_.erase(id);
+}
+
+void RollingStatsCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    series_.clear();
+}
+
+std::size_t RollingStatsCache::series_size(const std::string& id) const
+{
+    std::shared_ptr<Series> s = find(id);
+    return s ? s->prices.size() : 0;
+}
+
+double RollingStatsCache::mean(const std::string& id, std::size_t window, std::size_t i) const
+{
+    std::shared_ptr<Series> s = find(id);
+    if (!s || window == 0 || i >= s->prices.size() || i + 1 < window) {
+        return kNaN;
+    }
+    return window_mean(*s, window, i);
+}
+
+double RollingStatsCache::stddev(const std::string& id, std::size_t window, std::size_t i) const
+{
+    std::shared_ptr<Series> s = find(id);
+    if (!s || window == 0 || i >= s->prices.size() || i + 1 < window) {
+        return kNaN;
+    }
+    return window_std(*s, window, i);
+}
+
+std::vector<double> RollingStatsCache::rolling_mean(const std::string& id, std::size_t window) const
+{
+    std::shared_ptr<Series> s = find(id);
+    if (!s) {
+        return std::vector<double>();
+    }
+    std::vector<double> out(s->prices.size(), kNaN);
+    for (std::size_t i = (window == 0 ? out.size() : window - 1); i < out.size(); ++i) {
+        out[i] = window_mean(*s, window, i);
+    }
+    return out;
+}
+
+std::vector<double> RollingStatsCache::rolling_std(const std::string& id, std::size_t window) const
+{
+    std::shared_ptr<Series> s = find(id);
+    if (!s) {
+        return std::vector<double>();
+    }
+    std::vector<double> out(s->prices.size(), kNaN);
+    for (std::size_t i = (window == 0 ? out.size() : window - 1); i < out.size(); ++i) {
+        out[i] = window_std(*s, window, i);
+    }
+    return out;
+}
+
+ArrayView<const double> RollingStatsCache::zscores(const std::string& id, std::size_t window)
+{
+    std::shared_ptr<Series> s = find(id);
+    if (!s || window == 0) {
+        return ArrayView<const double>();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = s->zscores.find(window);
+        if (it != s->zscores.end()) {
+            return ArrayView<const double>(it->second.data(), it->second.size());
+        }
+    }
+
+    // Compute outside the lock; if another thread stores the same key
+    // first, its (identical) result is kept.
+    std::size_t n = s->prices.size();
+    std::vector<double> z(n, kNaN);
+    double w = static_cast<double>(window);
+    for (std::size_t i = window - 1; i < n; ++i) {
+        if (s->same_run[i] >= window) {
+            continue;
+        }
+        double shift, sum, sum_sq;
+        window_sums(*s, window, i, shift, sum, sum_sq);
+        double mean_d = sum / w;
+        double mean_sq = sum_sq / w;
+        double var = mean_sq - mean_d * mean_d;
+        if (var > kZeroVarianceTolerance * mean_sq) {
+            z[i] = (s->prices[i] - shift - mean_d) / std::sqrt(var);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    const std::vector<double>& stored = s->zscores.emplace(window, std::move(z)).first->second;
+    return ArrayView<const double>(stored.data(), stored.size());
+}
+
+bool RollingStatsCache::signals_into(const std::string& id, const SignalParams& params, ArrayView<int> out)
+{
+    ArrayView<const double> z = zscores(id, params.window);
+    if (z.empty() || out.size() != z.size()) {
+        return false;
+    }
+    int position = 0;
+    for (std::size_t i = 0; i < z.size(); ++i) {
+        position = zscore_position_step(z[i], position, params.z_entry, params.z_exit);
+        out[i] = position;
+    }
+    return true;
+}
+
+std::vector<int> RollingStatsCache::signal_matrix(const std::string& id, const std::vector<SignalParams>& grid)
+{
+    std::size_t n = series_size(id);
+    std::vector<int> out(grid.size() * n);
+    for (std::size_t k = 0; k < grid.size(); ++k) {
+        if (!signals_into(id, grid[k], ArrayView<int>(out.data() + k * n, n))) {
+            return std::vector<int>();
+        }
+    }
+    return out;
+}
+
+std::size_t RollingStatsCache::cached_windows() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::size_t count = 0;
+    for (const auto& entry : series_) {
+        count += entry.second->zscores.size();
+    }
+    return count;
+}
+
+void RollingStatsCache::window_sums(const Series& s, std::size_t window, std::size_t i,
+                                    double& shift, double& sum, double& sum_sq)
+{
+    std::size_t first = i + 1 - window;
+    std::size_t block = i / kBlockBars;
+    shift = s.block_shift[block];
+    sum = 0.0;
+    sum_sq = 0.0;
+
+    // Newest block first; older blocks are re-shifted onto this one:
+    //   sum((p - shift)^2) = Q + 2 * delta * S + n * delta^2,
+    // with S, Q their own shifted sums and delta = their shift - shift.
+    std::size_t last = i;
+    for (;;) {
+        std::size_t block_begin = block * kBlockBars;
+        std::size_t lo = std::max(first, block_begin);
+        double part = s.sum_hi[last] + s.sum_lo[last];
+        double part_sq = s.sum_sq_hi[last] + s.sum_sq_lo[last];
+        if (lo > block_begin) {
+            part = (s.sum_hi[last] - s.sum_hi[lo - 1]) + (s.sum_lo[last] - s.sum_lo[lo - 1]);
+            part_sq = (s.sum_sq_hi[last] - s.sum_sq_hi[lo - 1]) + (s.sum_sq_lo[last] - s.sum_sq_lo[lo - 1]);
+        }
+        double count = static_cast<double>(last - lo + 1);
+        double delta = s.block_shift[block] - shift;
+        sum += part + count * delta;
+        sum_sq += part_sq + 2.0 * delta * part + count * delta * delta;
+
+        if (lo == first) {
+            return;
+        }
+        last = block_begin - 1;
+        --block;
+    }
+}
+
+double RollingStatsCache::window_mean(const Series& s, std::size_t window, std::size_t i)
+{
+    if (s.same_run[i] >= window) {
+        return s.prices[i];
+    }
+    double shift, sum, sum_sq;
+    window_sums(s, window, i, shift, sum, sum_sq);
+    return shift + sum / static_cast<double>(window);
+}
+
+double RollingStatsCache::window_std(const Series& s, std::size_t window, std::size_t i)
+{
+    if (s.same_run[i] >= window) {
+        return kNaN;
+    }
+    double shift, sum, sum_sq;
+    window_sums(s, window, i, shift, sum, sum_sq);
+    double w = static_cast<double>(window);
+    double mean_d = sum / w;
+    double mean_sq = sum_sq / w;
+    double var = mean_sq - mean_d * mean_d;
+    return (var > kZeroVarianceTolerance * mean_sq) ? std::sqrt(var) : kNaN;
+}
+
+std::shared_ptr<RollingStatsCache::Series> RollingStatsCache::find(const std::string& id) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = series_.find(id);
+    return (it == series_.end()) ? nullptr : it->second;
+}
@@ -0,0 +1,165 @@
+#include "SignalGenerator.hpp"
+
+#include <cmath>        // std::sqrt
+#include <cstdint>
+#include <limits>
+#include <utility>      // std::move
+
+#include "BinaryIO.hpp"
+
+SignalGenerator::SignalGenerator(std::size_t window,
+                                 double z_entry,
+                                 double z_exit,
+                                 std::size_t recompute_every)
+    : window_(window == 0 ? 1 : window),
+      z_entry_(z_entry),
+      z_exit_(z_exit),
+      recompute_every_(recompute_every == 0 ? 1024 : recompute_every),
+      buffer_(window_, 0.0),
+      last_z_(std::numeric_limits<double>::quiet_NaN()) {}
+
+void SignalGenerator::reset()
+{
+    head_ = 0;
+    count_ = 0;
+    since_rebuild_ = 0;
+    shift_ = 0.0;
+    sum_ = 0.0;
+    sum_sq_ = 0.0;
+    last_z_ = std::numeric_limits<double>::quiet_NaN();
+    position_ = 0;
+}
+
+int SignalGenerator::update(double price)
+{
+    if (count_ == 0) {
+        shift_ = price;
+    }
+
+    // Drop the price leaving the window once it is full.
+    if (count_ == window_) {
+        double old = buffer_[head_] - shift_;
+        sum_ -= old;
+        sum_sq_ -= old * old;
+    } else {
+        ++count_;
+    }
+
+    buffer_[head_] = price;
+    head_ = (head_ + 1 == window_) ? 0 : head_ + 1;
+
+    double d = price - shift_;
+    sum_ += d;
+    sum_sq_ += d * d;
+
+    if (++since_rebuild_ >= recompute_every_) {
+        rebuild_sums();
+    }
+
+    // Rolling z-score (population std, ddof = 0)
+    double z = std::numeric_limits<double>::quiet_NaN();
+    if (count_ == window_) {
+        double w = static_cast<double>(window_);
+        double mean_d = sum_ / w;
+        double var = sum_sq_ / w - mean_d * mean_d;
+        if (var > 0.0) {
+            z = (price - shift_ - mean_d) / std::sqrt(var);
+        }
+    }
+    last_z_ = z;
+
+    // Entry/exit hysteresis
+    position_ = zscore_position_step(z, position_, z_entry_, z_exit_);
+    return position_;
+}
+
+std::vector<int> SignalGenerator::generate(ArrayView<const double> prices)
+{
+    std::vector<int> out(prices.size());
+    generate_into(prices, ArrayView<int>(out));
+    return out;
+}
+
+void SignalGenerator::generate_into(ArrayView<const double> prices, ArrayView<int> out)
+{
+    reset();
+    for (std::size_t i = 0; i < prices.size(); ++i) {
+        out[i] = update(prices[i]);
+    }
+}
+
+std::vector<double> SignalGenerator::zscores(ArrayView<const double> prices)
+{
+    reset();
+    std::vector<double> out(prices.size());
+    for (std::size_t i = 0; i < prices.size(); ++i) {
+        update(prices[i]);
+        out[i] = last_z_;
+    }
+    return out;
+}
+
+void SignalGenerator::rebuild_sums()
+{
+    since_rebuild_ = 0;
+
+    // Re-centre on the newest price so the shifted values stay small.
+    std::size_t newest = (head_ == 0) ? window_ - 1 : head_ - 1;
+    shift_ = buffer_[newest];
+
+    sum_ = 0.0;
+    sum_sq_ = 0.0;
+    // Slots [0, count_) are filled until the buffer wraps, then all of them.
+    for (std::size_t i = 0; i < count_; ++i) {
+        double d = buffer_[i] - shift_;
+        sum_ += d;
+        sum_sq_ += d * d;
+    }
+}
+
+void SignalGenerator::write_state(BinaryWriter& out) const
+{
+    out.write<std::uint64_t>(window_);
+    out.write(z_entry_);
+    out.write(z_exit_);
+    out.write<std::uint64_t>(recompute_every_);
+
+    out.write<std::uint64_t>(head_);
+    out.write<std::uint64_t>(count_);
+    out.write<std::uint64_t>(since_rebuild_);
+    out.write(shift_);
+    out.write(sum_);
+    out.write(sum_sq_);
+    out.write(last_z_);
+    out.write<std::int32_t>(position_);
+    out.write_bytes(buffer_.data(), buffer_.size() * sizeof(double));
+}
+
+bool SignalGenerator::read_state(BinaryReader& in)
+{
+    std::uint64_t window = 0, recompute_every = 0, head = 0, count = 0, since = 0;
+    double z_entry = 0.0, z_exit = 0.0;
+    if (!(in.read(window) && in.read(z_entry) && in.read(z_exit) && in.read(recompute_every)) ||
+        window == 0 || recompute_every == 0 || window > in.remaining() / sizeof(double)) {
+        return false;
+    }
+
+    SignalGenerator g(static_cast<std::size_t>(window), z_entry, z_exit,
+                      static_cast<std::size_t>(recompute_every));
+    std::int32_t position = 0;
+    if (!(in.read(head) && in.read(count) && in.read(since) && in.read(g.shift_) &&
+          in.read(g.sum_) && in.read(g.sum_sq_) && in.read(g.last_z_) && in.read(position)) ||
+        head >= window || count > window || since >= recompute_every || position < -1 || position > 1) {
+        return false;
+    }
+    if (!in.read_bytes(g.buffer_.data(), g.buffer_.size() * sizeof(double))) {
+        return false;
+    }
+    g.head_ = static_cast<std::size_t>(head);
+    g.count_ = static_cast<std::size_t>(count);
+    g.since_rebuild_ = static_cast<std::size_t>(since);
+    g.position_ = position;
+
+    *this = std::move(g);
+    return true;
+}
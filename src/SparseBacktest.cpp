@@ -0,0 +1,118 @@
+#include "SparseBacktest.hpp"
+
+#include <algorithm>    // std::max, std::min
+#include <limits>
+
+#include "NumericUtils.hpp"
+
+PriceRangeIndex::PriceRangeIndex(ArrayView<const double> prices)
+    : prices_(prices)
+{
+    std::size_t n = prices.size();
+    sum_sq_hi_.assign(n, 0.0);
+    sum_sq_lo_.assign(n, 0.0);
+    double hi = 0.0, lo = 0.0;
+    for (std::size_t i = 1; i < n; ++i) {
+        double move = prices[i] - prices[i - 1];
+        compensated_add(hi, lo, move * move);
+        sum_sq_hi_[i] = hi;
+        sum_sq_lo_[i] = lo;
+    }
+
+    std::size_t blocks = (n + kBlockBars - 1) / kBlockBars;
+    leaves_ = 1;
+    while (leaves_ < blocks) {
+        leaves_ *= 2;
+    }
+    node_max_.assign(2 * leaves_, -std::numeric_limits<double>::infinity());
+    node_min_.assign(2 * leaves_, std::numeric_limits<double>::infinity());
+    for (std::size_t i = 0; i < n; ++i) {
+        std::size_t leaf = leaves_ + i / kBlockBars;
+        node_max_[leaf] = std::max(node_max_[leaf], prices[i]);
+        node_min_[leaf] = std::min(node_min_[leaf], prices[i]);
+    }
+    for (std::size_t node = leaves_ - 1; node >= 1; --node) {
+        node_max_[node] = std::max(node_max_[2 * node], node_max_[2 * node + 1]);
+        node_min_[node] = std::min(node_min_[2 * node], node_min_[2 * node + 1]);
+    }
+}
+
+double PriceRangeIndex::sum_sq_moves(std::size_t begin, std::size_t end) const
+{
+    if (end <= begin) {
+        return 0.0;
+    }
+    double hi = sum_sq_hi_[end - 1] - sum_sq_hi_[begin - 1];
+    double lo = sum_sq_lo_[end - 1] - sum_sq_lo_[begin - 1];
+    return std::max(hi + lo, 0.0);
+}
+
+void PriceRangeIndex::fold_drawdown(std::size_t begin, std::size_t end,
+                                    double base, int position, double reference,
+                                    double& peak, double& max_drawdown) const
+{
+    if (end <= begin) {
+        return;
+    }
+    if (position == 0) {
+        // Flat: one equity value for the whole range.
+        peak = std::max(peak, base);
+        max_drawdown = std::max(max_drawdown, (peak - base) / peak);
+        return;
+    }
+
+    Fold f{base, position, reference, peak, max_drawdown};
+    std::size_t first_block = (begin + kBlockBars - 1) / kBlockBars;
+    std::size_t last_block = end / kBlockBars;
+    if (first_block >= last_block) {
+        fold_bars(begin, end, f);
+        return;
+    }
+    fold_bars(begin, first_block * kBlockBars, f);
+    fold_blocks(1, 0, leaves_, first_block, last_block, f);
+    fold_bars(last_block * kBlockBars, end, f);
+}
+
+void PriceRangeIndex::fold_bars(std::size_t begin, std::size_t end, Fold& f) const
+{
+    for (std::size_t i = begin; i < end; ++i) {
+        double equity = f.base + f.position * (prices_[i] - f.reference);
+        if (equity > f.peak) {
+            f.peak = equity;
+        }
+        double dd = (f.peak - equity) / f.peak;
+        if (dd > f.max_drawdown) {
+            f.max_drawdown = dd;
+        }
+    }
+}
+
+void PriceRangeIndex::fold_blocks(std::size_t node, std::size_t node_begin, std::size_t node_end,
+                                  std::size_t begin, std::size_t end, Fold& f) const
+{
+    if (node_end <= begin || node_begin >= end) {
+        return;
+    }
+    if (begin <= node_begin && node_end <= end) {
+        // Highest and lowest equity anywhere in the node; if even the
+        // highest peak against the lowest equity stays within the current
+        // maximum, no bar inside can raise it.
+        double best = f.position > 0 ? node_max_[node] : node_min_[node];
+        double worst = f.position > 0 ? node_min_[node] : node_max_[node];
+        double high = f.base + f.position * (best - f.reference);
+        double low = f.base + f.position * (worst - f.reference);
+        double top = std::max(f.peak, high);
+        if (low > 0.0 && top - low <= f.max_drawdown * top) {
+            f.peak = top;
+            return;
+        }
+        if (node_end - node_begin == 1) {
+            std::size_t first = node_begin * kBlockBars;
+            fold_bars(first, std::min(first + kBlockBars, prices_.size()), f);
+            return;
+        }
+    }
+    std::size_t mid = node_begin + (node_end - node_begin) / 2;
+    fold_blocks(2 * node, node_begin, mid, begin, end, f);
+    fold_blocks(2 * node + 1, mid, node_end, begin, end, f);
+}
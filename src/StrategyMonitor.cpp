@@ -0,0 +1,310 @@
+#include "StrategyMonitor.hpp"
+
+#include <cmath>        // std::sqrt, std::fabs
+#include <cstdio>       // std::rename, std::remove
+#include <cstring>      // std::memcpy, std::memcmp
+#include <fstream>
+#include <iterator>
+#include <utility>      // std::move
+
+#include "BinaryIO.hpp"
+
+namespace {
+
+// Snapshot file layout (little-endian):
+//   [0, 32)   header: magic "MRSNAP\0\0", uint32 version, uint32 reserved,
+//             uint64 payload size, uint64 FNV-1a hash of the payload
+//   [32, ...) payload: StrategyMonitor::write_state()
+constexpr char kMagic[8] = {'M', 'R', 'S', 'N', 'A', 'P', '\0', '\0'};
+constexpr std::uint32_t kVersion = 1;
+
+struct SnapshotHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t payload_size;
+    std::uint64_t checksum;
+};
+
+static_assert(sizeof(SnapshotHeader) == 32, "unexpected header padding");
+
+// Upper bound on the number of stored windows, to reject corrupt input
+// before allocating for it.
+constexpr std::uint64_t kMaxWindows = 1 << 16;
+
+void set_error(std::string* error, const std::string& message)
+{
+    if (error) {
+        *error = message;
+    }
+}
+
+std::uint64_t fnv1a(const std::string& bytes)
+{
+    std::uint64_t h = 14695981039346656037ull;
+    for (unsigned char c : bytes) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+void write_windows(BinaryWriter& out, const std::vector<std::size_t>& windows)
+{
+    out.write<std::uint64_t>(windows.size());
+    for (std::size_t w : windows) {
+        out.write<std::uint64_t>(w);
+    }
+}
+
+bool read_windows(BinaryReader& in, std::vector<std::size_t>& windows)
+{
+    std::uint64_t n = 0;
+    if (!in.read(n) || n > kMaxWindows) {
+        return false;
+    }
+    windows.resize(static_cast<std::size_t>(n));
+    for (std::size_t& w : windows) {
+        std::uint64_t value = 0;
+        if (!in.read(value) || value == 0) {
+            return false;
+        }
+        w = static_cast<std::size_t>(value);
+    }
+    return true;
+}
+
+}  // namespace
+
+StrategyMonitor::StrategyMonitor(const std::vector<std::size_t>& signal_windows,
+                                 const std::vector<std::size_t>& sharpe_windows,
+                                 double z_entry,
+                                 double z_exit,
+                                 double cost_bps,
+                                 double initial_capital,
+                                 double annualization)
+    : signal_windows_(signal_windows),
+      sharpe_windows_(sharpe_windows),
+      cost_bps_(cost_bps),
+      annualization_(annualization)
+{
+    for (std::size_t& w : sharpe_windows_) {
+        w = (w == 0) ? 1 : w;
+    }
+
+    strategies_.reserve(signal_windows_.size());
+    for (std::size_t& w : signal_windows_) {
+        w = (w == 0) ? 1 : w;
+
+        Strategy s{SignalGenerator(w, z_entry, z_exit),
+                   StreamingBacktest(initial_capital, cost_bps / 10000.0, 1.0 / annualization),
+                   {},
+                   0.0};
+        for (std::size_t sw : sharpe_windows_) {
+            s.return_windows.emplace_back(sw);
+        }
+        strategies_.push_back(std::move(s));
+    }
+}
+
+void StrategyMonitor::reset()
+{
+    bars_ = 0;
+    last_timestamp_ = 0;
+    last_price_ = 0.0;
+    for (Strategy& s : strategies_) {
+        s.generator.reset();
+        s.backtest.reset();
+        for (RollingMoments& w : s.return_windows) {
+            w.reset();
+        }
+        s.last_return = 0.0;
+    }
+}
+
+void StrategyMonitor::on_bar(std::int64_t timestamp, double price)
+{
+    // pct_change() with the first bar filled as zero return.
+    double r = (bars_ == 0) ? 0.0 : price / last_price_ - 1.0;
+
+    for (Strategy& s : strategies_) {
+        int prev_pos = s.generator.position();
+        int pos = s.generator.update(price);
+
+        double turnover = (bars_ == 0) ? 0.0 : std::fabs(static_cast<double>(pos - prev_pos));
+        double ret = prev_pos * r - (cost_bps_ / 10000.0) * turnover;
+
+        s.backtest.on_bar(price, pos);
+        for (RollingMoments& w : s.return_windows) {
+            w.push(ret);
+        }
+        s.last_return = ret;
+    }
+
+    last_timestamp_ = timestamp;
+    last_price_ = price;
+    ++bars_;
+}
+
+std::size_t StrategyMonitor::update(ArrayView<const std::int64_t> timestamps,
+                                    ArrayView<const double> prices)
+{
+    std::size_t n = timestamps.size() < prices.size() ? timestamps.size() : prices.size();
+    std::size_t applied = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (bars_ > 0 && timestamps[i] <= last_timestamp_) {
+            continue;
+        }
+        on_bar(timestamps[i], prices[i]);
+        ++applied;
+    }
+    return applied;
+}
+
+std::vector<double> StrategyMonitor::sharpe_snapshot() const
+{
+    double scale = std::sqrt(annualization_);
+    std::size_t cols = sharpe_windows_.size();
+
+    std::vector<double> out(strategies_.size() * cols);
+    for (std::size_t k = 0; k < strategies_.size(); ++k) {
+        for (std::size_t j = 0; j < cols; ++j) {
+            out[k * cols + j] = strategies_[k].return_windows[j].sharpe(scale);
+        }
+    }
+    return out;
+}
+
+void StrategyMonitor::write_state(BinaryWriter& out) const
+{
+    write_windows(out, signal_windows_);
+    write_windows(out, sharpe_windows_);
+    out.write(cost_bps_);
+    out.write(annualization_);
+
+    out.write<std::uint64_t>(bars_);
+    out.write(last_timestamp_);
+    out.write(last_price_);
+
+    for (const Strategy& s : strategies_) {
+        s.generator.write_state(out);
+        s.backtest.write_state(out);
+        for (const RollingMoments& w : s.return_windows) {
+            w.write_state(out);
+        }
+        out.write(s.last_return);
+    }
+}
+
+bool StrategyMonitor::read_state(BinaryReader& in)
+{
+    // Decode into a fresh monitor so a corrupt input changes nothing.
+    StrategyMonitor m({}, {});
+    std::uint64_t bars = 0;
+    if (!(read_windows(in, m.signal_windows_) && read_windows(in, m.sharpe_windows_) &&
+          in.read(m.cost_bps_) && in.read(m.annualization_) && in.read(bars) &&
+          in.read(m.last_timestamp_) && in.read(m.last_price_))) {
+        return false;
+    }
+    m.bars_ = static_cast<std::size_t>(bars);
+
+    m.strategies_.reserve(m.signal_windows_.size());
+    for (std::size_t k = 0; k < m.signal_windows_.size(); ++k) {
+        Strategy s{SignalGenerator(1), StreamingBacktest(0.0, 0.0), {}, 0.0};
+        if (!s.generator.read_state(in) || s.generator.window() != m.signal_windows_[k] ||
+            !s.backtest.read_state(in)) {
+            return false;
+        }
+        s.return_windows.resize(m.sharpe_windows_.size());
+        for (std::size_t j = 0; j < m.sharpe_windows_.size(); ++j) {
+            if (!s.return_windows[j].read_state(in) ||
+                s.return_windows[j].window != m.sharpe_windows_[j]) {
+                return false;
+            }
+        }
+        if (!in.read(s.last_return)) {
+            return false;
+        }
+        m.strategies_.push_back(std::move(s));
+    }
+
+    *this = std::move(m);
+    return true;
+}
+
+bool StrategyMonitor::save_snapshot(const std::string& path, std::string* error) const
+{
+    BinaryWriter payload;
+    write_state(payload);
+    const std::string& bytes = payload.str();
+
+    SnapshotHeader header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.reserved = 0;
+    header.payload_size = bytes.size();
+    header.checksum = fnv1a(bytes);
+
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            set_error(error, "cannot create " + tmp_path);
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        out.flush();
+        if (!out) {
+            set_error(error, "write failed for " + tmp_path);
+            return false;
+        }
+    }
+
+#ifdef _WIN32
+    // rename() does not replace an existing file on Windows.
+    std::remove(path.c_str());
+#endif
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        set_error(error, "cannot replace " + path);
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool StrategyMonitor::load_snapshot(const std::string& path, std::string* error)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        set_error(error, "cannot open " + path);
+        return false;
+    }
+    std::string file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    SnapshotHeader header;
+    if (file.size() < sizeof(header)) {
+        set_error(error, path + ": file too small for a snapshot");
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion) {
+        set_error(error, path + ": not a monitor snapshot (bad magic or version)");
+        return false;
+    }
+
+    std::string payload = file.substr(sizeof(header));
+    if (payload.size() != header.payload_size || fnv1a(payload) != header.checksum) {
+        set_error(error, path + ": truncated or corrupt snapshot (checksum mismatch)");
+        return false;
+    }
+
+    BinaryReader reader(payload);
+    StrategyMonitor restored({}, {});
+    if (!restored.read_state(reader) || reader.remaining() != 0) {
+        set_error(error, path + ": malformed snapshot payload");
+        return false;
+    }
+    *this = std::move(restored);
+    return true;
+}
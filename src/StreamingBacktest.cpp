@@ -0,0 +1,209 @@
+#include "StreamingBacktest.hpp"
+
+#include <cmath>        // std::sqrt, std::abs
+#include <cstdint>
+#include <cstring>      // std::memcmp
+#include <limits>
+#include <utility>      // std::move
+
+#include "BinaryIO.hpp"
+
+namespace {
+
+constexpr char kMagic[8] = {'M', 'R', 'S', 'T', 'R', 'E', 'A', 'M'};
+constexpr std::uint32_t kVersion = 2;
+
+void set_error(std::string* error, const std::string& message)
+{
+    if (error) {
+        *error = message;
+    }
+}
+
+}  // namespace
+
+StreamingBacktest::StreamingBacktest(double initial_capital,
+                                     double transaction_cost_pct,
+                                     double dt_in_years,
+                                     const std::vector<std::size_t>& sharpe_windows)
+    : initial_capital_(initial_capital),
+      transaction_cost_pct_(transaction_cost_pct),
+      dt_in_years_(dt_in_years),
+      equity_(initial_capital)
+{
+    windows_.reserve(sharpe_windows.size());
+    for (std::size_t w : sharpe_windows) {
+        windows_.emplace_back(w);
+    }
+    reset();
+}
+
+void StreamingBacktest::reset()
+{
+    bars_ = 0;
+    position_ = 0;
+    equity_ = initial_capital_;
+    last_price_ = 0.0;
+    metrics_.reset(initial_capital_);
+    for (RollingMoments& w : windows_) {
+        w.reset();
+    }
+}
+
+StreamingBar StreamingBacktest::on_bar(double price, int signal)
+{
+    double step_total = 0.0;
+
+    // Same arithmetic, in the same order, as BacktestEngine::simulate.
+    if (bars_ > 0) {
+        if (signal != position_) {
+            double traded_notional = std::abs(signal - position_) * price;
+            double cost = traded_notional * transaction_cost_pct_;
+            equity_ -= cost;
+            step_total -= cost;
+            position_ = signal;
+        }
+
+        double step_pnl = position_ * (price - last_price_);
+        step_total += step_pnl;
+        equity_ += step_pnl;
+    }
+
+    last_price_ = price;
+    ++bars_;
+
+    metrics_.add_pnl(step_total);
+    metrics_.add_equity(equity_);
+    for (RollingMoments& w : windows_) {
+        w.push(step_total);
+    }
+
+    StreamingBar bar;
+    bar.pnl = step_total;
+    bar.equity = equity_;
+    bar.position = position_;
+    return bar;
+}
+
+void StreamingBacktest::on_bars(ArrayView<const double> prices, ArrayView<const int> signals)
+{
+    for (std::size_t i = 0; i < prices.size(); ++i) {
+        on_bar(prices[i], signals[i]);
+    }
+}
+
+double StreamingBacktest::total_return() const
+{
+    if (bars_ <= 1) {
+        return 0.0;
+    }
+    return (equity_ / initial_capital_) - 1.0;
+}
+
+double StreamingBacktest::rolling_sharpe(std::size_t k) const
+{
+    if (k >= windows_.size() || dt_in_years_ <= 0.0) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return windows_[k].sharpe(std::sqrt(1.0 / dt_in_years_));
+}
+
+std::vector<double> StreamingBacktest::rolling_sharpes() const
+{
+    std::vector<double> out(windows_.size());
+    for (std::size_t k = 0; k < windows_.size(); ++k) {
+        out[k] = rolling_sharpe(k);
+    }
+    return out;
+}
+
+std::vector<std::size_t> StreamingBacktest::sharpe_windows() const
+{
+    std::vector<std::size_t> out(windows_.size());
+    for (std::size_t k = 0; k < windows_.size(); ++k) {
+        out[k] = windows_[k].window;
+    }
+    return out;
+}
+
+void StreamingBacktest::write_state(BinaryWriter& out) const
+{
+    out.write(initial_capital_);
+    out.write(transaction_cost_pct_);
+    out.write(dt_in_years_);
+
+    out.write<std::uint64_t>(bars_);
+    out.write<std::int32_t>(position_);
+    out.write(equity_);
+    out.write(last_price_);
+
+    out.write(metrics_.peak);
+    out.write(metrics_.max_drawdown);
+    out.write<std::uint64_t>(metrics_.count);
+    out.write(metrics_.mean);
+    out.write(metrics_.m2);
+
+    out.write<std::uint64_t>(windows_.size());
+    for (const RollingMoments& w : windows_) {
+        w.write_state(out);
+    }
+}
+
+bool StreamingBacktest::read_state(BinaryReader& in)
+{
+    // Decode into a copy so a truncated or corrupt input changes nothing.
+    StreamingBacktest s(0.0, 0.0);
+    std::uint64_t bars = 0, count = 0, num_windows = 0;
+    std::int32_t position = 0;
+
+    bool ok = in.read(s.initial_capital_) && in.read(s.transaction_cost_pct_) &&
+              in.read(s.dt_in_years_) && in.read(bars) && in.read(position) &&
+              in.read(s.equity_) && in.read(s.last_price_) &&
+              in.read(s.metrics_.peak) && in.read(s.metrics_.max_drawdown) &&
+              in.read(count) && in.read(s.metrics_.mean) && in.read(s.metrics_.m2) &&
+              in.read(num_windows);
+    if (!ok || num_windows > in.remaining() / sizeof(std::uint64_t)) {
+        return false;
+    }
+    s.bars_ = static_cast<std::size_t>(bars);
+    s.position_ = position;
+    s.metrics_.count = static_cast<std::size_t>(count);
+
+    s.windows_.resize(static_cast<std::size_t>(num_windows));
+    for (RollingMoments& w : s.windows_) {
+        if (!w.read_state(in)) {
+            return false;
+        }
+    }
+
+    *this = std::move(s);
+    return true;
+}
+
+std::string StreamingBacktest::serialize() const
+{
+    BinaryWriter out;
+    out.write_bytes(kMagic, sizeof(kMagic));
+    out.write(kVersion);
+    write_state(out);
+    return out.take();
+}
+
+bool StreamingBacktest::deserialize(const std::string& bytes, std::string* error)
+{
+    BinaryReader in(bytes);
+    char magic[sizeof(kMagic)];
+    std::uint32_t version = 0;
+    if (!in.read_bytes(magic, sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+        !in.read(version) || version != kVersion) {
+        set_error(error, "not a streaming backtest state (bad magic or version)");
+        return false;
+    }
+    StreamingBacktest restored(*this);
+    if (!restored.read_state(in) || in.remaining() != 0) {
+        set_error(error, "corrupt or truncated streaming backtest state");
+        return false;
+    }
+    *this = std::move(restored);
+    return true;
+}
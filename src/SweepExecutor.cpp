@@ -0,0 +1,202 @@
+#include "SweepExecutor.hpp"
+
+#include <algorithm>    // std::max, std::min
+#include <chrono>
+#include <exception>
+#include <vector>
+
+SweepExecutor::SweepExecutor(const BacktestEngine& engine, std::size_t num_threads)
+    : engine_(engine),
+      pool_(std::make_unique<ThreadPool>(num_threads)) {}
+
+BatchResult SweepExecutor::run(ArrayView<const double> prices,
+                               ArrayView<const int> signal_matrix,
+                               double dt_in_years) const
+{
+    // No curves requested, so the null resource is never asked for memory.
+    return run(prices, signal_matrix, dt_in_years, *std::pmr::null_memory_resource(),
+               OutputMask::None);
+}
+
+BatchResult SweepExecutor::run(ArrayView<const double> prices,
+                               ArrayView<const int> signal_matrix,
+                               double dt_in_years,
+                               std::pmr::memory_resource& curve_memory,
+                               OutputMask outputs) const
+{
+    BatchResult result;
+
+    std::size_t n = prices.size();
+    if (n <= 1 || signal_matrix.empty() || signal_matrix.size() % n != 0) {
+        return result;
+    }
+
+    std::size_t num_candidates = signal_matrix.size() / n;
+
+    PhaseTimer<> setup_timer(result.profile.setup_ns);
+    engine_.allocate_curves(result, num_candidates, n, curve_memory, outputs);
+    PriceMoves moves = engine_.precompute_moves(prices);
+    setup_timer.stop();
+
+    // Several chunks per thread so stealing can even out uneven rows.
+    std::size_t grain = std::max<std::size_t>(1, num_candidates / (pool_->size() * 8));
+
+    // One profiling record per chunk, merged once the sweep is done.
+    std::vector<BacktestStats> chunk_stats(kProfilingEnabled ? (num_candidates + grain - 1) / grain : 0);
+
+    pool_->parallel_for(num_candidates, grain, [&](std::size_t begin, std::size_t end) {
+        BacktestStats* stats = kProfilingEnabled ? &chunk_stats[begin / grain] : nullptr;
+        engine_.run_candidates(moves, signal_matrix, begin, end, dt_in_years, result, stats);
+    });
+
+    if constexpr (kProfilingEnabled) {
+        for (const BacktestStats& stats : chunk_stats) {
+            result.profile.merge(stats);
+        }
+        result.profile.bytes_allocated += vector_bytes(moves.price_change) +
+                                          vector_bytes(moves.unit_cost) +
+                                          3 * num_candidates * sizeof(double);
+    }
+    return result;
+}
+
+std::shared_ptr<SweepJob> SweepExecutor::submit(ArrayView<const double> prices,
+                                                ArrayView<const int> signal_matrix,
+                                                double dt_in_years,
+                                                SweepProgressFn on_progress) const
+{
+    return submit(prices, std::vector<int>(signal_matrix.begin(), signal_matrix.end()),
+                  dt_in_years, std::move(on_progress));
+}
+
+std::shared_ptr<SweepJob> SweepExecutor::submit(ArrayView<const double> prices,
+                                                std::vector<int>&& signal_matrix,
+                                                double dt_in_years,
+                                                SweepProgressFn on_progress) const
+{
+    std::shared_ptr<SweepJob> job(new SweepJob());
+
+    std::size_t n = prices.size();
+    if (n <= 1 || signal_matrix.empty() || signal_matrix.size() % n != 0) {
+        job->state_ = SweepJob::State::Done;
+        return job;
+    }
+
+    std::size_t num_candidates = signal_matrix.size() / n;
+    job->signal_matrix_ = std::move(signal_matrix);
+    job->moves_ = engine_.precompute_moves(prices);
+    job->dt_in_years_ = dt_in_years;
+    job->on_progress_ = std::move(on_progress);
+    engine_.allocate_curves(job->result_, num_candidates, n, *std::pmr::null_memory_resource(),
+                            OutputMask::None);
+
+    // Same chunking as run(), one pool task per chunk, so no thread blocks
+    // waiting on the sweep.
+    std::size_t grain = std::max<std::size_t>(1, num_candidates / (pool_->size() * 8));
+    std::size_t num_chunks = (num_candidates + grain - 1) / grain;
+    job->remaining_chunks_ = num_chunks;
+
+    for (std::size_t c = 0; c < num_chunks; ++c) {
+        std::size_t begin = c * grain;
+        std::size_t end = std::min(num_candidates, begin + grain);
+        pool_->submit([job, this, begin, end] { job->run_chunk(engine_, begin, end); });
+    }
+    return job;
+}
+
+std::size_t SweepJob::completed() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return completed_;
+}
+
+SweepJob::State SweepJob::state() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return state_;
+}
+
+std::string SweepJob::error() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return error_;
+}
+
+bool SweepJob::cancel()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ != State::Running) {
+        return false;
+    }
+    cancel_.store(true, std::memory_order_release);
+    return true;
+}
+
+void SweepJob::wait() const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return state_ != State::Running; });
+}
+
+bool SweepJob::wait_for(double seconds) const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    return done_cv_.wait_for(lock, std::chrono::duration<double>(std::max(seconds, 0.0)),
+                             [this] { return state_ != State::Running; });
+}
+
+std::vector<std::pair<std::size_t, std::size_t>> SweepJob::take_finished()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::pair<std::size_t, std::size_t>> out;
+    out.swap(finished_);
+    return out;
+}
+
+void SweepJob::run_chunk(const BacktestEngine& engine, std::size_t begin, std::size_t end)
+{
+    std::string chunk_error;
+    if (!cancel_.load(std::memory_order_acquire)) {
+        try {
+            engine.run_candidates(moves_, ArrayView<const int>(signal_matrix_), begin, end,
+                                  dt_in_years_, result_, nullptr);
+            std::size_t done;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                completed_ += end - begin;
+                finished_.emplace_back(begin, end);
+                done = completed_;
+            }
+            if (on_progress_) {
+                on_progress_(begin, end, done);
+            }
+        } catch (const std::exception& e) {
+            chunk_error = e.what();
+        } catch (...) {
+            chunk_error = "unknown exception";
+        }
+    }
+
+    // Released after the lock: the callback may own state (e.g. a Python
+    // object) whose destructor must not run under mutex_.
+    SweepProgressFn released;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!chunk_error.empty() && error_.empty()) {
+        error_ = chunk_error;
+        cancel_.store(true, std::memory_order_release);
+    }
+    if (--remaining_chunks_ == 0) {
+        if (!error_.empty()) {
+            state_ = State::Failed;
+        } else if (completed_ < result_.num_candidates) {
+            state_ = State::Cancelled;
+        } else {
+            state_ = State::Done;
+        }
+        // The inputs are no longer needed; the result stays.
+        std::vector<int>().swap(signal_matrix_);
+        moves_ = PriceMoves();
+        released.swap(on_progress_);
+        done_cv_.notify_all();
+    }
+}
@@ -0,0 +1,185 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>    // std::max
+#include <chrono>
+#include <exception>
+
+namespace {
+
+// Identifies the pool/worker that owns the current thread (if any).
+thread_local const ThreadPool* tl_pool = nullptr;
+thread_local std::size_t tl_index = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(std::size_t num_threads)
+{
+    if (num_threads == 0) {
+        num_threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    queues_.reserve(num_threads);
+    for (std::size_t i = 0; i < num_threads; ++i) {
+        queues_.push_back(std::make_unique<Worker>());
+    }
+
+    workers_.reserve(num_threads);
+    for (std::size_t i = 0; i < num_threads; ++i) {
+        workers_.emplace_back([this, i] { worker_loop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stopping_ = true;
+    }
+    sleep_cv_.notify_all();
+
+    for (std::thread& t : workers_) {
+        t.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    std::size_t n = queues_.size();
+    std::size_t target = (tl_pool == this)
+        ? tl_index
+        : next_queue_.fetch_add(1, std::memory_order_relaxed) % n;
+
+    // Count first so pending_ never underflows when a thief races the push.
+    pending_.fetch_add(1, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(queues_[target]->mutex);
+        queues_[target]->tasks.push_back(std::move(task));
+    }
+
+    {
+        // Taking the lock orders this notify after a sleeper's predicate check.
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    sleep_cv_.notify_one();
+}
+
+void ThreadPool::parallel_for(std::size_t count,
+                              std::size_t grain,
+                              const std::function<void(std::size_t, std::size_t)>& fn)
+{
+    if (count == 0) {
+        return;
+    }
+    grain = std::max<std::size_t>(1, grain);
+    std::size_t num_chunks = (count + grain - 1) / grain;
+
+    if (num_chunks == 1) {
+        fn(0, count);
+        return;
+    }
+
+    struct Sync {
+        std::atomic<std::size_t> remaining{0};
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::exception_ptr error;
+    };
+    auto sync = std::make_shared<Sync>();
+    sync->remaining.store(num_chunks);
+
+    for (std::size_t c = 0; c < num_chunks; ++c) {
+        std::size_t begin = c * grain;
+        std::size_t end = std::min(count, begin + grain);
+
+        submit([sync, &fn, begin, end] {
+            try {
+                fn(begin, end);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(sync->mutex);
+                if (!sync->error) {
+                    sync->error = std::current_exception();
+                }
+            }
+            if (sync->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(sync->mutex);
+                sync->cv.notify_all();
+            }
+        });
+    }
+
+    // Help drain the queues while waiting instead of blocking a thread.
+    while (sync->remaining.load(std::memory_order_acquire) > 0) {
+        std::function<void()> task;
+        if (try_acquire(task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sync->mutex);
+        sync->cv.wait_for(lock, std::chrono::microseconds(200), [&] {
+            return sync->remaining.load(std::memory_order_acquire) == 0;
+        });
+    }
+
+    if (sync->error) {
+        std::rethrow_exception(sync->error);
+    }
+}
+
+bool ThreadPool::try_pop(std::size_t self, std::function<void()>& task)
+{
+    Worker& w = *queues_[self];
+    std::lock_guard<std::mutex> lock(w.mutex);
+    if (w.tasks.empty()) {
+        return false;
+    }
+    task = std::move(w.tasks.back());
+    w.tasks.pop_back();
+    pending_.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+}
+
+bool ThreadPool::try_steal(std::size_t thief, std::function<void()>& task)
+{
+    std::size_t n = queues_.size();
+    for (std::size_t k = 1; k <= n; ++k) {
+        Worker& w = *queues_[(thief + k) % n];
+        std::lock_guard<std::mutex> lock(w.mutex);
+        if (!w.tasks.empty()) {
+            task = std::move(w.tasks.front());
+            w.tasks.pop_front();
+            pending_.fetch_sub(1, std::memory_order_acq_rel);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::try_acquire(std::function<void()>& task)
+{
+    if (tl_pool == this) {
+        return try_pop(tl_index, task) || try_steal(tl_index, task);
+    }
+    return try_steal(queues_.size(), task);
+}
+
+void ThreadPool::worker_loop(std::size_t index)
+{
+    tl_pool = this;
+    tl_index = index;
+
+    for (;;) {
+        std::function<void()> task;
+        if (try_pop(index, task) || try_steal(index, task)) {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        sleep_cv_.wait(lock, [this] {
+            return stopping_ || pending_.load(std::memory_order_acquire) > 0;
+        });
+        if (stopping_ && pending_.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,207 @@
+#include "WalkForward.hpp"
+
+#include <algorithm>    // std::max, std::sort, std::unique
+#include <cmath>        // std::sqrt
+#include <cstdlib>      // std::abs(int)
+#include <string>
+
+#include "RollingStatsCache.hpp"
+
+namespace {
+
+// Annualised Sharpe of n PnL values from their sum and sum of squares,
+// same conventions as BacktestEngine (population std, zero when undefined).
+double sharpe_from_sums(double sum, double sum_sq, std::size_t n, double dt_in_years)
+{
+    if (n <= 1 || dt_in_years <= 0.0) {
+        return 0.0;
+    }
+    double count = static_cast<double>(n);
+    double mean = sum / count;
+    double var = sum_sq / count - mean * mean;
+    if (!(var > 0.0)) {
+        return 0.0;
+    }
+    return mean / std::sqrt(var) * std::sqrt(1.0 / dt_in_years);
+}
+
+bool valid_split(const FoldSplit& s, std::size_t num_steps)
+{
+    return s.train_begin + 2 <= s.train_end && s.train_end <= s.test_begin &&
+           s.test_begin + 2 <= s.test_end && s.test_end <= num_steps;
+}
+
+}  // namespace
+
+std::vector<FoldSplit> make_walk_forward_splits(std::size_t num_steps,
+                                                std::size_t train_bars,
+                                                std::size_t test_bars,
+                                                std::size_t step_bars,
+                                                bool anchored)
+{
+    std::vector<FoldSplit> splits;
+    if (train_bars == 0 || test_bars == 0) {
+        return splits;
+    }
+    std::size_t step = (step_bars == 0) ? test_bars : step_bars;
+
+    for (std::size_t start = 0; start + train_bars + test_bars <= num_steps; start += step) {
+        FoldSplit s;
+        s.train_begin = anchored ? 0 : start;
+        s.train_end = start + train_bars;
+        s.test_begin = s.train_end;
+        s.test_end = s.test_begin + test_bars;
+        splits.push_back(s);
+    }
+    return splits;
+}
+
+std::vector<SignalParams> make_param_grid(const std::vector<std::size_t>& windows,
+                                          const std::vector<double>& z_entries,
+                                          const std::vector<double>& z_exits)
+{
+    std::vector<SignalParams> grid;
+    grid.reserve(windows.size() * z_entries.size() * z_exits.size());
+    for (std::size_t w : windows) {
+        for (double entry : z_entries) {
+            for (double exit : z_exits) {
+                grid.push_back(SignalParams{w, entry, exit});
+            }
+        }
+    }
+    return grid;
+}
+
+WalkForwardOptimizer::WalkForwardOptimizer(const BacktestEngine& engine, std::size_t num_threads)
+    : engine_(engine),
+      pool_(std::make_unique<ThreadPool>(num_threads)) {}
+
+WalkForwardResult WalkForwardOptimizer::run(ArrayView<const double> prices,
+                                            const std::vector<FoldSplit>& splits,
+                                            const std::vector<SignalParams>& grid,
+                                            double dt_in_years) const
+{
+    WalkForwardResult result;
+
+    std::size_t n = prices.size();
+    if (n <= 1 || splits.empty() || grid.empty()) {
+        return result;
+    }
+    for (const FoldSplit& s : splits) {
+        if (!valid_split(s, n)) {
+            return result;
+        }
+    }
+
+    std::size_t num_folds = splits.size();
+    std::size_t num_configs = grid.size();
+    result.num_folds = num_folds;
+    result.num_configs = num_configs;
+    result.in_sample_sharpe.resize(num_folds * num_configs);
+    result.out_of_sample_sharpe.resize(num_folds * num_configs);
+
+    PriceMoves moves = engine_.precompute_moves(prices);
+
+    // Signals of every config, one byte per bar, kept for the exact
+    // out-of-sample reruns.
+    std::vector<std::int8_t> signals(num_configs * n);
+
+    std::size_t threads = pool_->size();
+    std::size_t config_grain = std::max<std::size_t>(1, num_configs / (threads * 8));
+
+    // Rolling z-scores once per distinct window, shared by every config on it.
+    const std::string series_id = "prices";
+    RollingStatsCache stats;
+    stats.add_series(series_id, prices);
+
+    std::vector<std::size_t> windows;
+    windows.reserve(num_configs);
+    for (const SignalParams& p : grid) {
+        windows.push_back(std::max<std::size_t>(p.window, 1));  // SignalGenerator's clamp
+    }
+    std::sort(windows.begin(), windows.end());
+    windows.erase(std::unique(windows.begin(), windows.end()), windows.end());
+    pool_->parallel_for(windows.size(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t k = begin; k < end; ++k) {
+            stats.zscores(series_id, windows[k]);
+        }
+    });
+
+    // Pass 1 (per config): signals over the whole history from the cached
+    // z-scores, prefix sums of the PnL a continuously held strategy would
+    // earn, then the Sharpe of every train and test range from prefix
+    // differences.
+    pool_->parallel_for(num_configs, config_grain, [&](std::size_t begin, std::size_t end) {
+        std::vector<int> sig(n);
+        std::vector<double> sum(n + 1);     // sum[i] = pnl[0] + ... + pnl[i - 1]
+        std::vector<double> sum_sq(n + 1);
+
+        for (std::size_t c = begin; c < end; ++c) {
+            SignalParams p = grid[c];
+            p.window = std::max<std::size_t>(p.window, 1);
+            stats.signals_into(series_id, p, ArrayView<int>(sig));
+
+            std::int8_t* row = signals.data() + c * n;
+            row[0] = static_cast<std::int8_t>(sig[0]);
+            sum[0] = sum[1] = 0.0;
+            sum_sq[0] = sum_sq[1] = 0.0;
+            for (std::size_t i = 1; i < n; ++i) {
+                row[i] = static_cast<std::int8_t>(sig[i]);
+                double cost = std::abs(sig[i] - sig[i - 1]) * moves.unit_cost[i];
+                double pnl = -cost + sig[i] * moves.price_change[i];
+                sum[i + 1] = sum[i] + pnl;
+                sum_sq[i + 1] = sum_sq[i] + pnl * pnl;
+            }
+
+            // A fresh backtest over [a, b) is flat on bar a and pays the full
+            // entry cost on bar a + 1; every later bar matches the
+            // continuous stream.
+            auto range_sharpe = [&](std::size_t a, std::size_t b) {
+                double first = -std::abs(sig[a + 1]) * moves.unit_cost[a + 1] +
+                               sig[a + 1] * moves.price_change[a + 1];
+                double s = first + (sum[b] - sum[a + 2]);
+                double q = first * first + (sum_sq[b] - sum_sq[a + 2]);
+                return sharpe_from_sums(s, q, b - a, dt_in_years);
+            };
+
+            for (std::size_t f = 0; f < num_folds; ++f) {
+                const FoldSplit& s = splits[f];
+                result.in_sample_sharpe[f * num_configs + c] = range_sharpe(s.train_begin, s.train_end);
+                result.out_of_sample_sharpe[f * num_configs + c] = range_sharpe(s.test_begin, s.test_end);
+            }
+        }
+    });
+
+    // Pass 2 (per fold): pick the best in-sample config and rerun it exactly
+    // on the test range.
+    result.folds.resize(num_folds);
+    std::size_t fold_grain = std::max<std::size_t>(1, num_folds / (threads * 8));
+
+    pool_->parallel_for(num_folds, fold_grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t f = begin; f < end; ++f) {
+            const double* is = result.in_sample_sharpe.data() + f * num_configs;
+            std::size_t best = 0;
+            for (std::size_t c = 1; c < num_configs; ++c) {
+                if (is[c] > is[best]) {
+                    best = c;
+                }
+            }
+
+            WalkForwardFold& fold = result.folds[f];
+            fold.split = splits[f];
+            fold.best_config = best;
+            fold.in_sample_sharpe = is[best];
+
+            std::size_t len = fold.split.test_end - fold.split.test_begin;
+            ArrayView<const std::int8_t> row(signals.data() + best * n + fold.split.test_begin, len);
+            DiscreteBacktestResult test = engine_.run_backtest(
+                prices.subview(fold.split.test_begin, len), row, dt_in_years, OutputMask::Stats);
+
+            fold.test_total_return = test.total_return;
+            fold.test_max_drawdown = test.max_drawdown;
+            fold.test_sharpe = test.sharpe_ratio;
+        }
+    });
+
+    return result;
+}